@@ -34,6 +34,7 @@
 #include "Policies/ThreadingModel.h"
 #include "TypeContainer.h"
 #include "TypeContainerVisitor.h"
+#include "GridObjectIndex.h"
 
 // forward declaration
 template<class A, class T, class O> class GridLoader;
@@ -61,7 +62,11 @@ class Grid
         template<class SPECIFIC_OBJECT>
         bool AddWorldObject(SPECIFIC_OBJECT* obj)
         {
-            return i_objects.template insert<SPECIFIC_OBJECT>(obj);
+            if (!i_objects.template insert<SPECIFIC_OBJECT>(obj))
+                return false;
+
+            obj->AddToGridIndex(i_index);
+            return true;
         }
 
         /** an object of interested exits the grid
@@ -69,6 +74,7 @@ class Grid
         template<class SPECIFIC_OBJECT>
         bool RemoveWorldObject(SPECIFIC_OBJECT* obj)
         {
+            obj->RemoveFromGridIndex();
             return i_objects.template remove<SPECIFIC_OBJECT>(obj);
         }
 
@@ -103,7 +109,11 @@ class Grid
             if (obj->isActiveObject())
                 m_activeGridObjects.insert(obj);
 
-            return i_container.template insert<SPECIFIC_OBJECT>(obj);
+            if (!i_container.template insert<SPECIFIC_OBJECT>(obj))
+                return false;
+
+            obj->AddToGridIndex(i_index);
+            return true;
         }
 
         /** Removes a containter type object from the grid
@@ -114,15 +124,21 @@ class Grid
             if (obj->isActiveObject())
                 m_activeGridObjects.erase(obj);
 
+            obj->RemoveFromGridIndex();
             return i_container.template remove<SPECIFIC_OBJECT>(obj);
         }
 
+        /** Position data of all objects within the grid, for range searches
+         */
+        const GridObjectIndex& GetObjectIndex() const { return i_index; }
+
     private:
 
         TypeMapContainer<GRID_OBJECT_TYPES> i_container;
         TypeMapContainer<WORLD_OBJECT_TYPES> i_objects;
         typedef std::set<void*> ActiveGridObjects;
         ActiveGridObjects m_activeGridObjects;
+        GridObjectIndex i_index;
 };
 
 #endif
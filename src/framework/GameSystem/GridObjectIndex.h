@@ -0,0 +1,134 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRIDOBJECTINDEX_H
+#define MANGOS_GRIDOBJECTINDEX_H
+
+/*
+  @class GridObjectIndex
+  Contiguous copy of the position data of the objects in a grid cell, kept
+  next to the intrusive object lists.  Range searches scan these arrays to
+  find their candidates without touching the objects themselves.
+*/
+
+#include "Platform/Define.h"
+
+#include <vector>
+
+class GridObjectIndex;
+
+/** Entry of an object in an index, owned by the object.
+ */
+struct GridObjectIndexRef
+{
+    GridObjectIndexRef() : index(nullptr), slot(0) {}
+
+    GridObjectIndex* index;
+    uint32 slot;
+};
+
+class GridObjectIndex
+{
+    public:
+
+        GridObjectIndex() {}
+        GridObjectIndex(const GridObjectIndex&) = delete;
+        GridObjectIndex& operator=(const GridObjectIndex&) = delete;
+
+        ~GridObjectIndex()
+        {
+            for (GridObjectIndexRef* ref : m_refs)
+                ref->index = nullptr;
+        }
+
+        void Insert(GridObjectIndexRef& ref, void* object, uint32 typeMask, float x, float y, float reach)
+        {
+            ref.index = this;
+            ref.slot = uint32(m_objects.size());
+
+            m_x.push_back(x);
+            m_y.push_back(y);
+            m_reach.push_back(reach);
+            m_typeMask.push_back(typeMask);
+            m_objects.push_back(object);
+            m_refs.push_back(&ref);
+        }
+
+        /** the last entry is moved into the freed slot
+         */
+        void Remove(GridObjectIndexRef& ref)
+        {
+            uint32 last = uint32(m_objects.size() - 1);
+            if (ref.slot != last)
+            {
+                m_x[ref.slot] = m_x[last];
+                m_y[ref.slot] = m_y[last];
+                m_reach[ref.slot] = m_reach[last];
+                m_typeMask[ref.slot] = m_typeMask[last];
+                m_objects[ref.slot] = m_objects[last];
+                m_refs[ref.slot] = m_refs[last];
+                m_refs[ref.slot]->slot = ref.slot;
+            }
+
+            m_x.pop_back();
+            m_y.pop_back();
+            m_reach.pop_back();
+            m_typeMask.pop_back();
+            m_objects.pop_back();
+            m_refs.pop_back();
+
+            ref.index = nullptr;
+        }
+
+        void Update(GridObjectIndexRef const& ref, float x, float y, float reach)
+        {
+            m_x[ref.slot] = x;
+            m_y[ref.slot] = y;
+            m_reach[ref.slot] = reach;
+        }
+
+        /** Appends the objects matching the type mask whose reach touches the circle around x, y.
+            T must be the type the objects were inserted as.
+         */
+        template<class T>
+        void Search(float x, float y, float radius, uint32 typeMask, std::vector<T*>& result) const
+        {
+            uint32 const count = uint32(m_objects.size());
+            for (uint32 i = 0; i < count; ++i)
+            {
+                float dx = m_x[i] - x;
+                float dy = m_y[i] - y;
+                float maxDist = radius + m_reach[i];
+                if ((m_typeMask[i] & typeMask) && dx * dx + dy * dy <= maxDist * maxDist)
+                    result.push_back(static_cast<T*>(m_objects[i]));
+            }
+        }
+
+        uint32 Size() const { return uint32(m_objects.size()); }
+
+    private:
+
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_reach;
+        std::vector<uint32> m_typeMask;
+        std::vector<void*> m_objects;
+        std::vector<GridObjectIndexRef*> m_refs;
+};
+
+#endif
@@ -17,10 +17,55 @@
  */
 
 #include "EventProcessor.h"
+#include "PoolAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if COMPILER == COMPILER_MICROSOFT
+#  include <intrin.h>
+#endif
+
+namespace
+{
+    // slot ids beyond the wheel slots
+    uint32 const EVENT_SLOT_OVERFLOW = EVENT_WHEEL_LEVELS * EVENT_WHEEL_SIZE;
+    uint32 const EVENT_SLOT_DUE      = EVENT_SLOT_OVERFLOW + 1;
+    uint64 const EVENT_WHEEL_MASK    = EVENT_WHEEL_SIZE - 1;
+
+    inline uint32 LowestBit(uint64 mask)
+    {
+#if COMPILER == COMPILER_MICROSOFT
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return uint32(index);
+#else
+        return uint32(__builtin_ctzll(mask));
+#endif
+    }
+
+    PoolAllocator s_eventPool("BasicEvent");
+}
+
+void* BasicEvent::operator new(size_t size)
+{
+    return s_eventPool.Allocate(size);
+}
+
+void BasicEvent::operator delete(void* pointer, size_t size)
+{
+    s_eventPool.Deallocate(pointer, size);
+}
 
 EventProcessor::EventProcessor()
 {
     m_time = 0;
+    m_wheelTime = 0;
+    m_sequence = 0;
+    memset(m_slots, 0, sizeof(m_slots));
+    memset(m_slotMask, 0, sizeof(m_slotMask));
+    m_overflow = nullptr;
+    m_due = nullptr;
     m_aborting = false;
 }
 
@@ -34,13 +79,58 @@ void EventProcessor::Update(uint32 p_time)
     // update time
     m_time += p_time;
 
-    // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    // main event loop, walks the level 0 slots up to the current time and cascades at each new window
+    uint64 target = m_time + 1;
+    while (m_wheelTime < target)
+    {
+        uint64 pending = m_slotMask[0] & (~uint64(0) << (m_wheelTime & EVENT_WHEEL_MASK));
+        if (pending)
+        {
+            uint64 slotTime = (m_wheelTime & ~EVENT_WHEEL_MASK) | LowestBit(pending);
+            if (slotTime < target)
+            {
+                m_wheelTime = slotTime;
+                ExecuteSlot(uint32(slotTime & EVENT_WHEEL_MASK), p_time);
+                continue;
+            }
+        }
+
+        uint64 nextWindow = (m_wheelTime | EVENT_WHEEL_MASK) + 1;
+        if (nextWindow > target)
+        {
+            m_wheelTime = target;
+            break;
+        }
+
+        m_wheelTime = nextWindow;
+        Cascade();
+    }
+}
+
+void EventProcessor::ExecuteSlot(uint32 index, uint32 p_time)
+{
+    // take the slot out of the wheel, events re-added for this time meanwhile get a new slot visit
+    m_sortBuffer.clear();
+    for (BasicEvent* Event = m_slots[0][index]; Event; Event = Event->m_nextEvent)
+        m_sortBuffer.push_back(Event);
+    m_slots[0][index] = nullptr;
+    m_slotMask[0] &= ~(uint64(1) << index);
+
+    // late added events share the slot of the wheel time, run them in the order of a time sorted queue
+    std::sort(m_sortBuffer.begin(), m_sortBuffer.end(), [](BasicEvent const* left, BasicEvent const* right)
+    {
+        if (left->m_execTime != right->m_execTime)
+            return left->m_execTime < right->m_execTime;
+        return left->m_sequence < right->m_sequence;
+    });
+
+    for (auto itr = m_sortBuffer.rbegin(); itr != m_sortBuffer.rend(); ++itr)
+        Link(m_due, *itr, EVENT_SLOT_DUE);
+
+    while (BasicEvent* Event = m_due)
     {
         // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        Unlink(Event);
 
         if (!Event->to_Abort)
         {
@@ -58,53 +148,138 @@ void EventProcessor::Update(uint32 p_time)
     }
 }
 
-void EventProcessor::KillAllEvents(bool force)
+void EventProcessor::Cascade()
 {
-    // prevent event insertions
-    m_aborting = true;
+    // m_wheelTime just entered a new level 0 window, move down the events of the windows starting here
+    if ((m_wheelTime & ((uint64(1) << (2 * EVENT_WHEEL_BITS)) - 1)) == 0)
+    {
+        if ((m_wheelTime & ((uint64(1) << (3 * EVENT_WHEEL_BITS)) - 1)) == 0)
+            Reschedule(m_overflow);
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+        uint32 index = uint32((m_wheelTime >> (2 * EVENT_WHEEL_BITS)) & EVENT_WHEEL_MASK);
+        if (m_slotMask[2] & (uint64(1) << index))
+            Reschedule(m_slots[2][index]);
+    }
+
+    uint32 index = uint32((m_wheelTime >> EVENT_WHEEL_BITS) & EVENT_WHEEL_MASK);
+    if (m_slotMask[1] & (uint64(1) << index))
+        Reschedule(m_slots[1][index]);
+}
+
+void EventProcessor::Reschedule(BasicEvent*& head)
+{
+    // detach the list first, overflow events may land in the overflow list again
+    m_sortBuffer.clear();
+    for (BasicEvent* Event = head; Event; Event = Event->m_nextEvent)
+        m_sortBuffer.push_back(Event);
+
+    for (BasicEvent* Event : m_sortBuffer)
     {
-        EventList::iterator i_old = i;
-        ++i;
+        Unlink(Event);
+        Schedule(Event);
+    }
+}
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
-        {
-            delete i_old->second;
+void EventProcessor::Schedule(BasicEvent* Event)
+{
+    // events planned before the wheel time are due at the next processed slot
+    uint64 time = std::max(Event->m_execTime, m_wheelTime);
+    uint64 distance = time ^ m_wheelTime;
 
-            if (!force)                                     // need per-element cleanup
-                m_events.erase(i_old);
+    for (uint32 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+    {
+        if (distance < (uint64(1) << ((level + 1) * EVENT_WHEEL_BITS)))
+        {
+            uint32 index = uint32((time >> (level * EVENT_WHEEL_BITS)) & EVENT_WHEEL_MASK);
+            Link(m_slots[level][index], Event, level * EVENT_WHEEL_SIZE + index);
+            m_slotMask[level] |= uint64(1) << index;
+            return;
         }
     }
 
-    // fast clear event list (in force case)
-    if (force)
-        m_events.clear();
+    Link(m_overflow, Event, EVENT_SLOT_OVERFLOW);
+}
+
+void EventProcessor::Link(BasicEvent*& head, BasicEvent* Event, uint32 slot)
+{
+    Event->m_nextEvent = head;
+    if (head)
+        head->m_prevLink = &Event->m_nextEvent;
+    Event->m_prevLink = &head;
+    Event->m_slot = slot;
+    head = Event;
 }
 
-void EventProcessor::KillEvent(BasicEvent* event)
+void EventProcessor::Unlink(BasicEvent* Event)
 {
-    for (EventList::iterator iter = m_events.begin(); iter != m_events.end();)
+    *Event->m_prevLink = Event->m_nextEvent;
+    if (Event->m_nextEvent)
+        Event->m_nextEvent->m_prevLink = Event->m_prevLink;
+
+    if (Event->m_slot < EVENT_SLOT_OVERFLOW)
     {
-        if (iter->second == event)
+        uint32 level = Event->m_slot / EVENT_WHEEL_SIZE;
+        uint32 index = Event->m_slot % EVENT_WHEEL_SIZE;
+        if (!m_slots[level][index])
+            m_slotMask[level] &= ~(uint64(1) << index);
+    }
+
+    Event->m_nextEvent = nullptr;
+    Event->m_prevLink = nullptr;
+}
+
+void EventProcessor::GetEvents(std::vector<BasicEvent*>& events) const
+{
+    for (uint32 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+        for (uint32 index = 0; index < EVENT_WHEEL_SIZE; ++index)
+            for (BasicEvent* Event = m_slots[level][index]; Event; Event = Event->m_nextEvent)
+                events.push_back(Event);
+
+    for (BasicEvent* Event = m_overflow; Event; Event = Event->m_nextEvent)
+        events.push_back(Event);
+    for (BasicEvent* Event = m_due; Event; Event = Event->m_nextEvent)
+        events.push_back(Event);
+}
+
+void EventProcessor::KillAllEvents(bool force)
+{
+    // prevent event insertions
+    m_aborting = true;
+
+    std::vector<BasicEvent*> events;
+    GetEvents(events);
+
+    // first, abort all existing events
+    for (BasicEvent* Event : events)
+    {
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        if (force || Event->IsDeletable())
         {
-            delete iter->second;
-            iter = m_events.erase(iter);
+            Unlink(Event);
+            delete Event;
         }
-        else ++iter;
     }
 }
 
+void EventProcessor::KillEvent(BasicEvent* Event)
+{
+    // only events still queued here are owned by the processor
+    if (!Event->m_prevLink)
+        return;
+
+    Unlink(Event);
+    delete Event;
+}
+
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime)
         Event->m_addTime = m_time;
 
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_sequence = ++m_sequence;
+    Schedule(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset) const
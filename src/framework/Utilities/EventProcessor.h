@@ -21,16 +21,19 @@
 
 #include "Platform/Define.h"
 
-#include <map>
+#include <cstddef>
+#include <vector>
 
 // Note. All times are in milliseconds here.
 
 class BasicEvent
 {
+        friend class EventProcessor;
+
     public:
 
         BasicEvent()
-            : to_Abort(false)
+            : to_Abort(false), m_nextEvent(nullptr), m_prevLink(nullptr), m_slot(0), m_sequence(0)
         {
         }
 
@@ -38,6 +41,10 @@ class BasicEvent
         {
         };
 
+        // events are allocated from per thread free lists, they are created and deleted at a high rate
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer, size_t size);
+
         // this method executes when the event is triggered
         // return false if event does not want to be deleted
         // e_time is execution time, p_time is update interval
@@ -53,9 +60,21 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+    private:
+        // links of the wheel slot holding the event, m_prevLink is null while the event is not queued
+        BasicEvent* m_nextEvent;
+        BasicEvent** m_prevLink;
+        uint32 m_slot;
+        uint64 m_sequence;                                  // keeps events of the same time in insertion order
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+// Events are kept in a hierarchical timing wheel: level 0 has one slot per millisecond of the current
+// 64 ms window, each higher level one slot per window of the level below. Events beyond the last level
+// wait in an overflow list. Adding and killing an event is O(1), expired slots cascade down on update.
+#define EVENT_WHEEL_BITS   6
+#define EVENT_WHEEL_SIZE   (1 << EVENT_WHEEL_BITS)
+#define EVENT_WHEEL_LEVELS 3
 
 class EventProcessor
 {
@@ -69,12 +88,26 @@ class EventProcessor
         void KillEvent(BasicEvent* Event);
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
         uint64 CalculateTime(uint64 t_offset) const;
-        EventList& GetEvents() { return m_events; }
+        // fills the queued events in no particular order
+        void GetEvents(std::vector<BasicEvent*>& events) const;
 
     protected:
 
+        void Schedule(BasicEvent* Event);
+        void Link(BasicEvent*& head, BasicEvent* Event, uint32 slot);
+        void Unlink(BasicEvent* Event);
+        void Reschedule(BasicEvent*& head);
+        void Cascade();
+        void ExecuteSlot(uint32 index, uint32 p_time);
+
         uint64 m_time;
-        EventList m_events;
+        uint64 m_wheelTime;                                 // first time not processed by the wheel yet
+        uint64 m_sequence;
+        BasicEvent* m_slots[EVENT_WHEEL_LEVELS][EVENT_WHEEL_SIZE];
+        uint64 m_slotMask[EVENT_WHEEL_LEVELS];              // bit set for every non empty slot
+        BasicEvent* m_overflow;
+        BasicEvent* m_due;                                  // events of the slot being executed, in execution order
+        std::vector<BasicEvent*> m_sortBuffer;
         bool m_aborting;
 };
 
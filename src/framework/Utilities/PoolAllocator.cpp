@@ -0,0 +1,133 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PoolAllocator.h"
+
+#include <mutex>
+#include <new>
+
+namespace
+{
+    // size classes of 16 bytes up to 8KB, bigger objects use the global allocator
+    size_t const POOL_GRANULARITY = 16;
+    size_t const POOL_CLASSES     = 512;
+    size_t const POOL_CHUNK       = 64 * 1024;
+
+    struct PoolBlock
+    {
+        PoolBlock* next;
+    };
+
+    thread_local PoolBlock* t_freeBlocks[POOL_CLASSES];
+
+    inline size_t GetSizeClass(size_t size)
+    {
+        return (size + POOL_GRANULARITY - 1) / POOL_GRANULARITY;
+    }
+
+    std::mutex& GetPoolsLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    std::vector<PoolAllocator const*>& GetPools()
+    {
+        static std::vector<PoolAllocator const*> pools;
+        return pools;
+    }
+}
+
+PoolAllocator::PoolAllocator(char const* name) : m_name(name), m_allocations(0), m_deallocations(0), m_liveBytes(0), m_chunkBytes(0)
+{
+    std::lock_guard<std::mutex> guard(GetPoolsLock());
+    GetPools().push_back(this);
+}
+
+void* PoolAllocator::Allocate(size_t size)
+{
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    size_t sizeClass = GetSizeClass(size);
+    if (sizeClass > POOL_CLASSES)
+    {
+        m_liveBytes.fetch_add(size, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+
+    size_t blockSize = sizeClass * POOL_GRANULARITY;
+    m_liveBytes.fetch_add(blockSize, std::memory_order_relaxed);
+
+    PoolBlock*& freeBlocks = t_freeBlocks[sizeClass - 1];
+    if (!freeBlocks)
+    {
+        char* chunk = static_cast<char*>(::operator new(POOL_CHUNK));
+        for (size_t offset = 0; offset + blockSize <= POOL_CHUNK; offset += blockSize)
+        {
+            PoolBlock* block = reinterpret_cast<PoolBlock*>(chunk + offset);
+            block->next = freeBlocks;
+            freeBlocks = block;
+        }
+        m_chunkBytes.fetch_add(POOL_CHUNK, std::memory_order_relaxed);
+    }
+
+    PoolBlock* block = freeBlocks;
+    freeBlocks = block->next;
+    return block;
+}
+
+void PoolAllocator::Deallocate(void* pointer, size_t size)
+{
+    if (!pointer)
+        return;
+
+    m_deallocations.fetch_add(1, std::memory_order_relaxed);
+
+    size_t sizeClass = GetSizeClass(size);
+    if (sizeClass > POOL_CLASSES)
+    {
+        m_liveBytes.fetch_sub(size, std::memory_order_relaxed);
+        ::operator delete(pointer);
+        return;
+    }
+
+    m_liveBytes.fetch_sub(sizeClass * POOL_GRANULARITY, std::memory_order_relaxed);
+
+    PoolBlock* block = static_cast<PoolBlock*>(pointer);
+    block->next = t_freeBlocks[sizeClass - 1];
+    t_freeBlocks[sizeClass - 1] = block;
+}
+
+PoolAllocatorStats PoolAllocator::GetStats() const
+{
+    PoolAllocatorStats stats;
+    stats.name = m_name;
+    uint64 deallocations = m_deallocations.load(std::memory_order_relaxed);
+    stats.allocations = m_allocations.load(std::memory_order_relaxed);
+    stats.live = stats.allocations - deallocations;
+    stats.liveBytes = m_liveBytes.load(std::memory_order_relaxed);
+    stats.chunkBytes = m_chunkBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PoolAllocator::GetAllStats(std::vector<PoolAllocatorStats>& stats)
+{
+    std::lock_guard<std::mutex> guard(GetPoolsLock());
+    for (PoolAllocator const* pool : GetPools())
+        stats.push_back(pool->GetStats());
+}
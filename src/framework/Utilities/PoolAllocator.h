@@ -0,0 +1,65 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_POOLALLOCATOR_H
+#define MANGOS_POOLALLOCATOR_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+struct PoolAllocatorStats
+{
+    char const* name;
+    uint64 allocations;                                     // total number of allocations
+    uint64 live;                                            // objects currently allocated
+    uint64 liveBytes;                                       // block bytes of the objects currently allocated
+    uint64 chunkBytes;                                      // bytes taken from the system for the free lists
+};
+
+// Fixed size blocks for objects created and deleted at a high rate, used through class operator new/delete.
+// Every thread keeps own free lists per 16 byte size class so map threads don't contend on the global heap.
+// A block deleted on another thread joins the free list of that thread, chunks are kept for the lifetime of the process.
+// The size classes are shared by all pools, a pool only keeps the statistics of its type.
+class PoolAllocator
+{
+    public:
+        explicit PoolAllocator(char const* name);
+
+        void* Allocate(size_t size);
+        void Deallocate(void* pointer, size_t size);
+
+        PoolAllocatorStats GetStats() const;
+
+        // statistics of all pools constructed so far
+        static void GetAllStats(std::vector<PoolAllocatorStats>& stats);
+
+    private:
+        PoolAllocator(PoolAllocator const&);
+        PoolAllocator& operator=(PoolAllocator const&);
+
+        char const* m_name;
+        std::atomic<uint64> m_allocations;
+        std::atomic<uint64> m_deallocations;
+        std::atomic<uint64> m_liveBytes;
+        std::atomic<uint64> m_chunkBytes;
+};
+
+#endif
@@ -280,6 +280,9 @@ ChatCommand* ChatHandler::getCommandTable()
     static ChatCommand debugPerformanceCommandTable[] =
     {
         { "maps",           SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugMaps,                       "", nullptr },
+        { "database",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugDatabase,                   "", nullptr },
+        { "socket",         SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugSocket,                     "", nullptr },
+        { "memory",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugMemory,                     "", nullptr },
         { "tempspawn",      SEC_ADMINISTRATOR,  false, &ChatHandler::HandleShowTemporarySpawnList,          "", nullptr },
         { "gridsloaded",    SEC_ADMINISTRATOR,  false, &ChatHandler::HandleGridsLoadedCount,                "", nullptr },
         { nullptr,          0,                  false, nullptr,                                             "", nullptr }
@@ -292,6 +292,9 @@ class ChatHandler
         bool HandleDebugIsVisibleCommand(char* args);
 
         bool HandleDebugMaps(char* args);
+        bool HandleDebugDatabase(char* args);
+        bool HandleDebugSocket(char* args);
+        bool HandleDebugMemory(char* args);
         bool HandleShowTemporarySpawnList(char* args);
         bool HandleGridsLoadedCount(char* args);
 
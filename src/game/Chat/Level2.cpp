@@ -4920,6 +4920,7 @@ bool ChatHandler::HandleMmapPathCommand(char* args)
     bool useStraightPath = false;
     bool followPath = false;
     bool unitToPlayer = false;
+    bool longPath = false;
     if (para)
     {
         if (strcmp(para, "go") == 0)
@@ -4933,11 +4934,14 @@ bool ChatHandler::HandleMmapPathCommand(char* args)
             useStraightPath = true;
         else if (strcmp(para, "to_me") == 0)
             unitToPlayer = true;
+        else if (strcmp(para, "long") == 0)
+            longPath = true;
         else
         {
             PSendSysMessage("Use '.mmap path go' to move on target.");
             PSendSysMessage("Use '.mmap path straight' to generate straight path.");
             PSendSysMessage("Use '.mmap path to_me' to generate path from the target to you.");
+            PSendSysMessage("Use '.mmap path long' to plan paths longer than the path buffers over the navmesh tiles.");
         }
     }
 
@@ -4961,11 +4965,12 @@ bool ChatHandler::HandleMmapPathCommand(char* args)
     // path
     PathFinder path(originUnit);
     path.setUseStrightPath(useStraightPath);
+    path.setLongPath(longPath);
     path.calculate(x, y, z);
 
     PointsArray pointPath = path.getPath();
     PSendSysMessage("%s's path to %s:", originUnit->GetName(), destinationUnit->GetName());
-    PSendSysMessage("Building %s", useStraightPath ? "StraightPath" : "SmoothPath");
+    PSendSysMessage("Building %s%s", useStraightPath ? "StraightPath" : "SmoothPath", longPath ? " (long)" : "");
     PSendSysMessage("length " SIZEFMTD " type %u", pointPath.size(), path.getPathType());
 
     Vector3 start = path.getStartPosition();
@@ -5007,8 +5012,9 @@ bool ChatHandler::HandleMmapLocCommand(char* /*args*/)
     PSendSysMessage("gridloc [%i,%i]", gy, gx);
 
     // calculate navmesh tile location
-    const dtNavMesh* navmesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(player->GetMapId());
-    const dtNavMeshQuery* navmeshquery = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshQuery(player->GetMapId(), player->GetInstanceId());
+    MMAP::NavMeshQueryGuard navMeshGuard(player->GetMapId());
+    const dtNavMesh* navmesh = navMeshGuard.GetNavMesh();
+    const dtNavMeshQuery* navmeshquery = navMeshGuard.GetNavMeshQuery();
     if (!navmesh || !navmeshquery)
     {
         PSendSysMessage("NavMesh not loaded for current map.");
@@ -5052,8 +5058,9 @@ bool ChatHandler::HandleMmapLoadedTilesCommand(char* /*args*/)
 {
     uint32 mapid = m_session->GetPlayer()->GetMapId();
 
-    const dtNavMesh* navmesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(mapid);
-    const dtNavMeshQuery* navmeshquery = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshQuery(mapid, m_session->GetPlayer()->GetInstanceId());
+    MMAP::NavMeshQueryGuard navMeshGuard(mapid);
+    const dtNavMesh* navmesh = navMeshGuard.GetNavMesh();
+    const dtNavMeshQuery* navmeshquery = navMeshGuard.GetNavMeshQuery();
     if (!navmesh || !navmeshquery)
     {
         PSendSysMessage("NavMesh not loaded for current map.");
@@ -5082,7 +5089,13 @@ bool ChatHandler::HandleMmapStatsCommand(char* /*args*/)
     MMAP::MMapManager* manager = MMAP::MMapFactory::createOrGetMMapManager();
     PSendSysMessage(" %u maps loaded with %u tiles overall", manager->getLoadedMapsCount(), manager->getLoadedTilesCount());
 
-    const dtNavMesh* navmesh = manager->GetNavMesh(m_session->GetPlayer()->GetMapId());
+    MMAP::MMapPathCacheStats cacheStats = manager->getPathCacheStats();
+    uint64 lookups = cacheStats.hits + cacheStats.misses;
+    PSendSysMessage(" path cache: " UI64FMTD " hits, " UI64FMTD " misses (%.1f%% hits), " UI64FMTD " corridors dropped by tile changes",
+        cacheStats.hits, cacheStats.misses, lookups ? float(cacheStats.hits) * 100.0f / lookups : 0.0f, cacheStats.invalidations);
+
+    MMAP::NavMeshQueryGuard navMeshGuard(m_session->GetPlayer()->GetMapId());
+    const dtNavMesh* navmesh = navMeshGuard.GetNavMesh();
     if (!navmesh)
     {
         PSendSysMessage("NavMesh not loaded for current map.");
@@ -777,6 +777,7 @@ bool ChatHandler::HandleReloadSpellElixirCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Spell Elixir types...");
     sSpellMgr.LoadSpellElixirs();
+    sSpellMgr.LoadSpellClassifications();
     SendGlobalSysMessage("DB table `spell_elixir` (spell elixir types) reloaded.");
     return true;
 }
@@ -793,6 +794,7 @@ bool ChatHandler::HandleReloadSpellProcEventCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Spell Proc Event conditions...");
     sSpellMgr.LoadSpellProcEvents();
+    sSpellMgr.LoadSpellClassifications();
     SendGlobalSysMessage("DB table `spell_proc_event` (spell proc trigger requirements) reloaded.");
     return true;
 }
@@ -4676,6 +4678,7 @@ static bool HandleResetStatsOrLevelHelper(Player* player)
 
     player->SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, DEFAULT_WORLD_OBJECT_SIZE);
     player->SetFloatValue(UNIT_FIELD_COMBATREACH, 1.5f);
+    player->UpdateGridIndex();
 
     player->setFactionForRace(player->getRace());
 
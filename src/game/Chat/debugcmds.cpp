@@ -34,6 +34,8 @@
 #include "AI/ScriptDevAI/ScriptDevAIMgr.h"
 #include "Maps/InstanceData.h"
 #include "Cinematics/M2Stores.h"
+#include "Database/DatabaseEnv.h"
+#include "Utilities/PoolAllocator.h"
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
 {
@@ -1246,6 +1248,25 @@ bool ChatHandler::HandleDebugMaps(char* /*args*/)
     PSendSysMessage("Map[530] >> Min: %ums, Max: %ums, Avg: %ums",
         sMapMgr.GetMapUpdateMinTime(530), sMapMgr.GetMapUpdateMaxTime(530), sMapMgr.GetMapUpdateAvgTime(530));
 
+    MapUpdaterStats updaterStats = sMapMgr.GetMapUpdaterStats();
+    PSendSysMessage("Map updater >> Executed: " UI64FMTD ", Stolen: " UI64FMTD ", Last tick: %uus, Idle: %uus",
+        updaterStats.executed, updaterStats.stolen, sMapMgr.GetMapUpdaterTickTime(), sMapMgr.GetMapUpdaterIdleTime());
+
+    ValuesUpdateCacheStats cacheStats = Object::GetValuesUpdateCacheStats();
+    PSendSysMessage("Values update cache >> Hits: " UI64FMTD ", Misses: " UI64FMTD ", Bytes saved: " UI64FMTD,
+        cacheStats.hits, cacheStats.misses, cacheStats.bytesSaved);
+
+    GridLoadStats gridStats = sTerrainMgr.GetGridLoadStats();
+    PSendSysMessage("Grid loading >> Loads: " UI64FMTD ", Avg: " UI64FMTD "us, Max: " UI64FMTD "us",
+        gridStats.loads, gridStats.loads ? gridStats.loadTime / gridStats.loads : 0, gridStats.maxLoadTime);
+    PSendSysMessage("Grid prefetch >> Requested: " UI64FMTD ", Used: " UI64FMTD ", Late: " UI64FMTD ", Expired: " UI64FMTD,
+        gridStats.prefetch[GRID_PREFETCH_REQUESTED], gridStats.prefetch[GRID_PREFETCH_USED], gridStats.prefetch[GRID_PREFETCH_LATE], gridStats.prefetch[GRID_PREFETCH_EXPIRED]);
+
+    PathSearchStats pathStats = sMapMgr.GetPathSearchStats();
+    uint64 pathSearches = pathStats.requests - pathStats.deduplicated;
+    PSendSysMessage("Path search >> Requests: " UI64FMTD ", Shared: " UI64FMTD ", Avg wait: " UI64FMTD "us, Max wait: " UI64FMTD "us",
+        pathStats.requests, pathStats.deduplicated, pathSearches ? pathStats.waitTime / pathSearches : 0, pathStats.maxWaitTime);
+
     if (m_session)
     {
         Player* player = m_session->GetPlayer();
@@ -1253,7 +1274,16 @@ bool ChatHandler::HandleDebugMaps(char* /*args*/)
             return true;
 
         if (player->GetMap()->IsContinent())
+        {
+            std::vector<MapRegionStats> regionStats = player->GetMap()->GetLastRegionStats();
+            if (regionStats.empty())
+                return true;
+
+            PSendSysMessage("Map[%u] region update statistics (last tick):", player->GetMap()->GetId());
+            for (uint32 i = 0; i < regionStats.size(); ++i)
+                PSendSysMessage("Region[%u] >> Grids: %u, Objects: %u, Time: %uus", i, regionStats[i].grids, regionStats[i].objects, regionStats[i].updateTime);
             return true;
+        }
 
         uint32 mapId = player->GetMap()->GetId();
         uint32 instance = player->GetMap()->GetInstanceId();
@@ -1265,6 +1295,93 @@ bool ChatHandler::HandleDebugMaps(char* /*args*/)
     return true;
 }
 
+static void SendAsyncShardStats(ChatHandler* handler, char const* name, Database const& db)
+{
+    std::vector<SqlDelayThreadStats> shardStats = db.GetAsyncShardStats();
+    for (uint32 i = 0; i < shardStats.size(); ++i)
+        handler->PSendSysMessage("%s[%u] >> Queued: " SIZEFMTD ", Executed: " UI64FMTD ", Avg latency: %ums, Max latency: %ums",
+            name, i, shardStats[i].queued, shardStats[i].executed, shardStats[i].avgLatency, shardStats[i].maxLatency);
+}
+
+bool ChatHandler::HandleDebugDatabase(char* /*args*/)
+{
+    PSendSysMessage("Async database connections statistics:");
+    SendAsyncShardStats(this, "Character", CharacterDatabase);
+    SendAsyncShardStats(this, "World", WorldDatabase);
+    SendAsyncShardStats(this, "Login", LoginDatabase);
+
+    PlayerSaveStats saveStats = Player::GetSaveStats();
+    PSendSysMessage("Character saves >> Count: " UI64FMTD ", Statements: " UI64FMTD ", Per save: %.1f",
+        saveStats.saves, saveStats.statements, saveStats.saves ? float(saveStats.statements) / saveStats.saves : 0.0f);
+    return true;
+}
+
+bool ChatHandler::HandleDebugSocket(char* /*args*/)
+{
+    Player* target = getSelectedPlayer();
+    if (!target)
+    {
+        SendSysMessage(LANG_NO_CHAR_SELECTED);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    PacketPayloadStats payloadStats = WorldSocket::GetPayloadStats();
+    PSendSysMessage("Packet payloads >> Copied: " UI64FMTD " bytes, Referenced: " UI64FMTD " bytes",
+        payloadStats.copied, payloadStats.referenced);
+
+    MaNGOS::SocketSendStats stats;
+    if (!target->GetSession()->GetSocketSendStats(stats))
+    {
+        PSendSysMessage("%s has no connected socket.", target->GetName());
+        return true;
+    }
+
+    PSendSysMessage("Socket sends of %s >> Count: " UI64FMTD ", Bytes: " UI64FMTD ", Per send: " UI64FMTD,
+        target->GetName(), stats.sends, stats.bytes, stats.sends ? stats.bytes / stats.sends : 0);
+
+    SendSysMessage("Bytes per send:");
+    for (size_t i = 0; i < MaNGOS::SocketSendStats::HistogramBuckets; ++i)
+    {
+        if (!stats.sizeHistogram[i])
+            continue;
+
+        if (i + 1 < MaNGOS::SocketSendStats::HistogramBuckets)
+            PSendSysMessage("  < %u: %u", 64u << i, stats.sizeHistogram[i]);
+        else
+            PSendSysMessage("  >= %u: %u", 64u << (i - 1), stats.sizeHistogram[i]);
+    }
+
+    SendSysMessage("Queueing latency:");
+    for (size_t i = 0; i < MaNGOS::SocketSendStats::HistogramBuckets; ++i)
+    {
+        if (!stats.latencyHistogram[i])
+            continue;
+
+        if (i + 1 < MaNGOS::SocketSendStats::HistogramBuckets)
+            PSendSysMessage("  < %ums: %u", 1u << i, stats.latencyHistogram[i]);
+        else
+            PSendSysMessage("  >= %ums: %u", 1u << (i - 1), stats.latencyHistogram[i]);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleDebugMemory(char* /*args*/)
+{
+    std::vector<PoolAllocatorStats> stats;
+    PoolAllocator::GetAllStats(stats);
+
+    SendSysMessage("Pooled allocations:");
+    for (PoolAllocatorStats const& pool : stats)
+    {
+        PSendSysMessage("%s >> Allocations: " UI64FMTD ", Live: " UI64FMTD " (" UI64FMTD " KB), Chunks: " UI64FMTD " KB",
+            pool.name, pool.allocations, pool.live, pool.liveBytes / 1024, pool.chunkBytes / 1024);
+    }
+
+    return true;
+}
+
 bool ChatHandler::HandleShowTemporarySpawnList(char* /*args*/)
 {
     Player* pPlayer = m_session->GetPlayer();
@@ -26,6 +26,8 @@
 #include "Entities/UnitEvents.h"
 #include "Spells/SpellAuras.h"
 
+#include <algorithm>
+
 //==============================================================
 //================= ThreatCalcHelper ===========================
 //==============================================================
@@ -81,7 +83,7 @@ float ThreatCalcHelper::CalcThreat(Unit* hatedUnit, Unit* hatingUnit, float thre
 //============================================================
 
 HostileReference::HostileReference(Unit* unit, ThreatManager* threatManager, float threat) : 
-    m_hostileState(STATE_NORMAL), m_tauntState(STATE_NONE)
+    m_hostileState(STATE_NORMAL), m_tauntState(STATE_NONE), m_threatContainer(nullptr), m_repositionPending(false)
 {
     iThreat = threat;
     iFadeoutThreadReduction = 0.f;
@@ -234,6 +236,40 @@ void ThreatContainer::clearReferences()
         delete (*i);
     }
     iThreatList.clear();
+    iThreatIndex.clear();
+    iPendingRepositions.clear();
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* ref)
+{
+    if (ref->m_threatContainer != this)
+        return;
+
+    if (ref->m_repositionPending)
+    {
+        iPendingRepositions.erase(std::find(iPendingRepositions.begin(), iPendingRepositions.end(), ref));
+        ref->m_repositionPending = false;
+    }
+
+    iThreatList.erase(ref->m_threatListPosition);
+    iThreatIndex.erase(ref->getUnitGuid());
+    ref->m_threatContainer = nullptr;
+}
+
+void ThreatContainer::addReference(HostileReference* hostileReference)
+{
+    if (hostileReference->m_threatContainer)
+        hostileReference->m_threatContainer->remove(hostileReference);
+
+    hostileReference->m_threatListPosition = iThreatList.insert(iThreatList.end(), hostileReference);
+    iThreatIndex[hostileReference->getUnitGuid()] = hostileReference;
+    hostileReference->m_threatContainer = this;
+
+    // appended at the end, update() has to place it even when its threat never changes
+    if (hostileReference->isOnline())
+        reposition(hostileReference);
 }
 
 //============================================================
@@ -244,13 +280,8 @@ HostileReference* ThreatContainer::getReferenceByTarget(Unit* victim)
     if (!victim)
         return nullptr;
 
-    ObjectGuid guid = victim->GetObjectGuid();
-
-    for (ThreatList::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
-        if ((*i)->getUnitGuid() == guid)
-            return (*i);
-
-    return nullptr;
+    auto itr = iThreatIndex.find(victim->GetObjectGuid());
+    return itr != iThreatIndex.end() ? itr->second : nullptr;
 }
 
 //============================================================
@@ -300,6 +331,18 @@ void ThreatContainer::modifyAllThreatPercent(int32 threatPercent)
             itr->addThreatPercent(threatPercent);
     }
 }
+//============================================================
+// Order of the threat list, when the melee reach is not considered
+
+bool ThreatContainer::IsHigherPriority(HostileReference const* lhs, HostileReference const* rhs)
+{
+    if (lhs->GetTauntState() != rhs->GetTauntState())
+        return lhs->GetTauntState() > rhs->GetTauntState();
+    if (lhs->GetHostileState() != rhs->GetHostileState())
+        return lhs->GetHostileState() > rhs->GetHostileState();
+    return lhs->getThreat() > rhs->getThreat(); // reverse sorting
+}
+
 //============================================================
 // Check if the list is dirty and sort if necessary
 
@@ -307,26 +350,62 @@ void ThreatContainer::update(bool force)
 {
     if ((iDirty || force) && iThreatList.size() > 1)
     {
-        iThreatList.sort([&](const HostileReference* lhs, const HostileReference* rhs)->bool
+        clearPendingRepositions();
+
+        if (force)
         {
-            if (lhs->GetTauntState() != rhs->GetTauntState())
-                return lhs->GetTauntState() > rhs->GetTauntState();
-            Unit* owner = lhs->getSource()->getOwner();
-            if (force)
+            // melee reach depends on positions, it can't be kept up to date between updates
+            iThreatList.sort([&](const HostileReference* lhs, const HostileReference* rhs)->bool
             {
+                if (lhs->GetTauntState() != rhs->GetTauntState())
+                    return lhs->GetTauntState() > rhs->GetTauntState();
+                Unit* owner = lhs->getSource()->getOwner();
                 bool first = owner->CanReachWithMeleeAttack(lhs->getTarget());
                 bool second = owner->CanReachWithMeleeAttack(rhs->getTarget());
                 if (first != second)
                     return first > second;
-            }
-            if (lhs->GetHostileState() != rhs->GetHostileState())
-                return lhs->GetHostileState() > rhs->GetHostileState();
-            return lhs->getThreat() > rhs->getThreat(); // reverse sorting
-        });
+                return IsHigherPriority(lhs, rhs);
+            });
+            // the next threat changes can only be placed again after a plain sort
+            iDirty = true;
+            return;
+        }
+
+        iThreatList.sort(IsHigherPriority);
     }
+    else if (!iDirty && !iPendingRepositions.empty())
+    {
+        // the untouched references are still ordered, sort the changed ones and merge them back
+        ThreatList changed;
+        for (HostileReference* ref : iPendingRepositions)
+            changed.splice(changed.end(), iThreatList, ref->m_threatListPosition);
+        changed.sort(IsHigherPriority);
+        iThreatList.merge(changed, IsHigherPriority);
+    }
+
+    clearPendingRepositions();
     iDirty = false;
 }
 
+//============================================================
+// Threat changes of single references are merged in the next update instead of sorting the whole list
+
+void ThreatContainer::reposition(HostileReference* ref)
+{
+    if (iDirty || ref->m_threatContainer != this || ref->m_repositionPending)
+        return;
+
+    ref->m_repositionPending = true;
+    iPendingRepositions.push_back(ref);
+}
+
+void ThreatContainer::clearPendingRepositions()
+{
+    for (HostileReference* ref : iPendingRepositions)
+        ref->m_repositionPending = false;
+    iPendingRepositions.clear();
+}
+
 //============================================================
 // return the next best victim
 // could be the current victim
@@ -632,9 +711,7 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent& threatRefStat
     switch (threatRefStatusChangeEvent.getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
-            if ((getCurrentVictim() == hostileReference && threatRefStatusChangeEvent.getFValue() < 0.0f) ||
-                    (getCurrentVictim() != hostileReference && threatRefStatusChangeEvent.getFValue() > 0.0f))
-                setDirty(true);                             // the order in the threat list might have changed
+            iThreatContainer.reposition(hostileReference);  // the order in the threat list might have changed
             break;
         case UEV_THREAT_REF_ONLINE_STATUS:
             if (!hostileReference->isOnline())
@@ -651,11 +728,9 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent& threatRefStat
             }
             else
             {
-                if (getCurrentVictim() && hostileReference->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
-                    setDirty(true);
+                iThreatOfflineContainer.remove(hostileReference);
                 iThreatContainer.addReference(hostileReference);
                 iUpdateNeed = true;
-                iThreatOfflineContainer.remove(hostileReference);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
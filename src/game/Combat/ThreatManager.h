@@ -26,13 +26,19 @@
 #include "Timer.h"
 #include "Entities/ObjectGuid.h"
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 //==============================================================
 
 class Unit;
 class ThreatManager;
+class ThreatContainer;
+class HostileReference;
 struct SpellEntry;
 
+typedef std::list<HostileReference*> ThreatList;
+
 #define THREAT_UPDATE_INTERVAL (1 * IN_MILLISECONDS)        // Server should send threat update to client periodically each second
 
 //==============================================================
@@ -61,6 +67,8 @@ enum TauntState : uint32
 //==============================================================
 class HostileReference : public Reference<Unit, ThreatManager>
 {
+        friend class ThreatContainer;
+
     public:
         HostileReference(Unit* unit, ThreatManager* threatManager, float threat);
 
@@ -142,12 +150,13 @@ class HostileReference : public Reference<Unit, ThreatManager>
         ObjectGuid iUnitGuid;
         bool m_online;
         bool iAccessible;
+
+        ThreatContainer* m_threatContainer;                 // container holding the reference, online or offline
+        ThreatList::iterator m_threatListPosition;          // position in the list of that container
+        bool m_repositionPending;                           // threat changed since the last ThreatContainer::update
 };
 
 //==============================================================
-class ThreatManager;
-
-typedef std::list<HostileReference*> ThreatList;
 
 class ThreatContainer
 {
@@ -176,14 +185,22 @@ class ThreatContainer
     protected:
         friend class ThreatManager;
 
-        void remove(HostileReference* ref) { iThreatList.remove(ref); }
-        void addReference(HostileReference* hostileReference) { iThreatList.push_back(hostileReference); }
+        void remove(HostileReference* ref);
+        void addReference(HostileReference* hostileReference);
         void clearReferences();
         // Sort the list if necessary
         void update(bool force);
+        // Remember a reference with changed threat, update() merges it back into the ordered list.
+        // The list is only reordered in update(), so callers can change threat while iterating getThreatList()
+        void reposition(HostileReference* ref);
+        void clearPendingRepositions();
+
+        static bool IsHigherPriority(HostileReference const* lhs, HostileReference const* rhs);
 
         ThreatList iThreatList;
     private:
+        std::unordered_map<ObjectGuid, HostileReference*> iThreatIndex; // iThreatList by target guid
+        std::vector<HostileReference*> iPendingRepositions;
         bool iDirty;
 };
 
@@ -150,6 +150,19 @@ void Camera::UpdateVisibilityForOwner()
     notifier.Notify();
 }
 
+void Camera::CollectVisibilityCandidates(VisibilityCandidates& candidates, bool dontLoad) const
+{
+    MaNGOS::VisibilityCandidateCollector collector(candidates);
+    Cell::VisitAllObjects(m_source, collector, m_source->GetVisibilityData().GetVisibilityDistance(), dontLoad);
+}
+
+void Camera::UpdateVisibilityForOwner(VisibilityCandidates const& candidates)
+{
+    MaNGOS::VisibleNotifier notifier(*this);
+    notifier.Visit(candidates);
+    notifier.Notify();
+}
+
 //////////////////
 
 ViewPoint::~ViewPoint()
@@ -27,6 +27,22 @@ class ViewPoint;
 class UpdateData;
 class WorldPacket;
 
+/// objects around a viewpoint, collected apart from the visibility update so that the grid scan can run on a worker thread
+struct VisibilityCandidates
+{
+    std::vector<Player*> players;
+    std::vector<Creature*> creatures;
+    std::vector<Corpse*> corpses;
+    std::vector<GameObject*> gameObjects;
+    std::vector<DynamicObject*> dynamicObjects;
+
+    void Add(Player* obj) { players.push_back(obj); }
+    void Add(Creature* obj) { creatures.push_back(obj); }
+    void Add(Corpse* obj) { corpses.push_back(obj); }
+    void Add(GameObject* obj) { gameObjects.push_back(obj); }
+    void Add(DynamicObject* obj) { dynamicObjects.push_back(obj); }
+};
+
 /// Camera - object-receiver. Receives broadcast packets from nearby worldobjects, object visibility changes and sends them to client
 class Camera
 {
@@ -56,6 +72,11 @@ class Camera
         // updates visibility of worldobjects around viewpoint for camera's owner
         void UpdateVisibilityForOwner();
 
+        // same update split in two steps, used by the batched visibility pass of the map:
+        // collecting only reads the grids and may run on a worker thread, the update has to run on the map thread
+        void CollectVisibilityCandidates(VisibilityCandidates& candidates, bool dontLoad) const;
+        void UpdateVisibilityForOwner(VisibilityCandidates const& candidates);
+
     private:
         // called when viewpoint changes visibility state
         void Event_AddedToWorld();
@@ -71,6 +92,8 @@ class Camera
     public:
         GridReference<Camera>& GetGridRef() { return m_gridRef; }
         bool isActiveObject() const { return false; }
+        void AddToGridIndex(GridObjectIndex& /*index*/) {}
+        void RemoveFromGridIndex() {}
     private:
         GridReference<Camera> m_gridRef;
 };
@@ -80,8 +103,10 @@ class ViewPoint
 {
         friend class Camera;
 
+    public:
         typedef std::list<Camera*> CameraList;
 
+    private:
         CameraList m_cameras;
         GridType* m_grid;
 
@@ -106,6 +131,7 @@ class ViewPoint
         ~ViewPoint();
 
         bool hasViewers() const { return !m_cameras.empty(); }
+        CameraList const& GetCameras() const { return m_cameras; }
 
         // these events are called when viewpoint changes visibility state
         void Event_AddedToWorld(GridType* grid)
@@ -188,31 +188,32 @@ void WorldSession::HandleCharEnum(QueryResult* result)
 void WorldSession::HandleCharEnumOpcode(WorldPacket& /*recv_data*/)
 {
     /// get all the data necessary for loading all characters (along with their pets) on the account
-    CharacterDatabase.AsyncPQuery(&chrHandler, &CharacterHandler::HandleCharEnumCallback, GetAccountId(),
-                                  !sWorld.getConfig(CONFIG_BOOL_DECLINED_NAMES_USED) ?
-                                  //   ------- Query Without Declined Names --------
-                                  //           0               1                2                3                 4                  5                       6                        7
-                                  "SELECT characters.guid, characters.name, characters.race, characters.class, characters.gender, characters.playerBytes, characters.playerBytes2, characters.level, "
-                                  //   8                9               10                     11                     12                     13                    14
-                                  "characters.zone, characters.map, characters.position_x, characters.position_y, characters.position_z, guild_member.guildid, characters.playerFlags, "
-                                  //  15                    16                   17                     18                   19
-                                  "characters.at_login, character_pet.entry, character_pet.modelid, character_pet.level, characters.equipmentCache "
-                                  "FROM characters LEFT JOIN character_pet ON characters.guid=character_pet.owner AND character_pet.slot='%u' "
-                                  "LEFT JOIN guild_member ON characters.guid = guild_member.guid "
-                                  "WHERE characters.account = '%u' ORDER BY characters.guid"
-                                  :
-                                  //   --------- Query With Declined Names ---------
-                                  //           0               1                2                3                 4                  5                       6                        7
-                                  "SELECT characters.guid, characters.name, characters.race, characters.class, characters.gender, characters.playerBytes, characters.playerBytes2, characters.level, "
-                                  //   8                9               10                     11                     12                     13                    14
-                                  "characters.zone, characters.map, characters.position_x, characters.position_y, characters.position_z, guild_member.guildid, characters.playerFlags, "
-                                  //  15                    16                   17                     18                   19                         20
-                                  "characters.at_login, character_pet.entry, character_pet.modelid, character_pet.level, characters.equipmentCache, character_declinedname.genitive "
-                                  "FROM characters LEFT JOIN character_pet ON characters.guid = character_pet.owner AND character_pet.slot='%u' "
-                                  "LEFT JOIN character_declinedname ON characters.guid = character_declinedname.guid "
-                                  "LEFT JOIN guild_member ON characters.guid = guild_member.guid "
-                                  "WHERE characters.account = '%u' ORDER BY characters.guid",
-                                  PET_SAVE_AS_CURRENT, GetAccountId());
+    /// the characters are saved under their own shard keys, so read them after the saves queued on all shards
+    CharacterDatabase.AsyncPQueryOrdered(&chrHandler, &CharacterHandler::HandleCharEnumCallback, GetAccountId(),
+                                         !sWorld.getConfig(CONFIG_BOOL_DECLINED_NAMES_USED) ?
+                                         //   ------- Query Without Declined Names --------
+                                         //           0               1                2                3                 4                  5                       6                        7
+                                         "SELECT characters.guid, characters.name, characters.race, characters.class, characters.gender, characters.playerBytes, characters.playerBytes2, characters.level, "
+                                         //   8                9               10                     11                     12                     13                    14
+                                         "characters.zone, characters.map, characters.position_x, characters.position_y, characters.position_z, guild_member.guildid, characters.playerFlags, "
+                                         //  15                    16                   17                     18                   19
+                                         "characters.at_login, character_pet.entry, character_pet.modelid, character_pet.level, characters.equipmentCache "
+                                         "FROM characters LEFT JOIN character_pet ON characters.guid=character_pet.owner AND character_pet.slot='%u' "
+                                         "LEFT JOIN guild_member ON characters.guid = guild_member.guid "
+                                         "WHERE characters.account = '%u' ORDER BY characters.guid"
+                                         :
+                                         //   --------- Query With Declined Names ---------
+                                         //           0               1                2                3                 4                  5                       6                        7
+                                         "SELECT characters.guid, characters.name, characters.race, characters.class, characters.gender, characters.playerBytes, characters.playerBytes2, characters.level, "
+                                         //   8                9               10                     11                     12                     13                    14
+                                         "characters.zone, characters.map, characters.position_x, characters.position_y, characters.position_z, guild_member.guildid, characters.playerFlags, "
+                                         //  15                    16                   17                     18                   19                         20
+                                         "characters.at_login, character_pet.entry, character_pet.modelid, character_pet.level, characters.equipmentCache, character_declinedname.genitive "
+                                         "FROM characters LEFT JOIN character_pet ON characters.guid = character_pet.owner AND character_pet.slot='%u' "
+                                         "LEFT JOIN character_declinedname ON characters.guid = character_declinedname.guid "
+                                         "LEFT JOIN guild_member ON characters.guid = guild_member.guid "
+                                         "WHERE characters.account = '%u' ORDER BY characters.guid",
+                                         PET_SAVE_AS_CURRENT, GetAccountId());
 }
 
 void WorldSession::HandleCharCreateOpcode(WorldPacket& recv_data)
@@ -630,6 +631,9 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recv_data)
         return;
     }
 
+    // load after pending saves of this character
+    holder->SetShardKey(playerGuid.GetCounter());
+
     CharacterDatabase.DelayQueryHolder(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
 }
 
@@ -652,6 +656,8 @@ void PlayerbotMgr::LoginPlayerBot(ObjectGuid playerGuid)
         delete holder;                                      // delete all unprocessed queries
         return;
     }
+
+    holder->SetShardKey(playerGuid.GetCounter());
     CharacterDatabase.DelayQueryHolder(&chrHandler, &CharacterHandler::HandlePlayerBotLoginCallback, holder);
 }
 #endif
@@ -806,8 +812,10 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
     static SqlStatementID updChars;
     static SqlStatementID updAccount;
 
+    CharacterDatabase.BeginTransaction(pCurrChar->GetGUIDLow());
     SqlStatement stmt = CharacterDatabase.CreateStatement(updChars, "UPDATE characters SET online = 1 WHERE guid = ?");
     stmt.PExecute(pCurrChar->GetGUIDLow());
+    CharacterDatabase.CommitTransaction();
 
     stmt = LoginDatabase.CreateStatement(updAccount, "UPDATE account SET active_realm_id = ? WHERE id = ?");
     stmt.PExecute(realmID, GetAccountId());
@@ -1155,11 +1163,11 @@ void WorldSession::HandleCharRenameOpcode(WorldPacket& recv_data)
     CharacterDatabase.escape_string(escaped_newname);
 
     // make sure that the character belongs to the current account, that rename at login is enabled
-    // and that there is no character with the desired new name
-    CharacterDatabase.AsyncPQuery(&WorldSession::HandleChangePlayerNameOpcodeCallBack,
-                                  GetAccountId(), newname,
-                                  "SELECT guid, name FROM characters WHERE guid = %u AND account = %u AND (at_login & %u) = %u AND NOT EXISTS (SELECT NULL FROM characters WHERE name = '%s')",
-                                  guid.GetCounter(), GetAccountId(), AT_LOGIN_RENAME, AT_LOGIN_RENAME, escaped_newname.c_str()
+    // and that there is no character with the desired new name, after the saves queued on all shards
+    CharacterDatabase.AsyncPQueryOrdered(&WorldSession::HandleChangePlayerNameOpcodeCallBack,
+                                         GetAccountId(), newname,
+                                         "SELECT guid, name FROM characters WHERE guid = %u AND account = %u AND (at_login & %u) = %u AND NOT EXISTS (SELECT NULL FROM characters WHERE name = '%s')",
+                                         guid.GetCounter(), GetAccountId(), AT_LOGIN_RENAME, AT_LOGIN_RENAME, escaped_newname.c_str()
                                  );
 }
 
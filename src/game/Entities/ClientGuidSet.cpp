@@ -0,0 +1,131 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Entities/ClientGuidSet.h"
+
+uint32 ClientGuidSet::FindSlot(uint64 raw) const
+{
+    if (!raw || m_guids.empty())
+        return NoSlot;
+
+    uint32 mask = uint32(m_guids.size() - 1);
+    for (uint32 slot = Hash(raw) & mask; m_guids[slot]; slot = (slot + 1) & mask)
+        if (m_guids[slot] == raw)
+            return slot;
+
+    return NoSlot;
+}
+
+void ClientGuidSet::insert(ObjectGuid guid)
+{
+    uint64 raw = guid.GetRawValue();
+    if (!raw)
+        return;
+
+    // keep the load factor at most 1/2, probe sequences stay short
+    if ((m_size + 1) * 2 > m_guids.size())
+        Grow();
+
+    uint32 mask = uint32(m_guids.size() - 1);
+    uint32 slot = Hash(raw) & mask;
+    for (; m_guids[slot]; slot = (slot + 1) & mask)
+    {
+        if (m_guids[slot] == raw)
+        {
+            m_seenInPass[slot] = m_pass;
+            return;
+        }
+    }
+
+    m_guids[slot] = raw;
+    m_seenInPass[slot] = m_pass;
+    ++m_size;
+}
+
+void ClientGuidSet::erase(ObjectGuid guid)
+{
+    uint32 slot = FindSlot(guid.GetRawValue());
+    if (slot == NoSlot)
+        return;
+
+    // backward shift deletion, entries after the hole which may not stay behind it are moved into it
+    uint32 mask = uint32(m_guids.size() - 1);
+    uint32 hole = slot;
+    for (uint32 next = (hole + 1) & mask; m_guids[next]; next = (next + 1) & mask)
+    {
+        uint32 home = Hash(m_guids[next]) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_guids[hole] = m_guids[next];
+            m_seenInPass[hole] = m_seenInPass[next];
+            hole = next;
+        }
+    }
+
+    m_guids[hole] = 0;
+    --m_size;
+}
+
+void ClientGuidSet::clear()
+{
+    m_guids.clear();
+    m_seenInPass.clear();
+    m_size = 0;
+}
+
+void ClientGuidSet::MarkSeen(ObjectGuid guid)
+{
+    uint32 slot = FindSlot(guid.GetRawValue());
+    if (slot != NoSlot)
+        m_seenInPass[slot] = m_pass;
+}
+
+bool ClientGuidSet::IsSeen(ObjectGuid guid) const
+{
+    uint32 slot = FindSlot(guid.GetRawValue());
+    return slot != NoSlot && m_seenInPass[slot] == m_pass;
+}
+
+void ClientGuidSet::GetUnseen(GuidVector& unseen) const
+{
+    for (uint32 slot = 0; slot < m_guids.size(); ++slot)
+        if (m_guids[slot] && m_seenInPass[slot] != m_pass)
+            unseen.push_back(ObjectGuid(m_guids[slot]));
+}
+
+void ClientGuidSet::Grow()
+{
+    std::vector<uint64> guids(std::max<size_t>(MinCapacity, m_guids.size() * 2), 0);
+    std::vector<uint32> seenInPass(guids.size(), 0);
+    guids.swap(m_guids);
+    seenInPass.swap(m_seenInPass);
+
+    uint32 mask = uint32(m_guids.size() - 1);
+    for (uint32 i = 0; i < guids.size(); ++i)
+    {
+        if (!guids[i])
+            continue;
+
+        uint32 slot = Hash(guids[i]) & mask;
+        while (m_guids[slot])
+            slot = (slot + 1) & mask;
+
+        m_guids[slot] = guids[i];
+        m_seenInPass[slot] = seenInPass[i];
+    }
+}
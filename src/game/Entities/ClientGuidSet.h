@@ -0,0 +1,96 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_CLIENT_GUID_SET_H
+#define MANGOS_CLIENT_GUID_SET_H
+
+#include "Common.h"
+#include "Entities/ObjectGuid.h"
+
+/**
+ * Set of the objects known to a player client.
+ *
+ * Open addressing with linear probing over a flat array, the empty guid marks a free slot.
+ * Every entry carries the number of the visibility pass which last saw it, so a pass marks
+ * the objects it visits and afterwards lists the ones it did not see, without copying the set.
+ */
+class ClientGuidSet
+{
+    public:
+        class const_iterator
+        {
+            public:
+                const_iterator(ClientGuidSet const& set, uint32 slot) : m_set(set), m_slot(slot) { Skip(); }
+
+                ObjectGuid operator*() const { return ObjectGuid(m_set.m_guids[m_slot]); }
+                const_iterator& operator++() { ++m_slot; Skip(); return *this; }
+                bool operator!=(const_iterator const& other) const { return m_slot != other.m_slot; }
+                bool operator==(const_iterator const& other) const { return m_slot == other.m_slot; }
+
+            private:
+                void Skip()
+                {
+                    while (m_slot < m_set.m_guids.size() && !m_set.m_guids[m_slot])
+                        ++m_slot;
+                }
+
+                ClientGuidSet const& m_set;
+                uint32 m_slot;
+        };
+
+        ClientGuidSet() : m_size(0), m_pass(0) {}
+
+        void insert(ObjectGuid guid);
+        void erase(ObjectGuid guid);
+        bool contains(ObjectGuid guid) const { return FindSlot(guid.GetRawValue()) != NoSlot; }
+        void clear();
+
+        bool empty() const { return m_size == 0; }
+        uint32 size() const { return m_size; }
+
+        const_iterator begin() const { return const_iterator(*this, 0); }
+        const_iterator end() const { return const_iterator(*this, uint32(m_guids.size())); }
+
+        // visibility pass: entries inserted during the pass count as seen
+        void BeginPass() { ++m_pass; }
+        void MarkSeen(ObjectGuid guid);
+        bool IsSeen(ObjectGuid guid) const;
+        void GetUnseen(GuidVector& unseen) const;
+
+    private:
+        static const uint32 NoSlot = uint32(-1);
+        static const uint32 MinCapacity = 64;
+
+        static uint32 Hash(uint64 raw)
+        {
+            raw ^= raw >> 33;
+            raw *= uint64(0xff51afd7ed558ccdULL);
+            raw ^= raw >> 33;
+            return uint32(raw);
+        }
+
+        uint32 FindSlot(uint64 raw) const;
+        void Grow();
+
+        std::vector<uint64> m_guids;
+        std::vector<uint32> m_seenInPass;
+        uint32 m_size;
+        uint32 m_pass;
+};
+
+#endif
@@ -2014,7 +2014,7 @@ void GameObject::UpdateCollisionState() const
     if (!m_model || !IsInWorld())
         return;
 
-    m_model->enable(IsCollisionEnabled() ? GetPhaseMask() : 0);
+    GetMap()->EnableGameObjectModel(*m_model, IsCollisionEnabled() ? GetPhaseMask() : 0);
 }
 
 void GameObject::UpdateModel()
@@ -43,6 +43,8 @@
 #include "Loot/LootMgr.h"
 #include "Spells/SpellMgr.h"
 
+#include <atomic>
+
 Object::Object(): m_updateFlag(0), m_itsNewObject(false)
 {
     m_objectTypeId      = TYPEID_OBJECT;
@@ -196,20 +198,126 @@ void Object::SendCreateUpdateToPlayer(Player* player) const
     player->GetSession()->SendPacket(packet);
 }
 
-void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
+// Unit fields hidden from non-allied observers by Fog of War stats settings
+static inline bool IsFogOfWarStatsField(uint16 index)
 {
-    ByteBuffer buf(500);
+    return index == UNIT_FIELD_RANGEDATTACKTIME ||
+           index == UNIT_FIELD_MINDAMAGE || index == UNIT_FIELD_MAXDAMAGE ||
+           index == UNIT_FIELD_MINOFFHANDDAMAGE || index == UNIT_FIELD_MAXOFFHANDDAMAGE ||
+           (index >= UNIT_FIELD_STAT0 && index < UNIT_FIELD_BASE_MANA) ||
+           index == UNIT_FIELD_BASE_HEALTH || index == UNIT_FIELD_ATTACK_POWER ||
+           index == UNIT_FIELD_ATTACK_POWER_MODS || index == UNIT_FIELD_ATTACK_POWER_MULTIPLIER ||
+           index == UNIT_FIELD_RANGED_ATTACK_POWER || index == UNIT_FIELD_RANGED_ATTACK_POWER_MODS ||
+           index == UNIT_FIELD_RANGED_ATTACK_POWER_MULTIPLIER || index == UNIT_FIELD_MINRANGEDDAMAGE ||
+           index == UNIT_FIELD_MAXRANGEDDAMAGE || (index >= UNIT_FIELD_POWER_COST_MODIFIER && index <= UNIT_FIELD_MAXHEALTHMODIFIER);
+}
 
-    buf << uint8(UPDATETYPE_VALUES);
-    buf << GetPackGUID();
+// Observer dependent parts of a values update block, observers with equal keys receive identical blocks
+enum ValuesUpdateViewFlags
+{
+    VALUES_VIEW_SELF            = 0x01,                     // object itself, gets private fields
+    VALUES_VIEW_GAMEMASTER      = 0x02,                     // alters UNIT_FIELD_FLAGS
+    VALUES_VIEW_FOW_HEALTH      = 0x04,                     // absolute health values visible
+    VALUES_VIEW_FOW_STATS       = 0x08,                     // stat values visible
+    VALUES_VIEW_UNCACHEABLE     = 0xFFFFFFFF                // block must be built per observer
+};
+
+static std::atomic<uint64> s_valuesCacheHits(0);
+static std::atomic<uint64> s_valuesCacheMisses(0);
+static std::atomic<uint64> s_valuesCacheBytesSaved(0);
+
+uint32 Object::GetValuesUpdateViewKey(UpdateMask const& updateMask, Player* target) const
+{
+    // other object types have per observer fields (quest gameobjects and alike), always build them separately
+    if (!isType(TYPEMASK_UNIT))
+        return VALUES_VIEW_UNCACHEABLE;
+
+    Unit const* unit = static_cast<Unit const*>(this);
+    if (unit->HasAuraState(AURA_STATE_CONFLAGRATE))
+        return VALUES_VIEW_UNCACHEABLE;
+
+    bool hasHealth = false;
+    bool hasStats = false;
+    for (uint16 index = 0; index < m_valuesCount; ++index)
+    {
+        if (!updateMask.GetBit(index))
+            continue;
+
+        switch (index)
+        {
+            case UNIT_NPC_FLAGS:
+                if (GetTypeId() == TYPEID_UNIT)
+                    return VALUES_VIEW_UNCACHEABLE;
+                break;
+            case UNIT_DYNAMIC_FLAGS:
+                return VALUES_VIEW_UNCACHEABLE;
+            case UNIT_FIELD_FACTIONTEMPLATE:
+                if (GetTypeId() == TYPEID_PLAYER && sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_GROUP))
+                    return VALUES_VIEW_UNCACHEABLE;
+                break;
+            case UNIT_FIELD_HEALTH:
+            case UNIT_FIELD_MAXHEALTH:
+                hasHealth = true;
+                break;
+            default:
+                if (IsFogOfWarStatsField(index))
+                    hasStats = true;
+                break;
+        }
+    }
 
+    uint32 viewKey = 0;
+    if (target == this)
+        viewKey |= VALUES_VIEW_SELF;
+    if (target->isGameMaster())
+        viewKey |= VALUES_VIEW_GAMEMASTER;
+    if (hasHealth && unit->IsFogOfWarVisibleHealth(target))
+        viewKey |= VALUES_VIEW_FOW_HEALTH;
+    if (hasStats && unit->IsFogOfWarVisibleStats(target))
+        viewKey |= VALUES_VIEW_FOW_STATS;
+    return viewKey;
+}
+
+ValuesUpdateCacheStats Object::GetValuesUpdateCacheStats()
+{
+    ValuesUpdateCacheStats stats;
+    stats.hits = s_valuesCacheHits;
+    stats.misses = s_valuesCacheMisses;
+    stats.bytesSaved = s_valuesCacheBytesSaved;
+    return stats;
+}
+
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, ValuesUpdateBlockCache* cache) const
+{
     UpdateMask updateMask;
     updateMask.SetCount(m_valuesCount);
 
     _SetUpdateBits(&updateMask, target);
+
+    uint32 viewKey = cache ? GetValuesUpdateViewKey(updateMask, target) : VALUES_VIEW_UNCACHEABLE;
+    if (viewKey != VALUES_VIEW_UNCACHEABLE)
+    {
+        if (ByteBuffer const* block = cache->Find(viewKey))
+        {
+            data->AddUpdateBlock(*block);
+            ++s_valuesCacheHits;
+            s_valuesCacheBytesSaved += block->size();
+            return;
+        }
+        ++s_valuesCacheMisses;
+    }
+
+    ByteBuffer buf(500);
+
+    buf << uint8(UPDATETYPE_VALUES);
+    buf << GetPackGUID();
+
     BuildValuesUpdate(UPDATETYPE_VALUES, &buf, &updateMask, target);
 
     data->AddUpdateBlock(buf);
+
+    if (viewKey != VALUES_VIEW_UNCACHEABLE)
+        cache->Add(viewKey, buf);
 }
 
 void Object::BuildForcedValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
@@ -563,16 +671,7 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
                     *data << value;
                 }
                 // Fog of War: hide stat values for non-allied units according to settings
-                else if ((index == UNIT_FIELD_RANGEDATTACKTIME ||
-                          index == UNIT_FIELD_MINDAMAGE || index == UNIT_FIELD_MAXDAMAGE ||
-                          index == UNIT_FIELD_MINOFFHANDDAMAGE || index == UNIT_FIELD_MAXOFFHANDDAMAGE ||
-                          (index >= UNIT_FIELD_STAT0 && index < UNIT_FIELD_BASE_MANA) ||
-                          index == UNIT_FIELD_BASE_HEALTH || index == UNIT_FIELD_ATTACK_POWER ||
-                          index == UNIT_FIELD_ATTACK_POWER_MODS || index == UNIT_FIELD_ATTACK_POWER_MULTIPLIER ||
-                          index == UNIT_FIELD_RANGED_ATTACK_POWER || index == UNIT_FIELD_RANGED_ATTACK_POWER_MODS ||
-                          index == UNIT_FIELD_RANGED_ATTACK_POWER_MULTIPLIER || index == UNIT_FIELD_MINRANGEDDAMAGE ||
-                          index == UNIT_FIELD_MAXRANGEDDAMAGE || (index >= UNIT_FIELD_POWER_COST_MODIFIER && index <= UNIT_FIELD_MAXHEALTHMODIFIER)) &&
-                          !static_cast<const Unit*>(this)->IsFogOfWarVisibleStats(target))
+                else if (IsFogOfWarStatsField(index) && !static_cast<const Unit*>(this)->IsFogOfWarVisibleStats(target))
                 {
                     *data << uint32(0);
                 }
@@ -1113,7 +1212,7 @@ bool Object::PrintEntryError(char const* descr) const
     return false;
 }
 
-void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const
+void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateBlockCache* cache) const
 {
     UpdateDataMapType::iterator iter = update_players.find(pl);
 
@@ -1124,7 +1223,7 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first, cache);
 }
 
 void Object::AddToClientUpdateList()
@@ -1195,6 +1294,8 @@ void WorldObject::Relocate(float x, float y, float z, float orientation)
 
     if (isType(TYPEMASK_UNIT))
         ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, orientation);
+
+    UpdateGridIndex();
 }
 
 void WorldObject::Relocate(float x, float y, float z)
@@ -1205,6 +1306,26 @@ void WorldObject::Relocate(float x, float y, float z)
 
     if (isType(TYPEMASK_UNIT))
         ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, GetOrientation());
+
+    UpdateGridIndex();
+}
+
+void WorldObject::AddToGridIndex(GridObjectIndex& index)
+{
+    RemoveFromGridIndex();
+    index.Insert(m_gridIndexRef, this, m_objectType, m_position.x, m_position.y, GetCombatReach());
+}
+
+void WorldObject::RemoveFromGridIndex()
+{
+    if (m_gridIndexRef.index)
+        m_gridIndexRef.index->Remove(m_gridIndexRef);
+}
+
+void WorldObject::UpdateGridIndex()
+{
+    if (m_gridIndexRef.index)
+        m_gridIndexRef.index->Update(m_gridIndexRef, m_position.x, m_position.y, GetCombatReach());
 }
 
 void WorldObject::SetOrientation(float orientation)
@@ -2259,12 +2380,13 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
+    ValuesUpdateBlockCache i_blockCache;                    // same field values are sent to most observers
     WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj)
     {
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
         if (i_object.isType(TYPEMASK_PLAYER))
-            i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas);
+            i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas, &i_blockCache);
     }
 
     void Visit(CameraMapType& m)
@@ -2273,7 +2395,7 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter.getSource()->GetOwner();
             if (owner != &i_object && owner->HaveAtClient(&i_object))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_blockCache);
         }
     }
 
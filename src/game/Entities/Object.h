@@ -118,6 +118,31 @@ class Spell;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
 
+// Values update blocks of one object already built during current update, keyed by observer view
+class ValuesUpdateBlockCache
+{
+    public:
+        ByteBuffer const* Find(uint32 viewKey) const
+        {
+            for (auto const& block : m_blocks)
+                if (block.first == viewKey)
+                    return &block.second;
+            return nullptr;
+        }
+
+        void Add(uint32 viewKey, ByteBuffer const& block) { m_blocks.push_back(std::make_pair(viewKey, block)); }
+
+    private:
+        std::vector<std::pair<uint32, ByteBuffer> > m_blocks;
+};
+
+struct ValuesUpdateCacheStats
+{
+    uint64 hits;
+    uint64 misses;
+    uint64 bytesSaved;
+};
+
 class CooldownData
 {
         friend class CooldownContainer;
@@ -378,7 +403,8 @@ class Object
         void MarkForClientUpdate();
         void SendForcedObjectUpdate();
 
-        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
+        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, ValuesUpdateBlockCache* cache = nullptr) const;
+        static ValuesUpdateCacheStats GetValuesUpdateCacheStats();
         void BuildForcedValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
         void BuildOutOfRangeUpdateBlock(UpdateData* data) const;
         void BuildMovementUpdateBlock(UpdateData* data, uint16 flags = 0) const;
@@ -589,7 +615,8 @@ class Object
 
         void BuildMovementUpdate(ByteBuffer* data, uint16 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
-        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const;
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateBlockCache* cache = nullptr) const;
+        uint32 GetValuesUpdateViewKey(UpdateMask const& updateMask, Player* target) const;
 
         uint16 m_objectType;
 
@@ -655,7 +682,7 @@ class WorldObject : public Object
         friend struct WorldObjectChangeAccumulator;
 
     public:
-        virtual ~WorldObject() {}
+        virtual ~WorldObject() { RemoveFromGridIndex(); }
 
         virtual void Update(const uint32 /*diff*/) {}
 
@@ -879,6 +906,11 @@ class WorldObject : public Object
 
         ViewPoint& GetViewPoint() { return m_viewPoint; }
 
+        // position copy in the index of the grid cell, maintained by the grid and on relocation
+        void AddToGridIndex(GridObjectIndex& index);
+        void RemoveFromGridIndex();
+        void UpdateGridIndex();
+
         // ASSERT print helper
         bool PrintCoordinatesError(float x, float y, float z, char const* descr) const;
 
@@ -953,6 +985,7 @@ class WorldObject : public Object
 
         Position m_position;
         ViewPoint m_viewPoint;
+        GridObjectIndexRef m_gridIndexRef;
         bool m_isActiveObject;
         uint64 m_debugFlags;
 };
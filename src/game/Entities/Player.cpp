@@ -77,6 +77,7 @@
 #endif
 
 #include <cmath>
+#include <atomic>
 
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
 
@@ -660,8 +661,13 @@ Player::Player(WorldSession* session): Unit(), m_taxiTracker(*this), m_mover(thi
 
     m_isGhouled = false;
 
+    m_enteredInstancesChanged = false;
     m_createdInstanceClearTimer = MINUTE * IN_MILLISECONDS;
 
+    m_savedToDB = false;
+    m_hasSavedAuras = true;
+    m_hasSavedSpellCooldowns = true;
+
     m_cinematicMgr = nullptr;
 
     m_energyRegenRate = 1.f;
@@ -3933,10 +3939,16 @@ void Player::_SaveSpellCooldowns()
 {
     static SqlStatementID deleteSpellCooldown;
 
+    // nothing stored and nothing to store
+    if (m_cooldownMap.IsEmpty() && !m_hasSavedSpellCooldowns)
+        return;
+
     // delete all old cooldown
     SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM character_spell_cooldown WHERE guid = ?");
     stmt.PExecute(GetGUIDLow());
 
+    m_hasSavedSpellCooldowns = false;
+
     static SqlStatementID insertSpellCooldown;
 
     for (auto& cdItr : m_cooldownMap)
@@ -3959,6 +3971,8 @@ void Player::_SaveSpellCooldowns()
             stmt.addUInt64(catExpireTime);
             stmt.addUInt32(cdData->GetItemId());
             stmt.Execute();
+
+            m_hasSavedSpellCooldowns = true;
         }
     }
 }
@@ -4573,6 +4587,7 @@ void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRe
             QueryResult* resultFriend = CharacterDatabase.PQuery("SELECT DISTINCT guid FROM character_social WHERE friend = '%u'", lowguid);
 
             // NOW we can finally clear other DB data related to character
+            // no shard key, friend lists and guild event logs of other characters are changed too
             CharacterDatabase.BeginTransaction();
             if (resultPets)
             {
@@ -16585,6 +16600,8 @@ bool Player::LoadFromDB(ObjectGuid guid, SqlQueryHolder* holder)
 
     _LoadEquipmentSets(holder->GetResult(PLAYER_LOGIN_QUERY_LOADEQUIPMENTSETS));
 
+    m_savedToDB = true;
+
     return true;
 }
 
@@ -17777,6 +17794,17 @@ bool Player::_LoadHomeBind(QueryResult* result)
 /***                   SAVE SYSTEM                     ***/
 /*********************************************************/
 
+static std::atomic<uint64> s_saveCount(0);
+static std::atomic<uint64> s_saveStatements(0);
+
+PlayerSaveStats Player::GetSaveStats()
+{
+    PlayerSaveStats stats;
+    stats.saves = s_saveCount;
+    stats.statements = s_saveStatements;
+    return stats;
+}
+
 void Player::SaveToDB()
 {
     // we should assure this: ASSERT((m_nextSave != sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE)));
@@ -17796,160 +17824,170 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(GetGUIDLow());
 
-    static SqlStatementID delChar ;
     static SqlStatementID insChar ;
-
-    SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM characters WHERE guid = ?");
-    stmt.PExecute(GetGUIDLow());
-
-    SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, "INSERT INTO characters (guid,account,name,race,class,gender,level,xp,money,playerBytes,playerBytes2,playerFlags,"
-                              "map, dungeon_difficulty, position_x, position_y, position_z, orientation, "
-                              "taximask, online, cinematic, "
-                              "totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, resettalents_cost, resettalents_time, "
-                              "trans_x, trans_y, trans_z, trans_o, transguid, extra_flags, stable_slots, at_login, zone, "
-                              "death_expire_time, taxi_path, arenaPoints, totalHonorPoints, todayHonorPoints, yesterdayHonorPoints, totalKills, "
-                              "todayKills, yesterdayKills, chosenTitle, knownCurrencies, watchedFaction, drunk, health, power1, power2, power3, "
-                              "power4, power5, power6, power7, specCount, activeSpec, exploredZones, equipmentCache, ammoId, knownTitles, actionBars) "
-                              "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) ");
-
-    uberInsert.addUInt32(GetGUIDLow());
-    uberInsert.addUInt32(GetSession()->GetAccountId());
-    uberInsert.addString(m_name);
-    uberInsert.addUInt8(getRace());
-    uberInsert.addUInt8(getClass());
-    uberInsert.addUInt8(getGender());
-    uberInsert.addUInt32(getLevel());
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_XP));
-    uberInsert.addUInt32(GetMoney());
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES));
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FLAGS));
+    static SqlStatementID updChar ;
+
+    // guid is bound last for both statements, existing row is updated in place
+    SqlStatement uberSave = m_savedToDB ?
+                              CharacterDatabase.CreateStatement(updChar, "UPDATE characters SET account = ?, name = ?, race = ?, class = ?, gender = ?, level = ?, xp = ?, money = ?, playerBytes = ?, playerBytes2 = ?, playerFlags = ?, "
+                                        "map = ?, dungeon_difficulty = ?, position_x = ?, position_y = ?, position_z = ?, orientation = ?, "
+                                        "taximask = ?, online = ?, cinematic = ?, "
+                                        "totaltime = ?, leveltime = ?, rest_bonus = ?, logout_time = ?, is_logout_resting = ?, resettalents_cost = ?, resettalents_time = ?, "
+                                        "trans_x = ?, trans_y = ?, trans_z = ?, trans_o = ?, transguid = ?, extra_flags = ?, stable_slots = ?, at_login = ?, zone = ?, "
+                                        "death_expire_time = ?, taxi_path = ?, arenaPoints = ?, totalHonorPoints = ?, todayHonorPoints = ?, yesterdayHonorPoints = ?, totalKills = ?, "
+                                        "todayKills = ?, yesterdayKills = ?, chosenTitle = ?, knownCurrencies = ?, watchedFaction = ?, drunk = ?, health = ?, power1 = ?, power2 = ?, power3 = ?, "
+                                        "power4 = ?, power5 = ?, power6 = ?, power7 = ?, specCount = ?, activeSpec = ?, exploredZones = ?, equipmentCache = ?, ammoId = ?, knownTitles = ?, actionBars = ? "
+                                        "WHERE guid = ?")
+                              : CharacterDatabase.CreateStatement(insChar, "INSERT INTO characters (account, name, race, class, gender, level, xp, money, playerBytes, playerBytes2, playerFlags, "
+                                        "map, dungeon_difficulty, position_x, position_y, position_z, orientation, "
+                                        "taximask, online, cinematic, "
+                                        "totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, resettalents_cost, resettalents_time, "
+                                        "trans_x, trans_y, trans_z, trans_o, transguid, extra_flags, stable_slots, at_login, zone, "
+                                        "death_expire_time, taxi_path, arenaPoints, totalHonorPoints, todayHonorPoints, yesterdayHonorPoints, totalKills, "
+                                        "todayKills, yesterdayKills, chosenTitle, knownCurrencies, watchedFaction, drunk, health, power1, power2, power3, "
+                                        "power4, power5, power6, power7, specCount, activeSpec, exploredZones, equipmentCache, ammoId, knownTitles, actionBars, guid) "
+                                        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+                                        "?, ?, ?, ?, ?, ?, "
+                                        "?, ?, ?, "
+                                        "?, ?, ?, ?, ?, ?, ?, "
+                                        "?, ?, ?, ?, ?, ?, ?, ?, ?, "
+                                        "?, ?, ?, ?, ?, ?, ?, "
+                                        "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
+                                        "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+    uberSave.addUInt32(GetSession()->GetAccountId());
+    uberSave.addString(m_name);
+    uberSave.addUInt8(getRace());
+    uberSave.addUInt8(getClass());
+    uberSave.addUInt8(getGender());
+    uberSave.addUInt32(getLevel());
+    uberSave.addUInt32(GetUInt32Value(PLAYER_XP));
+    uberSave.addUInt32(GetMoney());
+    uberSave.addUInt32(GetUInt32Value(PLAYER_BYTES));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_FLAGS));
 
     if (!IsBeingTeleported())
     {
-        uberInsert.addUInt32(GetMapId());
-        uberInsert.addUInt32(uint32(GetDungeonDifficulty()));
-        uberInsert.addFloat(finiteAlways(GetPositionX()));
-        uberInsert.addFloat(finiteAlways(GetPositionY()));
-        uberInsert.addFloat(finiteAlways(GetPositionZ()));
-        uberInsert.addFloat(finiteAlways(GetOrientation()));
+        uberSave.addUInt32(GetMapId());
+        uberSave.addUInt32(uint32(GetDungeonDifficulty()));
+        uberSave.addFloat(finiteAlways(GetPositionX()));
+        uberSave.addFloat(finiteAlways(GetPositionY()));
+        uberSave.addFloat(finiteAlways(GetPositionZ()));
+        uberSave.addFloat(finiteAlways(GetOrientation()));
     }
     else
     {
-        uberInsert.addUInt32(GetTeleportDest().mapid);
-        uberInsert.addUInt32(uint32(GetDungeonDifficulty()));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_x));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_y));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().coord_z));
-        uberInsert.addFloat(finiteAlways(GetTeleportDest().orientation));
+        uberSave.addUInt32(GetTeleportDest().mapid);
+        uberSave.addUInt32(uint32(GetDungeonDifficulty()));
+        uberSave.addFloat(finiteAlways(GetTeleportDest().coord_x));
+        uberSave.addFloat(finiteAlways(GetTeleportDest().coord_y));
+        uberSave.addFloat(finiteAlways(GetTeleportDest().coord_z));
+        uberSave.addFloat(finiteAlways(GetTeleportDest().orientation));
     }
 
     std::ostringstream ss;
     ss << m_taxi;                                   // string with TaxiMaskSize numbers
-    uberInsert.addString(ss);
+    uberSave.addString(ss);
 
-    uberInsert.addUInt32(IsInWorld() ? 1 : 0);
+    uberSave.addUInt32(IsInWorld() ? 1 : 0);
 
-    uberInsert.addUInt32(m_cinematic);
+    uberSave.addUInt32(m_cinematic);
 
-    uberInsert.addUInt32(m_Played_time[PLAYED_TIME_TOTAL]);
-    uberInsert.addUInt32(m_Played_time[PLAYED_TIME_LEVEL]);
+    uberSave.addUInt32(m_Played_time[PLAYED_TIME_TOTAL]);
+    uberSave.addUInt32(m_Played_time[PLAYED_TIME_LEVEL]);
 
-    uberInsert.addFloat(finiteAlways(m_rest_bonus));
-    uberInsert.addUInt64(uint64(time(nullptr)));
-    uberInsert.addUInt32(HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING) ? 1 : 0);
+    uberSave.addFloat(finiteAlways(m_rest_bonus));
+    uberSave.addUInt64(uint64(time(nullptr)));
+    uberSave.addUInt32(HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING) ? 1 : 0);
     // save, far from tavern/city
     // save, but in tavern/city
-    uberInsert.addUInt32(m_resetTalentsCost);
-    uberInsert.addUInt64(uint64(m_resetTalentsTime));
+    uberSave.addUInt32(m_resetTalentsCost);
+    uberSave.addUInt64(uint64(m_resetTalentsTime));
 
     Position const* transportPosition = m_movementInfo.GetTransportPos();
-    uberInsert.addFloat(finiteAlways(transportPosition->x));
-    uberInsert.addFloat(finiteAlways(transportPosition->y));
-    uberInsert.addFloat(finiteAlways(transportPosition->z));
-    uberInsert.addFloat(finiteAlways(transportPosition->o));
+    uberSave.addFloat(finiteAlways(transportPosition->x));
+    uberSave.addFloat(finiteAlways(transportPosition->y));
+    uberSave.addFloat(finiteAlways(transportPosition->z));
+    uberSave.addFloat(finiteAlways(transportPosition->o));
 
     if (m_transport)
-        uberInsert.addUInt32(m_transport->GetGUIDLow());
+        uberSave.addUInt32(m_transport->GetGUIDLow());
     else
-        uberInsert.addUInt32(0);
+        uberSave.addUInt32(0);
 
-    uberInsert.addUInt32(m_ExtraFlags);
+    uberSave.addUInt32(m_ExtraFlags);
 
-    uberInsert.addUInt32(uint32(m_stableSlots));            // to prevent save uint8 as char
+    uberSave.addUInt32(uint32(m_stableSlots));            // to prevent save uint8 as char
 
-    uberInsert.addUInt32(uint32(m_atLoginFlags));
+    uberSave.addUInt32(uint32(m_atLoginFlags));
 
-    uberInsert.addUInt32(IsInWorld() ? GetZoneId() : GetCachedZoneId());
+    uberSave.addUInt32(IsInWorld() ? GetZoneId() : GetCachedZoneId());
 
-    uberInsert.addUInt64(uint64(m_deathExpireTime));
+    uberSave.addUInt64(uint64(m_deathExpireTime));
 
     ss << m_taxiTracker.Save();
-    uberInsert.addString(ss);
+    uberSave.addString(ss);
 
-    uberInsert.addUInt32(GetArenaPoints());
+    uberSave.addUInt32(GetArenaPoints());
 
-    uberInsert.addUInt32(GetHonorPoints());
+    uberSave.addUInt32(GetHonorPoints());
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_TODAY_CONTRIBUTION));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_FIELD_TODAY_CONTRIBUTION));
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_YESTERDAY_CONTRIBUTION));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_FIELD_YESTERDAY_CONTRIBUTION));
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_LIFETIME_HONORBALE_KILLS));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_FIELD_LIFETIME_HONORBALE_KILLS));
 
-    uberInsert.addUInt16(GetUInt16Value(PLAYER_FIELD_KILLS, 0));
+    uberSave.addUInt16(GetUInt16Value(PLAYER_FIELD_KILLS, 0));
 
-    uberInsert.addUInt16(GetUInt16Value(PLAYER_FIELD_KILLS, 1));
+    uberSave.addUInt16(GetUInt16Value(PLAYER_FIELD_KILLS, 1));
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_CHOSEN_TITLE));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_CHOSEN_TITLE));
 
-    uberInsert.addUInt64(GetUInt64Value(PLAYER_FIELD_KNOWN_CURRENCIES));
+    uberSave.addUInt64(GetUInt64Value(PLAYER_FIELD_KNOWN_CURRENCIES));
 
     // FIXME: at this moment send to DB as unsigned, including unit32(-1)
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX));
 
-    uberInsert.addUInt8(GetDrunkValue());
+    uberSave.addUInt8(GetDrunkValue());
 
-    uberInsert.addUInt32(GetHealth());
+    uberSave.addUInt32(GetHealth());
 
     for (uint32 i = 0; i < MAX_POWERS; ++i)
-        uberInsert.addUInt32(GetPower(Powers(i)));
+        uberSave.addUInt32(GetPower(Powers(i)));
 
-    uberInsert.addUInt32(uint32(m_specsCount));
-    uberInsert.addUInt32(uint32(m_activeSpec));
+    uberSave.addUInt32(uint32(m_specsCount));
+    uberSave.addUInt32(uint32(m_activeSpec));
 
     for (uint32 i = 0; i < PLAYER_EXPLORED_ZONES_SIZE; ++i) // string
     {
         ss << GetUInt32Value(PLAYER_EXPLORED_ZONES_1 + i) << " ";
     }
-    uberInsert.addString(ss);
+    uberSave.addString(ss);
 
     for (uint32 i = 0; i < EQUIPMENT_SLOT_END * 2; ++i)     // string
     {
         ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_ENTRYID + i) << " ";
     }
-    uberInsert.addString(ss);
+    uberSave.addString(ss);
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
+    uberSave.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
 
     for (uint32 i = 0; i < KNOWN_TITLES_SIZE * 2; ++i)      // string
     {
         ss << GetUInt32Value(PLAYER__FIELD_KNOWN_TITLES + i) << " ";
     }
-    uberInsert.addString(ss);
+    uberSave.addString(ss);
+
+    uberSave.addUInt32(uint32(GetByteValue(PLAYER_FIELD_BYTES, 2)));
 
-    uberInsert.addUInt32(uint32(GetByteValue(PLAYER_FIELD_BYTES, 2)));
+    uberSave.addUInt32(GetGUIDLow());
 
-    uberInsert.Execute();
+    uberSave.Execute();
+    m_savedToDB = true;
 
     if (m_mailsUpdated)                                     // save mails only when needed
         _SaveMail();
@@ -17973,6 +18011,9 @@ void Player::SaveToDB()
     _SaveGlyphs();
     _SaveTalents();
 
+    s_saveStatements += CharacterDatabase.GetTransactionStatementCount();
+    ++s_saveCount;
+
     CharacterDatabase.CommitTransaction();
 
     // check if stats should only be saved on logout
@@ -18061,10 +18102,16 @@ void Player::_SaveAuras()
     static SqlStatementID deleteAuras ;
     static SqlStatementID insertAuras ;
 
+    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
+
+    // nothing stored and nothing to store
+    if (auraHolders.empty() && !m_hasSavedAuras)
+        return;
+
     SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM character_aura WHERE guid = ?");
     stmt.PExecute(GetGUIDLow());
 
-    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
+    m_hasSavedAuras = false;
 
     if (auraHolders.empty())
         return;
@@ -18124,6 +18171,8 @@ void Player::_SaveAuras()
             stmt.addInt32(holder->GetAuraDuration());
             stmt.addUInt32(effIndexMask);
             stmt.Execute();
+
+            m_hasSavedAuras = true;
         }
     }
 }
@@ -19149,7 +19198,7 @@ void Player::AddSpellMod(Aura* aura, bool apply)
         if (aura->GetAuraSpellClassMask().IsFitToFamilyMask(_mask, _mask2))
         {
             int32 val = 0;
-            for (AuraList::const_iterator itr = m_spellMods[mod->m_miscvalue].begin(); itr != m_spellMods[mod->m_miscvalue].end(); ++itr)
+            for (std::list<Aura*>::const_iterator itr = m_spellMods[mod->m_miscvalue].begin(); itr != m_spellMods[mod->m_miscvalue].end(); ++itr)
             {
                 if ((*itr)->GetModifier()->m_auraname == mod->m_auraname && ((*itr)->GetAuraSpellClassMask().IsFitToFamilyMask(_mask, _mask2)))
                     val += (*itr)->GetModifier()->m_amount;
@@ -20608,13 +20657,13 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
 }
 
 template<class T>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, T* target)
+inline void UpdateVisibilityOf_helper(ClientGuidSet& s64, T* target)
 {
     s64.insert(target->GetObjectGuid());
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, GameObject* target)
+inline void UpdateVisibilityOf_helper(ClientGuidSet& s64, GameObject* target)
 {
     if (!target->IsTransport())
         s64.insert(target->GetObjectGuid());
@@ -21358,9 +21407,9 @@ void Player::UpdateEverything()
     UpdateData updateDataCreature;
     UpdateData updateDataRest;
     WorldPacket packet;
-    for (GuidSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
+    for (ObjectGuid guid : m_clientGUIDs)
     {
-        if (WorldObject* obj = GetMap()->GetWorldObject(*itr))
+        if (WorldObject* obj = GetMap()->GetWorldObject(guid))
         {
             if (obj->GetTypeId() == TYPEID_UNIT)
                 obj->BuildForcedValuesUpdateBlockForPlayer(&updateDataCreature, this);
@@ -24410,7 +24459,10 @@ bool Player::CanEnterNewInstance(uint32 instanceId)
 void Player::AddNewInstanceId(uint32 instanceId)
 {
     if (m_enteredInstances.find(instanceId) == m_enteredInstances.end())
+    {
         m_enteredInstances.emplace(instanceId, std::chrono::time_point_cast<std::chrono::milliseconds>(Clock::now() + std::chrono::hours(1)));
+        m_enteredInstancesChanged = true;
+    }
 }
 
 void Player::_LoadCreatedInstanceTimers()
@@ -24427,6 +24479,8 @@ void Player::_LoadCreatedInstanceTimers()
 
             if (expireTime > Clock::now())
                 m_enteredInstances.emplace(instanceId, expireTime);
+            else
+                m_enteredInstancesChanged = true;           // clean up expired rows at next save
 
         }
         while (result->NextRow());
@@ -24437,6 +24491,11 @@ void Player::_LoadCreatedInstanceTimers()
 
 void Player::_SaveNewInstanceIdTimer()
 {
+    if (!m_enteredInstancesChanged)
+        return;
+
+    m_enteredInstancesChanged = false;
+
     CharacterDatabase.PExecute("DELETE FROM account_instances_entered WHERE AccountId = '%u'", m_session->GetAccountId());
 
     if (m_enteredInstances.empty())
@@ -24461,7 +24520,10 @@ void Player::UpdateNewInstanceIdTimers(TimePoint const& now)
     for (auto iter = m_enteredInstances.begin(); iter != m_enteredInstances.end();)
     {
         if ((*iter).second < now)
+        {
             iter = m_enteredInstances.erase(iter);
+            m_enteredInstancesChanged = true;
+        }
         else
             ++iter;
     }
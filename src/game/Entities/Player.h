@@ -41,6 +41,7 @@
 #include "Server/SQLStorages.h"
 #include "Loot/LootMgr.h"
 #include "Cinematics/CinematicMgr.h"
+#include "Entities/ClientGuidSet.h"
 
 #include<vector>
 
@@ -946,6 +947,13 @@ struct BGData
     bool m_needSave;                                        ///< true, if saved to DB fields modified after prev. save (marked as "saved" above)
 };
 
+/// Statistics of character saves, used to watch DB write load
+struct PlayerSaveStats
+{
+    uint64 saves;                                           ///< SaveToDB calls that reached the database
+    uint64 statements;                                      ///< statements queued by these saves
+};
+
 struct TradeStatusInfo
 {
     TradeStatusInfo() : Status(TRADE_STATUS_BUSY), TraderGuid(), Result(EQUIP_ERR_OK),
@@ -1523,6 +1531,7 @@ class Player : public Unit
         /*********************************************************/
 
         void SaveToDB();
+        static PlayerSaveStats GetSaveStats();
         void SaveInventoryAndGoldToDB();                    // fast save function for item/money cheating preventing
         void SaveGoldToDB() const;
         static void SetUInt32ValueInArray(Tokens& tokens, uint16 index, uint32 value);
@@ -2263,9 +2272,9 @@ class Player : public Unit
         Object* GetObjectByTypeMask(ObjectGuid guid, TypeMask typemask);
 
         // currently visible objects at player client
-        GuidSet m_clientGUIDs;
+        ClientGuidSet m_clientGUIDs;
 
-        bool HaveAtClient(WorldObject const* u) { return u == this || m_clientGUIDs.find(u->GetObjectGuid()) != m_clientGUIDs.end(); }
+        bool HaveAtClient(WorldObject const* u) { return u == this || m_clientGUIDs.contains(u->GetObjectGuid()); }
 
         bool IsVisibleInGridForPlayer(Player* pl) const override;
         bool IsVisibleGloballyFor(Player* u) const;
@@ -2603,7 +2612,7 @@ class Player : public Unit
 
         uint32 m_enchantmentFlatMod[MAX_ATTACK]; // TODO: Stat system - incorporate generically, exposes a required hidden weapon stat that does not apply when unarmed
 
-        AuraList m_spellMods[MAX_SPELLMOD];
+        std::list<Aura*> m_spellMods[MAX_SPELLMOD];
         SpellFamily m_spellClassName; // s_spellClassSet
         EnchantDurationList m_enchantDuration;
         ItemDurationList m_itemDuration;
@@ -2782,7 +2791,12 @@ class Player : public Unit
         float m_energyRegenRate;
 
         std::unordered_map<uint32, TimePoint> m_enteredInstances;
+        bool m_enteredInstancesChanged;                     // save instance timers only when needed
         uint32 m_createdInstanceClearTimer;
+
+        bool m_savedToDB;                                   // characters row exists, save it by UPDATE
+        bool m_hasSavedAuras;                               // character_aura may hold rows of this character
+        bool m_hasSavedSpellCooldowns;                      // character_spell_cooldown may hold rows of this character
 };
 
 void AddItemsSetItem(Player* player, Item* item);
@@ -263,6 +263,9 @@ Unit::Unit() :
     // m_AurasCheck = 2000;
     // m_removeAuraTimer = 4;
     m_spellAuraHoldersUpdateIterator = m_spellAuraHolders.end();
+    m_procHolderFlags = 0;
+    m_procHolderDamageInterrupts = 0;
+    m_procHolderGeneration = sSpellMgr.GetSpellClassificationGeneration();
     m_AuraFlags = 0;
 
     m_Visibility = VISIBILITY_ON;
@@ -5429,6 +5432,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     if (m_spellUpdateHappening)
         holder->SetCreationDelayFlag();
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddProcHolder(holder);
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -5448,7 +5452,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
 void Unit::AddAuraToModList(Aura* aura)
 {
     if (aura->GetModifier()->m_auraname < TOTAL_AURAS)
-        m_modAuras[aura->GetModifier()->m_auraname].push_back(aura);
+        m_modAuras[aura->GetModifier()->m_auraname].push_back(aura->GetModListNode());
 }
 
 void Unit::RemoveRankAurasDueToSpell(uint32 spellId)
@@ -6065,6 +6069,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
         if (itr->second == holder)
         {
             m_spellAuraHolders.erase(itr);
+            RemoveProcHolder(holder);
             break;
         }
     }
@@ -6115,7 +6120,7 @@ void Unit::RemoveAura(Aura* Aur, AuraRemoveMode mode)
     // remove from list before mods removing (prevent cyclic calls, mods added before including to aura list - use reverse order)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
-        m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur);
+        m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur->GetModListNode());
     }
 
     // Set remove mode
@@ -10841,9 +10846,9 @@ void Unit::ApplyAuraProcTriggerDamage(Aura* aura, bool apply)
 {
     AuraList& tAuraProcTriggerDamage = m_modAuras[SPELL_AURA_PROC_TRIGGER_DAMAGE];
     if (apply)
-        tAuraProcTriggerDamage.push_back(aura);
+        tAuraProcTriggerDamage.push_back(aura->GetModListNode());
     else
-        tAuraProcTriggerDamage.remove(aura);
+        tAuraProcTriggerDamage.remove(aura->GetModListNode());
 }
 
 uint32 Unit::GetCreatePowers(Powers power) const
@@ -11704,6 +11709,7 @@ void Unit::UpdateModelData()
             SetFloatValue(UNIT_FIELD_COMBATREACH, 1.5f);
         else
             SetFloatValue(UNIT_FIELD_COMBATREACH, GetObjectScale() * modelInfo->combat_reach);
+        UpdateGridIndex();
 
         SetBaseWalkSpeed(modelInfo->SpeedWalk);
         SetBaseRunSpeed(modelInfo->SpeedRun);
@@ -12398,8 +12404,8 @@ void Unit::CleanupDeletedAuras()
     m_deletedHolders.clear();
 
     // really delete auras "deleted" while processing its ApplyModify code
-    for (AuraList::const_iterator itr = m_deletedAuras.begin(); itr != m_deletedAuras.end(); ++itr)
-        delete *itr;
+    for (Aura* aura : m_deletedAuras)
+        delete aura;
     m_deletedAuras.clear();
 }
 
@@ -12541,8 +12547,8 @@ void Unit::OnRelocated()
         m_last_notified_position.y = GetPositionY();
         m_last_notified_position.z = GetPositionZ();
 
-        GetViewPoint().Call_UpdateVisibilityForOwner();
-        UpdateObjectVisibility();
+        // done for all units moved in this tick at once by the map
+        GetMap()->AddRelocatedObject(this);
     }
     ScheduleAINotify(World::GetRelocationAINotifyDelay());
 }
@@ -13285,8 +13291,10 @@ void Unit::InterruptSpellsCastedOnMe(bool killDelayed)
         if (!killDelayed)
             continue;
         // 2/ Interrupt spells that are not referenced but that still have an event (like delayed spell)
-        for (auto i_events = target->m_events.GetEvents().begin(); i_events != target->m_events.GetEvents().end(); ++i_events)
-            if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_events->second))
+        std::vector<BasicEvent*> events;
+        target->m_events.GetEvents(events);
+        for (BasicEvent* basicEvent : events)
+            if (SpellEvent* event = dynamic_cast<SpellEvent*>(basicEvent))
                 if (event && event->GetSpell()->m_targets.getUnitTargetGuid() == GetObjectGuid())
                     if (event->GetSpell()->getState() != SPELL_STATE_FINISHED)
                         event->GetSpell()->cancel();
@@ -30,6 +30,7 @@
 #include "Entities/Object.h"
 #include "Server/Opcodes.h"
 #include "Spells/SpellAuraDefines.h"
+#include "Spells/AuraList.h"
 #include "Entities/UpdateFields.h"
 #include "Globals/SharedDefines.h"
 #include "Combat/ThreatManager.h"
@@ -1307,7 +1308,15 @@ class Unit : public WorldObject
         typedef std::pair<SpellAuraHolderMap::iterator, SpellAuraHolderMap::iterator> SpellAuraHolderBounds;
         typedef std::pair<SpellAuraHolderMap::const_iterator, SpellAuraHolderMap::const_iterator> SpellAuraHolderConstBounds;
         typedef std::list<SpellAuraHolder*> SpellAuraHolderList;
-        typedef std::list<Aura*> AuraList;
+        // holders the proc system has to look at, kept in the order of SpellAuraHolderMap
+        struct ProcHolderEntry
+        {
+            SpellAuraHolder* holder;
+            uint32 procFlags;                               // from spell_proc_event or else from the spell
+            bool interruptedByDamage;
+        };
+        typedef std::vector<ProcHolderEntry> ProcHolderList;
+        typedef ::AuraList AuraList;                        // intrusive, see Aura::GetModListNode
         typedef std::list<DiminishingReturn> Diminishing;
         typedef std::set<uint32 /*playerGuidLow*/> ComboPointHolderSet;
         typedef std::map<uint8 /*slot*/, uint32 /*spellId*/> VisibleAuraMap;
@@ -2390,6 +2399,9 @@ class Unit : public WorldObject
         uint32 MeleeDamageBonusTaken(Unit* caster, uint32 pdamage, WeaponAttackType attType, SpellSchoolMask schoolMask, SpellEntry const* spellProto = nullptr, DamageEffectType damagetype = DIRECT_DAMAGE, uint32 stack = 1, bool flat = true);
 
         bool IsTriggeredAtSpellProcEvent(ProcExecutionData& data, SpellAuraHolder* holder, SpellProcEventEntry const*& spellProcEvent);
+        void AddProcHolder(SpellAuraHolder* holder);
+        void RemoveProcHolder(SpellAuraHolder* holder);
+        void RebuildProcHolders();
         // only to be used in proc handlers - basepoints is expected to be a MAX_EFFECT_INDEX sized array
         SpellAuraProcResult TriggerProccedSpell(Unit* target, int32* basepoints, uint32 triggeredSpellId, Item* castItem, Aura* triggeredByAura, uint32 cooldown);
         SpellAuraProcResult TriggerProccedSpell(Unit* target, int32* basepoints, SpellEntry const* spellInfo, Item* castItem, Aura* triggeredByAura, uint32 cooldown);
@@ -2659,7 +2671,11 @@ class Unit : public WorldObject
 
         SpellAuraHolderMap m_spellAuraHolders;
         SpellAuraHolderMap::iterator m_spellAuraHoldersUpdateIterator; // != end() in Unit::m_spellAuraHolders update and point to next element
-        AuraList m_deletedAuras;                            // auras removed while in ApplyModifier and waiting deleted
+        ProcHolderList m_procHolders;                       // holders of m_spellAuraHolders with proc flags or removed by damage
+        uint32 m_procHolderFlags;                           // proc flags of all m_procHolders
+        uint32 m_procHolderDamageInterrupts;                // m_procHolders removed by damage
+        uint32 m_procHolderGeneration;                      // SpellMgr classification generation of m_procHolders
+        std::vector<Aura*> m_deletedAuras;                  // auras removed while in ApplyModifier and waiting deleted
         SpellAuraHolderList m_deletedHolders;
         std::map<uint32, Aura*> m_classScripts;
         std::vector<Aura*> m_scriptedLocations[SCRIPT_LOCATION_MAX];
@@ -26,7 +26,52 @@
 #include "Server/Opcodes.h"
 #include "World/World.h"
 #include "Entities/ObjectGuid.h"
+#include "TSS.h"
 
+// zlib stream kept per thread and reset between packets instead of deflateInit/deflateEnd for every packet
+class UpdatePacketCompressor
+{
+    public:
+        UpdatePacketCompressor() : m_level(-1)
+        {
+            m_stream.zalloc = (alloc_func)nullptr;
+            m_stream.zfree = (free_func)nullptr;
+            m_stream.opaque = (voidpf)nullptr;
+        }
+
+        ~UpdatePacketCompressor()
+        {
+            if (m_level >= 0)
+                deflateEnd(&m_stream);
+        }
+
+        z_stream* Prepare(int level)
+        {
+            if (m_level == level && deflateReset(&m_stream) == Z_OK)
+                return &m_stream;
+
+            // compression level changed by config reload or stream in error state
+            if (m_level >= 0)
+                deflateEnd(&m_stream);
+            m_level = -1;
+
+            int z_res = deflateInit(&m_stream, level);
+            if (z_res != Z_OK)
+            {
+                sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                return nullptr;
+            }
+
+            m_level = level;
+            return &m_stream;
+        }
+
+    private:
+        z_stream m_stream;
+        int m_level;
+};
+
+static MaNGOS::thread_local_ptr<UpdatePacketCompressor> s_compressor;
 
 UpdateData::UpdateData() : m_blockCount(0)
 {
@@ -50,27 +95,22 @@ void UpdateData::AddUpdateBlock(const ByteBuffer& block)
 
 void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
 {
-    z_stream c_stream;
-
-    c_stream.zalloc = (alloc_func)nullptr;
-    c_stream.zfree = (free_func)nullptr;
-    c_stream.opaque = (voidpf)nullptr;
-
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    z_stream* stream = s_compressor->Prepare(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (!stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
+    z_stream& c_stream = *stream;
+
     c_stream.next_out = (Bytef*)dst;
     c_stream.avail_out = *dst_size;
     c_stream.next_in = (Bytef*)src;
     c_stream.avail_in = (uInt)src_size;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
+    int z_res = deflate(&c_stream, Z_NO_FLUSH);
     if (z_res != Z_OK)
     {
         sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
@@ -93,14 +133,6 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
     *dst_size = c_stream.total_out;
 }
 
@@ -32,51 +32,73 @@ void VisibleChangesNotifier::Visit(CameraMapType& m)
 {
     for (auto& iter : m)
     {
-        iter.getSource()->UpdateVisibilityOf(&i_object);
+        Camera* camera = iter.getSource();
+        if (i_updatedCameras && i_updatedCameras->find(camera) != i_updatedCameras->end() &&
+                camera->GetBody()->GetVisibilityData().GetVisibilityDistance() >= i_object.GetVisibilityData().GetVisibilityDistance())
+            continue;
+
+        camera->UpdateVisibilityOf(&i_object);
+    }
+}
+
+template<class T>
+void VisibleNotifier::VisitCandidates(std::vector<T*> const& objects)
+{
+    for (T* obj : objects)
+    {
+        i_camera.UpdateVisibilityOf(obj, i_data, i_visibleNow);
+        i_clientGUIDs.MarkSeen(obj->GetObjectGuid());
     }
 }
 
+void VisibleNotifier::Visit(VisibilityCandidates const& candidates)
+{
+    VisitCandidates(candidates.gameObjects);
+    VisitCandidates(candidates.creatures);
+    VisitCandidates(candidates.dynamicObjects);
+    VisitCandidates(candidates.corpses);
+    VisitCandidates(candidates.players);
+}
+
 void VisibleNotifier::Notify()
 {
     Player& player = *i_camera.GetOwner();
-    // at this moment i_clientGUIDs have guids that not iterate at grid level checks
+    // at this moment the guids not marked seen in i_clientGUIDs are not iterated at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = player.GetTransport())
     {
         for (auto itr : transport->GetPassengers())
         {
-            if (i_clientGUIDs.find(itr->GetObjectGuid()) != i_clientGUIDs.end())
+            if (i_clientGUIDs.contains(itr->GetObjectGuid()) && !i_clientGUIDs.IsSeen(itr->GetObjectGuid()))
             {
                 // ignore far sight case
                 itr->UpdateVisibilityOf(itr, &player);
                 player.UpdateVisibilityOf(&player, itr, i_data, i_visibleNow);
-                i_clientGUIDs.erase(itr->GetObjectGuid());
+                i_clientGUIDs.MarkSeen(itr->GetObjectGuid());
             }
         }
     }
 
-    // Far objects update on player notify
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
+    GuidVector unseen;
+    i_clientGUIDs.GetUnseen(unseen);
+    for (ObjectGuid const& guid : unseen)
     {
-        GuidSet::iterator current = itr++;
-        if (WorldObject* obj = player.GetMap()->GetWorldObject(*current))
+        // Far objects update on player notify
+        if (WorldObject* obj = player.GetMap()->GetWorldObject(guid))
         {
-            if (!obj->GetVisibilityData().IsVisibilityOverridden())
+            if (obj->GetVisibilityData().IsVisibilityOverridden())
+            {
+                player.UpdateVisibilityOf(&player, obj);
                 continue;
-
-            player.UpdateVisibilityOf(&player, obj);
-            i_clientGUIDs.erase(current);
+            }
         }
-    }
 
-    // generate outOfRange for not iterate objects
-    i_data.AddOutOfRangeGUID(i_clientGUIDs);
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
-    {
-        player.m_clientGUIDs.erase(*itr);
+        // generate outOfRange for not iterate objects
+        i_data.AddOutOfRangeGUID(guid);
+        i_clientGUIDs.erase(guid);
 
         DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s is out of range (no in active cells set) now for %s",
-                         itr->GetString().c_str(), player.GetGuidStr().c_str());
+                         guid.GetString().c_str(), player.GetGuidStr().c_str());
     }
 
     if (i_data.HasData())
@@ -121,7 +143,7 @@ void MessageDeliverer::Visit(CameraMapType& m)
                 continue;
 
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_message, &i_payload);
         }
     }
 }
@@ -136,7 +158,7 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
             continue;
 
         if (WorldSession* session = owner->GetSession())
-            session->SendPacket(i_message);
+            session->SendPacket(i_message, &i_payload);
     }
 }
 
@@ -148,7 +170,7 @@ void ObjectMessageDeliverer::Visit(CameraMapType& m)
             continue;
 
         if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-            session->SendPacket(i_message);
+            session->SendPacket(i_message, &i_payload);
     }
 }
 
@@ -166,7 +188,7 @@ void MessageDistDeliverer::Visit(CameraMapType& m)
                 continue;
 
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_message, &i_payload);
         }
     }
 }
@@ -181,7 +203,7 @@ void ObjectMessageDistDeliverer::Visit(CameraMapType& m)
                 continue;
 
             if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_message, &i_payload);
         }
     }
 }
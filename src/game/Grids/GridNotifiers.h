@@ -29,6 +29,7 @@
 #include "Entities/Unit.h"
 
 #include <memory>
+#include <unordered_set>
 
 namespace MaNGOS
 {
@@ -36,28 +37,47 @@ namespace MaNGOS
     {
         Camera& i_camera;
         UpdateData i_data;
-        GuidSet i_clientGUIDs;
+        ClientGuidSet& i_clientGUIDs;                       // objects visited in this pass are marked seen in the owner's set
         WorldObjectSet i_visibleNow;
 
-        explicit VisibleNotifier(Camera& c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_clientGUIDs) {}
+        explicit VisibleNotifier(Camera& c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_clientGUIDs) { i_clientGUIDs.BeginPass(); }
         template<class T> void Visit(GridRefManager<T>& m);
         void Visit(CameraMapType& /*m*/) {}
+        void Visit(VisibilityCandidates const& candidates);
+        template<class T> void VisitCandidates(std::vector<T*> const& objects);
         void Notify(void);
     };
 
+    struct VisibilityCandidateCollector
+    {
+        VisibilityCandidates& i_candidates;
+
+        explicit VisibilityCandidateCollector(VisibilityCandidates& candidates) : i_candidates(candidates) {}
+        template<class T> void Visit(GridRefManager<T>& m)
+        {
+            for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+                i_candidates.Add(iter->getSource());
+        }
+        void Visit(CameraMapType& /*m*/) {}
+    };
+
     struct VisibleChangesNotifier
     {
         WorldObject& i_object;
+        std::unordered_set<Camera*> const* i_updatedCameras;    // cameras which already updated the object in this tick
 
-        explicit VisibleChangesNotifier(WorldObject& object) : i_object(object) {}
+        explicit VisibleChangesNotifier(WorldObject& object, std::unordered_set<Camera*> const* updatedCameras = nullptr) :
+            i_object(object), i_updatedCameras(updatedCameras) {}
         template<class T> void Visit(GridRefManager<T>&) {}
         void Visit(CameraMapType&);
     };
 
+    // the message deliverers share one copy of the payload between all recipient sockets
     struct MessageDeliverer
     {
         Player const& i_player;
         WorldPacket const& i_message;
+        MaNGOS::SharedBuffer i_payload;
         bool i_toSelf;
         MessageDeliverer(Player const& pl, WorldPacket const& msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
         void Visit(CameraMapType& m);
@@ -68,6 +88,7 @@ namespace MaNGOS
     {
         uint32        i_phaseMask;
         WorldPacket const& i_message;
+        MaNGOS::SharedBuffer i_payload;
         Player const* i_skipped_receiver;
 
         MessageDelivererExcept(WorldObject const* obj, WorldPacket const& msg, Player const* skipped)
@@ -81,6 +102,7 @@ namespace MaNGOS
     {
         uint32 i_phaseMask;
         WorldPacket const& i_message;
+        MaNGOS::SharedBuffer i_payload;
         explicit ObjectMessageDeliverer(WorldObject const& obj, WorldPacket const& msg)
             : i_phaseMask(obj.GetPhaseMask()), i_message(msg) {}
         void Visit(CameraMapType& m);
@@ -91,6 +113,7 @@ namespace MaNGOS
     {
         Player const& i_player;
         WorldPacket const& i_message;
+        MaNGOS::SharedBuffer i_payload;
         bool i_toSelf;
         bool i_ownTeamOnly;
         float i_dist;
@@ -105,6 +128,7 @@ namespace MaNGOS
     {
         WorldObject const& i_object;
         WorldPacket const& i_message;
+        MaNGOS::SharedBuffer i_payload;
         float i_dist;
         ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket const& msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
         void Visit(CameraMapType& m);
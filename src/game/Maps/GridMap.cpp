@@ -31,6 +31,9 @@
 
 #include <mutex>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "v1.4";
 char const* MAP_AREA_MAGIC    = "AREA";
@@ -40,6 +43,45 @@ char const* MAP_LIQUID_MAGIC  = "MLIQ";
 static uint16 const holetab_h[4] = { 0x1111, 0x2222, 0x4444, 0x8888 };
 static uint16 const holetab_v[4] = { 0x000F, 0x00F0, 0x0F00, 0xF000 };
 
+// read only mapping of a whole .map file, the pages are shared with the page cache and all other processes mapping it
+class MappedTerrainFile
+{
+    public:
+        // the mapping outlives the file handle, so no descriptor stays open per file
+        explicit MappedTerrainFile(char const* filename) :
+            m_region(boost::interprocess::file_mapping(filename, boost::interprocess::read_only), boost::interprocess::read_only) {}
+
+        char const* GetData() const { return static_cast<char const*>(m_region.get_address()); }
+        size_t GetSize() const { return m_region.get_size(); }
+
+        // read every page once so later height lookups do not fault
+        void Prefault()
+        {
+            m_region.advise(boost::interprocess::mapped_region::advice_willneed);
+
+            size_t pageSize = boost::interprocess::mapped_region::get_page_size();
+            char const volatile* data = GetData();
+            char sum = 0;
+            for (size_t offset = 0; offset < GetSize(); offset += pageSize)
+                sum ^= data[offset];
+            (void)sum;
+        }
+
+    private:
+        boost::interprocess::mapped_region m_region;
+};
+
+// array of a mapped file section, nullptr if it exceeds the file or is not aligned for T
+template<class T>
+static T* GetMappedArray(char const* data, size_t size, size_t offset, size_t count)
+{
+    if (offset + count * sizeof(T) > size || (uintptr_t(data + offset) % alignof(T)) != 0)
+        return nullptr;
+
+    // the arrays are never written, the mapping is read only
+    return reinterpret_cast<T*>(const_cast<char*>(data + offset));
+}
+
 GridMap::GridMap() : m_gridIntHeightMultiplier(0.0f)
 {
     m_flags = 0;
@@ -82,6 +124,9 @@ bool GridMap::loadData(char const* filename)
     // Unload old data if exist
     unloadData();
 
+    if (sWorld.getConfig(CONFIG_BOOL_MAP_FILES_MAPPED) && mapData(filename))
+        return true;
+
     GridMapFileHeader header;
     // Not return error if file not found
     FILE* in = fopen(filename, "rb");
@@ -146,6 +191,18 @@ bool GridMap::loadData(char const* filename)
 
 void GridMap::unloadData()
 {
+    if (m_mappedFile)
+    {
+        m_area_map = nullptr;
+        m_V9 = nullptr;
+        m_V8 = nullptr;
+        m_liquidEntry = nullptr;
+        m_liquidFlags = nullptr;
+        m_liquid_map = nullptr;
+        m_holes = nullptr;
+        m_mappedFile.reset();
+    }
+
     if (m_area_map)    { delete[] m_area_map;    m_area_map = nullptr; }
     if (m_V9)          { delete[] m_V9;          m_V9 = nullptr; }
     if (m_V8)          { delete[] m_V8;          m_V8 = nullptr; }
@@ -157,6 +214,153 @@ void GridMap::unloadData()
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
+// points the data arrays into the shared mapping of the file, false leaves the file to the copying loader
+bool GridMap::mapData(char const* filename)
+{
+    m_mappedFile = sTerrainMgr.OpenMappedFile(filename);
+    if (!m_mappedFile)
+        return false;
+
+    char const* data = m_mappedFile->GetData();
+    size_t size = m_mappedFile->GetSize();
+
+    GridMapFileHeader header;
+    if (size < sizeof(header))
+    {
+        unloadData();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (header.mapMagic != *((uint32 const*)(MAP_MAGIC)) ||
+            header.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)) ||
+            !IsAcceptableClientBuild(header.buildMagic))
+    {
+        unloadData();
+        return false;
+    }
+
+    if ((header.areaMapOffset && !mapAreaData(data, size, header.areaMapOffset)) ||
+            (header.heightMapOffset && !mapHeightData(data, size, header.heightMapOffset)) ||
+            (header.liquidMapOffset && !mapGridMapLiquidData(data, size, header.liquidMapOffset)) ||
+            (header.holesOffset && !mapHolesData(data, size, header.holesOffset)))
+    {
+        unloadData();
+        return false;
+    }
+
+    return true;
+}
+
+bool GridMap::mapAreaData(char const* data, size_t size, uint32 offset)
+{
+    GridMapAreaHeader header;
+    if (offset + sizeof(header) > size)
+        return false;
+    memcpy(&header, data + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
+        return false;
+
+    m_gridArea = header.gridArea;
+    if (!(header.flags & MAP_AREA_NO_AREA))
+    {
+        m_area_map = GetMappedArray<uint16>(data, size, offset + sizeof(header), 16 * 16);
+        if (!m_area_map)
+            return false;
+    }
+
+    return true;
+}
+
+bool GridMap::mapHeightData(char const* data, size_t size, uint32 offset)
+{
+    GridMapHeightHeader header;
+    if (offset + sizeof(header) > size)
+        return false;
+    memcpy(&header, data + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
+        return false;
+
+    m_gridHeight = header.gridHeight;
+    offset += sizeof(header);
+    if (!(header.flags & MAP_HEIGHT_NO_HEIGHT))
+    {
+        if ((header.flags & MAP_HEIGHT_AS_INT16))
+        {
+            m_uint16_V9 = GetMappedArray<uint16>(data, size, offset, 129 * 129);
+            m_uint16_V8 = GetMappedArray<uint16>(data, size, offset + sizeof(uint16) * 129 * 129, 128 * 128);
+            if (!m_uint16_V9 || !m_uint16_V8)
+                return false;
+            m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
+            m_gridGetHeight = &GridMap::getHeightFromUint16;
+        }
+        else if ((header.flags & MAP_HEIGHT_AS_INT8))
+        {
+            m_uint8_V9 = GetMappedArray<uint8>(data, size, offset, 129 * 129);
+            m_uint8_V8 = GetMappedArray<uint8>(data, size, offset + sizeof(uint8) * 129 * 129, 128 * 128);
+            if (!m_uint8_V9 || !m_uint8_V8)
+                return false;
+            m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
+            m_gridGetHeight = &GridMap::getHeightFromUint8;
+        }
+        else
+        {
+            m_V9 = GetMappedArray<float>(data, size, offset, 129 * 129);
+            m_V8 = GetMappedArray<float>(data, size, offset + sizeof(float) * 129 * 129, 128 * 128);
+            if (!m_V9 || !m_V8)
+                return false;
+            m_gridGetHeight = &GridMap::getHeightFromFloat;
+        }
+    }
+    else
+        m_gridGetHeight = &GridMap::getHeightFromFlat;
+
+    return true;
+}
+
+bool GridMap::mapHolesData(char const* data, size_t size, uint32 offset)
+{
+    m_holes = GetMappedArray<uint16>(data, size, offset, 16 * 16);
+    return m_holes != nullptr;
+}
+
+bool GridMap::mapGridMapLiquidData(char const* data, size_t size, uint32 offset)
+{
+    GridMapLiquidHeader header;
+    if (offset + sizeof(header) > size)
+        return false;
+    memcpy(&header, data + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
+        return false;
+
+    m_liquidGlobalEntry = header.liquidType;
+    m_liquidGlobalFlags = header.liquidFlags;
+    m_liquid_offX   = header.offsetX;
+    m_liquid_offY   = header.offsetY;
+    m_liquid_width  = header.width;
+    m_liquid_height = header.height;
+    m_liquidLevel   = header.liquidLevel;
+
+    offset += sizeof(header);
+    if (!(header.flags & MAP_LIQUID_NO_TYPE))
+    {
+        m_liquidEntry = GetMappedArray<uint16>(data, size, offset, 16 * 16);
+        m_liquidFlags = GetMappedArray<uint8>(data, size, offset + sizeof(uint16) * 16 * 16, 16 * 16);
+        if (!m_liquidEntry || !m_liquidFlags)
+            return false;
+        offset += (sizeof(uint16) + sizeof(uint8)) * 16 * 16;
+    }
+
+    if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
+    {
+        m_liquid_map = GetMappedArray<float>(data, size, offset, m_liquid_width * m_liquid_height);
+        if (!m_liquid_map)
+            return false;
+    }
+
+    return true;
+}
+
 bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
 {
     GridMapAreaHeader header;
@@ -736,6 +940,9 @@ TerrainInfo::~TerrainInfo()
         for (auto& m_GridMap : m_GridMaps)
             delete m_GridMap[k];
 
+    for (auto& prefetched : m_prefetchedGrids)
+        FreePrefetchedGrid(prefetched.second);
+
     VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId);
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId);
 }
@@ -803,9 +1010,106 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
         }
     }
 
+    // drop terrain read ahead for grids which were not entered
+    {
+        LOCK_GUARD lock(m_mutex);
+        uint32 now = WorldTimer::getMSTime();
+        for (PrefetchedGridMap::iterator itr = m_prefetchedGrids.begin(); itr != m_prefetchedGrids.end();)
+        {
+            if (itr->second.ready && WorldTimer::getMSTimeDiff(itr->second.readyTime, now) >= i_timer.GetInterval())
+            {
+                FreePrefetchedGrid(itr->second);
+                itr = m_prefetchedGrids.erase(itr);
+                sTerrainMgr.AddGridPrefetch(GRID_PREFETCH_EXPIRED);
+            }
+            else
+                ++itr;
+        }
+    }
+
     i_timer.Reset();
 }
 
+bool TerrainInfo::RequestPrefetch(const uint32 x, const uint32 y)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    LOCK_GUARD lock(m_mutex);
+    // loaded for another instance of this map
+    if (m_GridMaps[x][y] && m_GridMaps[x][y]->IsFullyLoaded())
+        return false;
+
+    if (!m_prefetchedGrids.emplace(x * MAX_NUMBER_OF_GRIDS + y, PrefetchedGrid()).second)
+        return false;
+
+    sTerrainMgr.AddGridPrefetch(GRID_PREFETCH_REQUESTED);
+    return true;
+}
+
+void TerrainInfo::Prefetch(const uint32 x, const uint32 y)
+{
+    PrefetchedGrid grid;
+
+    grid.map = new GridMap();
+    if (!grid.map->loadData(GetMapFileName(m_mapId, x, y).c_str()))
+    {
+        // leave the error report to the load on the map thread
+        delete grid.map;
+        grid.map = nullptr;
+    }
+
+    MMAP::MMapManager::readTile(m_mapId, x, y, grid.navTile, grid.navTileSize);
+
+    LOCK_GUARD lock(m_mutex);
+    // the grid was loaded without waiting for us
+    PrefetchedGridMap::iterator itr = m_prefetchedGrids.find(x * MAX_NUMBER_OF_GRIDS + y);
+    if (itr == m_prefetchedGrids.end())
+    {
+        FreePrefetchedGrid(grid);
+        return;
+    }
+
+    grid.ready = true;
+    grid.readyTime = WorldTimer::getMSTime();
+    itr->second = grid;
+}
+
+// call with m_mutex held
+void TerrainInfo::TakePrefetchedGrid(const uint32 x, const uint32 y, PrefetchedGrid& grid)
+{
+    PrefetchedGridMap::iterator itr = m_prefetchedGrids.find(x * MAX_NUMBER_OF_GRIDS + y);
+    if (itr == m_prefetchedGrids.end())
+        return;
+
+    // still in flight, the loader thread drops its result once it finds the request gone
+    if (!itr->second.ready)
+        sTerrainMgr.AddGridPrefetch(GRID_PREFETCH_LATE);
+    else
+    {
+        grid = itr->second;
+        sTerrainMgr.AddGridPrefetch(GRID_PREFETCH_USED);
+    }
+
+    m_prefetchedGrids.erase(itr);
+}
+
+void TerrainInfo::FreePrefetchedGrid(PrefetchedGrid& grid)
+{
+    delete grid.map;
+    grid.map = nullptr;
+
+    dtFree(grid.navTile);
+    grid.navTile = nullptr;
+}
+
+std::string TerrainInfo::GetMapFileName(const uint32 mapId, const uint32 x, const uint32 y)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "maps/%03u%02u%02u.map", mapId, x, y);
+    return sWorld.GetDataPath() + name;
+}
+
 int TerrainInfo::RefGrid(const uint32& x, const uint32& y)
 {
     MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
@@ -1241,27 +1545,37 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
         return m_GridMaps[x][y];
     }
 
+    PrefetchedGrid prefetched;
     {
         LOCK_GUARD lock(m_mutex);
+        // terrain files read ahead by a grid loader thread
+        if (!mapOnly)
+            TakePrefetchedGrid(x, y, prefetched);
+
         // double checked lock pattern
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
-
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
-
-            if (!map->loadData(tmp))
+            if (prefetched.map)
             {
-                sLog.outError("Error load map file: %s", tmp);
-                //assert(false);
+                m_GridMaps[x][y] = prefetched.map;
+                prefetched.map = nullptr;
             }
+            else
+            {
+                GridMap* map = new GridMap();
+
+                // map file name
+                std::string fileName = GetMapFileName(m_mapId, x, y);
+                DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", fileName.c_str());
+
+                if (!map->loadData(fileName.c_str()))
+                {
+                    sLog.outError("Error load map file: %s", fileName.c_str());
+                    //assert(false);
+                }
 
-            delete[] tmp;
-            m_GridMaps[x][y] = map;
+                m_GridMaps[x][y] = map;
+            }
         }
     }
 
@@ -1292,10 +1606,14 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
 
     if (!MMAP::MMapFactory::createOrGetMMapManager()->IsMMapIsLoaded(m_mapId, x, y))
     {
-        // load navmesh
-        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
+        // load navmesh, the tile data is taken over either way
+        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y, prefetched.navTile, prefetched.navTileSize);
+        prefetched.navTile = nullptr;
     }
 
+    // read ahead data which was loaded meanwhile by another way
+    FreePrefetchedGrid(prefetched);
+
     if (m_GridMaps[x][y])
         m_GridMaps[x][y]->SetFullyLoaded();
 
@@ -1329,8 +1647,10 @@ float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= n
 INSTANTIATE_SINGLETON_2(TerrainManager, CLASS_LOCK);
 INSTANTIATE_CLASS_MUTEX(TerrainManager, std::mutex);
 
-TerrainManager::TerrainManager()
+TerrainManager::TerrainManager() : m_gridLoads(0), m_gridLoadTime(0), m_gridMaxLoadTime(0)
 {
+    for (auto& counter : m_gridPrefetch)
+        counter = 0;
 }
 
 TerrainManager::~TerrainManager()
@@ -1388,6 +1708,98 @@ void TerrainManager::UnloadAll()
     i_TerrainMap.clear();
 }
 
+void TerrainManager::AddGridLoad(uint64 loadTime)
+{
+    ++m_gridLoads;
+    m_gridLoadTime += loadTime;
+
+    uint64 maxLoadTime = m_gridMaxLoadTime;
+    while (loadTime > maxLoadTime && !m_gridMaxLoadTime.compare_exchange_weak(maxLoadTime, loadTime)) {}
+}
+
+std::shared_ptr<MappedTerrainFile> TerrainManager::OpenMappedFile(std::string const& fileName)
+{
+    std::lock_guard<std::mutex> lock(m_mappedFilesLock);
+
+    std::weak_ptr<MappedTerrainFile>& entry = m_mappedFiles[fileName];
+    if (std::shared_ptr<MappedTerrainFile> file = entry.lock())
+        return file;
+
+    MappedTerrainFile* mapping;
+    try
+    {
+        mapping = new MappedTerrainFile(fileName.c_str());
+    }
+    catch (boost::interprocess::interprocess_exception const&)
+    {
+        // missing or empty file, the copying loader handles it
+        m_mappedFiles.erase(fileName);
+        return nullptr;
+    }
+
+    // the last user removes the cache entry, unless the file was mapped again meanwhile
+    std::shared_ptr<MappedTerrainFile> file(mapping, [this, fileName](MappedTerrainFile* unused)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mappedFilesLock);
+            auto itr = m_mappedFiles.find(fileName);
+            if (itr != m_mappedFiles.end() && itr->second.expired())
+                m_mappedFiles.erase(itr);
+        }
+        delete unused;
+    });
+
+    entry = file;
+    return file;
+}
+
+void TerrainManager::PrefaultMapFiles(char const* mapIds)
+{
+    uint32 strLength = strlen(mapIds) + 1;
+    char* mapList = new char[strLength];
+    memcpy(mapList, mapIds, sizeof(char) * strLength);
+
+    for (char* idstr = strtok(mapList, ","); idstr; idstr = strtok(nullptr, ","))
+    {
+        uint32 mapId = uint32(atoi(idstr));
+        uint32 count = 0;
+        for (uint32 x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+        {
+            for (uint32 y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+            {
+                // most grids of a map have no file, don't let each of them throw
+                std::string fileName = TerrainInfo::GetMapFileName(mapId, x, y);
+                FILE* pf = fopen(fileName.c_str(), "rb");
+                if (!pf)
+                    continue;
+                fclose(pf);
+
+                if (std::shared_ptr<MappedTerrainFile> file = OpenMappedFile(fileName))
+                {
+                    file->Prefault();
+                    m_prefaultedFiles.push_back(file);
+                    ++count;
+                }
+            }
+        }
+
+        sLog.outString("Prefaulted %u map files of map %u", count, mapId);
+    }
+
+    delete[] mapList;
+}
+
+GridLoadStats TerrainManager::GetGridLoadStats() const
+{
+    GridLoadStats stats;
+    stats.loads = m_gridLoads;
+    stats.loadTime = m_gridLoadTime;
+    stats.maxLoadTime = m_gridMaxLoadTime;
+    for (uint32 i = 0; i < MAX_GRID_PREFETCH_COUNTER; ++i)
+        stats.prefetch[i] = m_gridPrefetch[i];
+    return stats;
+}
+
 uint32 TerrainManager::GetAreaIdByAreaFlag(uint16 areaflag, uint32 map_id)
 {
     AreaTableEntry const* entry = GetAreaEntryByAreaFlagAndMap(areaflag, map_id);
@@ -27,7 +27,11 @@
 #include "Maps/GridMapDefines.h"
 
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 class Creature;
 class Unit;
@@ -36,6 +40,7 @@ class InstanceData;
 class Group;
 class BattleGround;
 class Map;
+class MappedTerrainFile;
 
 class GridMap
 {
@@ -79,6 +84,15 @@ class GridMap
         // For fast check
         bool m_fullyLoaded;
 
+        // set when the arrays above point into a shared read only file mapping instead of own memory
+        std::shared_ptr<MappedTerrainFile> m_mappedFile;
+
+        bool mapData(char const* filename);
+        bool mapAreaData(char const* data, size_t size, uint32 offset);
+        bool mapHeightData(char const* data, size_t size, uint32 offset);
+        bool mapGridMapLiquidData(char const* data, size_t size, uint32 offset);
+        bool mapHolesData(char const* data, size_t size, uint32 offset);
+
         bool loadAreaData(FILE* in, uint32 offset, uint32 size);
         bool loadHeightData(FILE* in, uint32 offset, uint32 size);
         bool loadGridMapLiquidData(FILE* in, uint32 offset, uint32 size);
@@ -113,6 +127,24 @@ class GridMap
         GridMapLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData* data = nullptr);
 };
 
+enum GridPrefetchCounter
+{
+    GRID_PREFETCH_REQUESTED     = 0,                        // terrain reads queued ahead of moving players
+    GRID_PREFETCH_USED          = 1,                        // grid loads which found their terrain read finished
+    GRID_PREFETCH_LATE          = 2,                        // grid loads which found their terrain read still running
+    GRID_PREFETCH_EXPIRED       = 3,                        // finished terrain reads dropped unused
+    MAX_GRID_PREFETCH_COUNTER
+};
+
+// grid loading statistics, times in microseconds
+struct GridLoadStats
+{
+    uint64 loads;                                           // grids loaded by map threads
+    uint64 loadTime;
+    uint64 maxLoadTime;
+    uint64 prefetch[MAX_GRID_PREFETCH_COUNTER];
+};
+
 template<typename Countable>
 class Referencable
 {
@@ -167,6 +199,14 @@ class TerrainInfo : public Referencable<std::atomic_long>
         // THIS METHOD IS NOT THREAD-SAFE!!!! AND IT SHOULDN'T BE THREAD-SAFE!!!!
         void CleanUpGrids(const uint32 diff);
 
+        // read the terrain files of a grid ahead of its load, Load installs them later on the map thread.
+        // RequestPrefetch returns false if the grid is loaded or already requested,
+        // Prefetch only reads files and runs on a grid loader thread
+        bool RequestPrefetch(const uint32 x, const uint32 y);
+        void Prefetch(const uint32 x, const uint32 y);
+
+        static std::string GetMapFileName(const uint32 mapId, const uint32 x, const uint32 y);
+
     protected:
         friend class Map;
         friend class ObjectMgr;
@@ -196,6 +236,24 @@ class TerrainInfo : public Referencable<std::atomic_long>
         typedef std::lock_guard<LOCK_TYPE> LOCK_GUARD;
         LOCK_TYPE m_mutex;
         LOCK_TYPE m_refMutex;
+
+        // terrain files read ahead by the grid loader threads, guarded by m_mutex
+        struct PrefetchedGrid
+        {
+            PrefetchedGrid() : ready(false), map(nullptr), navTile(nullptr), navTileSize(0), readyTime(0) {}
+
+            bool ready;
+            GridMap* map;
+            unsigned char* navTile;
+            int navTileSize;
+            uint32 readyTime;
+        };
+        typedef std::unordered_map<uint32, PrefetchedGrid> PrefetchedGridMap;
+
+        void TakePrefetchedGrid(const uint32 x, const uint32 y, PrefetchedGrid& grid);
+        static void FreePrefetchedGrid(PrefetchedGrid& grid);
+
+        PrefetchedGridMap m_prefetchedGrids;
 };
 
 // class for managing TerrainData object and all sort of geometry querying operations
@@ -233,6 +291,16 @@ class TerrainManager : public MaNGOS::Singleton<TerrainManager, MaNGOS::ClassLev
         static uint32 GetZoneIdByAreaFlag(uint16 areaflag, uint32 map_id);
         static void GetZoneAndAreaIdByAreaFlag(uint32& zoneid, uint32& areaid, uint16 areaflag, uint32 map_id);
 
+        // grid loading statistics, updated from the map and grid loader threads
+        void AddGridLoad(uint64 loadTime);
+        void AddGridPrefetch(GridPrefetchCounter counter) { ++m_gridPrefetch[counter]; }
+        GridLoadStats GetGridLoadStats() const;
+
+        // read only mappings of .map files, one per file shared by all maps and instances
+        std::shared_ptr<MappedTerrainFile> OpenMappedFile(std::string const& fileName);
+        // map and fault in all .map files of the listed maps (',' delimited ids), they stay mapped until shutdown
+        void PrefaultMapFiles(char const* mapIds);
+
     private:
         TerrainManager();
         ~TerrainManager();
@@ -242,6 +310,15 @@ class TerrainManager : public MaNGOS::Singleton<TerrainManager, MaNGOS::ClassLev
 
         typedef MaNGOS::ClassLevelLockable<TerrainManager, std::mutex>::Lock Guard;
         TerrainDataMap i_TerrainMap;
+
+        std::atomic<uint64> m_gridLoads;
+        std::atomic<uint64> m_gridLoadTime;
+        std::atomic<uint64> m_gridMaxLoadTime;
+        std::atomic<uint64> m_gridPrefetch[MAX_GRID_PREFETCH_COUNTER];
+
+        std::mutex m_mappedFilesLock;
+        std::unordered_map<std::string, std::weak_ptr<MappedTerrainFile>> m_mappedFiles;
+        std::vector<std::shared_ptr<MappedTerrainFile>> m_prefaultedFiles;
 };
 
 #define sTerrainMgr TerrainManager::Instance()
@@ -35,14 +35,22 @@
 #include "Server/DBCEnums.h"
 #include "Maps/MapPersistentStateMgr.h"
 #include "Vmap/VMapFactory.h"
+#include "Vmap/GameObjectModel.h"
 #include "MotionGenerators/MoveMap.h"
+#include "MotionGenerators/PathMovementGenerator.h"
 #include "Calendar/Calendar.h"
 #include "Chat/Chat.h"
 #include "Weather/Weather.h"
 #include "Grids/ObjectGridLoader.h"
+#include "Maps/MapWorkers.h"
+
+thread_local MapRegionContext* Map::s_regionContext = nullptr;
 
 Map::~Map()
 {
+    if (m_regionUpdater.activated())
+        m_regionUpdater.deactivate();
+
     UnloadAll(true);
 
     if (!m_scriptSchedule.empty())
@@ -54,9 +62,6 @@ Map::~Map()
     delete i_data;
     i_data = nullptr;
 
-    // unload instance specific navigation data
-    MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(m_TerrainData->GetMapId(), GetInstanceId());
-
     // release reference count
     if (m_TerrainData->Release())
         sTerrainMgr.UnloadTerrain(m_TerrainData->GetMapId());
@@ -96,7 +101,8 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
       m_activeNonPlayersIter(m_activeNonPlayers.end()), m_onEventNotifiedIter(m_onEventNotifiedObjects.end()),
       i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
       i_data(nullptr), i_script_id(0), i_defaultLight(GetDefaultMapLight(id)),
-      m_cycleCounter(0), m_updateTimeMin(INT_MAX), m_updateTimeMax(0), m_updateTimeTotal(0)
+      m_cycleCounter(0), m_updateTimeMin(INT_MAX), m_updateTimeMax(0), m_updateTimeTotal(0),
+      m_updatingRegions(false)
 {
     m_weatherSystem = new WeatherSystem(this);
 }
@@ -129,6 +135,13 @@ void Map::Initialize(bool loadInstanceData /*= true*/)
     m_persistentState->InitPools();
 
     sObjectMgr.LoadActiveEntities(this);
+
+    // continents can split their active cells into independent regions updated in parallel
+    if (IsContinent())
+    {
+        if (uint32 regionThreads = sWorld.getConfig(CONFIG_UINT32_NUM_MAP_REGION_THREADS))
+            m_regionUpdater.activate(regionThreads);
+    }
 }
 
 void Map::InitVisibilityDistance()
@@ -232,6 +245,7 @@ void Map::DeleteFromWorld(Player* pl)
 
 void Map::EnsureGridCreated(const GridPair& p)
 {
+    RegionStateGuard guard = LockRegionState();
     if (!getNGrid(p.x_coord, p.y_coord))
     {
         setNGrid(new NGridType(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
@@ -280,6 +294,8 @@ void Map::EnsureGridLoadedAtEnter(const Cell& cell, Player* player)
 
 bool Map::EnsureGridLoaded(const Cell& cell)
 {
+    RegionStateGuard guard = LockRegionState();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -297,12 +313,42 @@ bool Map::EnsureGridLoaded(const Cell& cell)
 
         // Add resurrectable corpses to world object list in grid
         sObjectAccessor.AddCorpsesToGrid(GridPair(cell.GridX(), cell.GridY()), (*grid)(cell.CellX(), cell.CellY()), this);
+
+        sTerrainMgr.AddGridLoad(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
         return true;
     }
 
     return false;
 }
 
+void Map::PrefetchGridsAhead(Player* player)
+{
+    float speed;
+    if (player->IsTaxiFlying())
+        speed = TAXI_FLIGHT_SPEED;
+    else if (player->m_movementInfo.HasMovementFlag(MOVEFLAG_FORWARD))
+        speed = player->GetSpeed(player->m_movementInfo.HasMovementFlag(MOVEFLAG_FLYING) ? MOVE_FLIGHT : MOVE_RUN);
+    else
+        return;
+
+    // grids entering the visibility range within the look ahead time, halfway and at the end
+    float lookAhead = speed * sWorld.getConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD);
+    float orientation = player->GetOrientation();
+    for (float dist : { GetVisibilityDistance() + lookAhead / 2, GetVisibilityDistance() + lookAhead })
+    {
+        float x = player->GetPositionX() + dist * cos(orientation);
+        float y = player->GetPositionY() + dist * sin(orientation);
+        if (!MaNGOS::IsValidMapCoord(x, y))
+            return;
+
+        GridPair p = MaNGOS::ComputeGridPair(x, y);
+        int gx = (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord;
+        int gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
+        if (!m_bLoadedGrids[gx][gy])
+            sMapMgr.ScheduleGridPrefetch(m_TerrainData, gx, gy);
+    }
+}
+
 uint32 Map::GetLoadedGridsCount()
 {
     uint32 count = 0;
@@ -369,6 +415,7 @@ Map::Add(T* obj)
 {
     MANGOS_ASSERT(obj);
 
+    RegionStateGuard guard = LockRegionState();
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -559,6 +606,23 @@ bool Map::loaded(const GridPair& p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
+void Map::GetObjectsInRange(float x, float y, float radius, uint32 typeMask, std::vector<WorldObject*>& result)
+{
+    // same cell range as a Cell::Visit with this radius
+    CellArea area = Cell::CalculateCellArea(x, y, std::min(radius, MAX_VISIBILITY_DISTANCE));
+    for (uint32 cx = area.low_bound.x_coord; cx <= area.high_bound.x_coord; ++cx)
+    {
+        for (uint32 cy = area.low_bound.y_coord; cy <= area.high_bound.y_coord; ++cy)
+        {
+            Cell cell(CellPair(cx, cy));
+            if (!loaded(GridPair(cell.GridX(), cell.GridY())))
+                continue;
+
+            (*getNGrid(cell.GridX(), cell.GridY()))(cell.CellX(), cell.CellY()).GetObjectIndex().Search(x, y, radius, typeMask, result);
+        }
+    }
+}
+
 void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
 {
     // lets update mobs/objects in ALL visible cells around player!
@@ -589,6 +653,7 @@ void Map::Update(const uint32& t_diff)
     std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
     m_dyn_tree.update(t_diff);
+    m_lineOfSightCache.clear();
 
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -627,6 +692,8 @@ void Map::Update(const uint32& t_diff)
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
     TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
 
+    bool prefetchGrids = sMapMgr.IsGridPrefetchEnabled();
+
     // the player iterator is stored in the map object
     // to make sure calls to Map::Remove don't invalidate it
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -637,6 +704,9 @@ void Map::Update(const uint32& t_diff)
 
         VisitNearbyCellsOf(player, grid_object_update, world_object_update);
 
+        if (prefetchGrids)
+            PrefetchGridsAhead(player);
+
         // If player is using far sight, visit that object too
         if (WorldObject* viewPoint = GetWorldObject(player->GetFarSightGuid()))
             VisitNearbyCellsOf(viewPoint, grid_object_update, world_object_update);
@@ -682,8 +752,10 @@ void Map::Update(const uint32& t_diff)
     }
 
     // update all objects
-    for (auto wObj : objToUpdate)
-        wObj->Update(t_diff);
+    UpdateObjects(objToUpdate, t_diff);
+
+    // visibility of everything that moved in this tick
+    UpdateRelocatedObjectsVisibility();
 
     // Send world objects and item update field changes
     SendObjectUpdates();
@@ -709,6 +781,10 @@ void Map::Update(const uint32& t_diff)
     if (i_data)
         i_data->Update(t_diff);
 
+    // the map is done producing output for its players this tick, don't wait for the socket timer
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        m_mapRefIter->getSource()->GetSession()->FlushPackets();
+
     std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
     long long duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
@@ -724,6 +800,142 @@ void Map::Update(const uint32& t_diff)
     m_weatherSystem->UpdateWeathers(t_diff);
 }
 
+void Map::UpdateObjects(WorldObjectUnSet& objToUpdate, uint32 diff)
+{
+    if (!m_regionUpdater.activated())
+    {
+        for (auto wObj : objToUpdate)
+            wObj->Update(diff);
+        return;
+    }
+
+    std::vector<MapRegionContext> regions;
+    BuildRegions(objToUpdate, regions);
+
+    // objects still change objects of other regions directly (threat, auras, pets, groups, scripts),
+    // so the regions are updated one after another on the map thread until all such changes go through
+    // the region context. Their layout and update times are kept for ".debug maps"
+    for (auto& region : regions)
+        UpdateRegion(region, diff);
+
+    std::lock_guard<std::mutex> guard(m_regionStatsLock);
+    m_lastRegionStats.clear();
+    for (auto& region : regions)
+    {
+        MapRegionStats stats;
+        stats.objects = region.objects.size();
+        stats.grids = region.grids;
+        stats.updateTime = region.updateTime;
+        m_lastRegionStats.push_back(stats);
+    }
+}
+
+void Map::BuildRegions(WorldObjectUnSet& objToUpdate, std::vector<MapRegionContext>& regions)
+{
+    // objects grouped by grid, ordered by grid id to keep the region layout deterministic
+    std::map<uint32, std::vector<WorldObject*> > gridObjects;
+    for (auto wObj : objToUpdate)
+    {
+        GridPair p = MaNGOS::ComputeGridPair(wObj->GetPositionX(), wObj->GetPositionY());
+        gridObjects[p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord].push_back(wObj);
+    }
+
+    // grids closer than this can see each other's objects and must be updated by the same worker
+    uint32 const mergeDistance = 2 + uint32(GetVisibilityDistance() / SIZE_OF_GRIDS);
+
+    std::vector<uint32> gridIds;
+    std::vector<uint32> parent;
+    for (auto& itr : gridObjects)
+    {
+        parent.push_back(gridIds.size());
+        gridIds.push_back(itr.first);
+    }
+
+    auto findRoot = [&parent](uint32 i) -> uint32
+    {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    for (uint32 i = 0; i < gridIds.size(); ++i)
+    {
+        for (uint32 j = i + 1; j < gridIds.size(); ++j)
+        {
+            int32 dx = int32(gridIds[i] / MAX_NUMBER_OF_GRIDS) - int32(gridIds[j] / MAX_NUMBER_OF_GRIDS);
+            int32 dy = int32(gridIds[i] % MAX_NUMBER_OF_GRIDS) - int32(gridIds[j] % MAX_NUMBER_OF_GRIDS);
+            if (uint32(std::abs(dx)) > mergeDistance || uint32(std::abs(dy)) > mergeDistance)
+                continue;
+
+            uint32 rootI = findRoot(i);
+            uint32 rootJ = findRoot(j);
+            if (rootI != rootJ)
+                parent[std::max(rootI, rootJ)] = std::min(rootI, rootJ);
+        }
+    }
+
+    std::map<uint32, uint32> rootToRegion;
+    uint32 index = 0;
+    for (auto& itr : gridObjects)
+    {
+        uint32 root = findRoot(index++);
+        auto regionItr = rootToRegion.find(root);
+        if (regionItr == rootToRegion.end())
+        {
+            regionItr = rootToRegion.insert(std::make_pair(root, uint32(regions.size()))).first;
+            regions.push_back(MapRegionContext(this));
+        }
+
+        MapRegionContext& region = regions[regionItr->second];
+        region.objects.insert(region.objects.end(), itr.second.begin(), itr.second.end());
+        ++region.grids;
+    }
+}
+
+void Map::UpdateRegion(MapRegionContext& region, uint32 diff)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    s_regionContext = &region;
+
+    for (auto wObj : region.objects)
+        wObj->Update(diff);
+
+    s_regionContext = nullptr;
+
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    region.updateTime = uint32(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+void Map::MergeRegion(MapRegionContext& region)
+{
+    for (auto obj : region.removedUpdateObjects)
+        i_objectsToClientUpdate.erase(obj);
+    i_objectsToClientUpdate.insert(region.updateObjects.begin(), region.updateObjects.end());
+
+    i_objectsToRemove.insert(region.objectsToRemove.begin(), region.objectsToRemove.end());
+
+    m_relocatedObjects.insert(m_relocatedObjects.end(), region.relocatedObjects.begin(), region.relocatedObjects.end());
+
+    for (MapRegionRelocation const& relocation : region.gridRelocations)
+    {
+        Unit* unit = GetUnit(relocation.guid);
+        if (!unit || !unit->IsInWorld())
+            continue;
+
+        if (unit->GetTypeId() == TYPEID_PLAYER)
+            PlayerRelocation(static_cast<Player*>(unit), relocation.x, relocation.y, relocation.z, relocation.orientation);
+        else
+            CreatureRelocation(static_cast<Creature*>(unit), relocation.x, relocation.y, relocation.z, relocation.orientation);
+    }
+}
+
+std::vector<MapRegionStats> Map::GetLastRegionStats()
+{
+    std::lock_guard<std::mutex> guard(m_regionStatsLock);
+    return m_lastRegionStats;
+}
+
 void Map::Remove(Player* player, bool remove)
 {
     if (i_data)
@@ -780,6 +992,7 @@ template<class T>
 void
 Map::Remove(T* obj, bool remove)
 {
+    RegionStateGuard guard = LockRegionState();
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -830,6 +1043,9 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
     Cell new_cell(new_val);
     bool same_cell = (new_cell == old_cell);
 
+    if (QueueGridRelocation(player, old_cell, new_cell, x, y, z, orientation))
+        return;
+
     player->Relocate(x, y, z, orientation);
 
     if (old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell))
@@ -861,6 +1077,9 @@ void Map::CreatureRelocation(Creature* creature, float x, float y, float z, floa
 {
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
 
+    if (QueueGridRelocation(creature, creature->GetCurrentCell(), new_cell, x, y, z, ang))
+        return;
+
     // do move or do move to respawn or remove creature if previous all fail
     if (CreatureCellRelocation(creature, new_cell))
     {
@@ -902,6 +1121,17 @@ bool Map::CreatureCellRelocation(Creature* c, const Cell& new_cell)
     return true;
 }
 
+// the grid may be updated by another region, the unit keeps its position until the regions are merged
+bool Map::QueueGridRelocation(Unit* unit, Cell const& old_cell, Cell const& new_cell, float x, float y, float z, float orientation)
+{
+    MapRegionContext* region = GetRegionContext();
+    if (!region || !old_cell.DiffGrid(new_cell))
+        return false;
+
+    region->gridRelocations.push_back({ unit->GetObjectGuid(), x, y, z, orientation });
+    return true;
+}
+
 bool Map::CreatureRespawnRelocation(Creature* c)
 {
     float resp_x, resp_y, resp_z, resp_o;
@@ -1016,6 +1246,99 @@ void Map::UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& ce
     cell.Visit(cellpair, player_notifier, *this, *obj, obj->GetVisibilityData().GetVisibilityDistance());
 }
 
+void Map::AddRelocatedObject(Unit* unit)
+{
+    if (MapRegionContext* region = GetRegionContext())
+    {
+        region->relocatedObjects.push_back(unit->GetObjectGuid());
+        return;
+    }
+
+    m_relocatedObjects.push_back(unit->GetObjectGuid());
+}
+
+void Map::UpdateRelocatedObjectsVisibility()
+{
+    if (m_relocatedObjects.empty())
+        return;
+
+    // objects queued during the pass are handled in the next tick
+    std::vector<ObjectGuid> relocated;
+    relocated.swap(m_relocatedObjects);
+    std::sort(relocated.begin(), relocated.end());
+    relocated.erase(std::unique(relocated.begin(), relocated.end()), relocated.end());
+
+    // every unit moved several times in the tick is handled once, as is every camera looking through a moved viewpoint
+    std::vector<Unit*> movers;
+    std::vector<Camera*> cameras;
+    std::unordered_set<Camera*> updatedCameras;
+    for (ObjectGuid const& guid : relocated)
+    {
+        Unit* unit = GetUnit(guid);
+        if (!unit || !unit->IsInWorld())
+            continue;
+
+        movers.push_back(unit);
+        for (Camera* camera : unit->GetViewPoint().GetCameras())
+            if (updatedCameras.insert(camera).second)
+                cameras.push_back(camera);
+    }
+
+    // the grid scans only read the grids, so continents with region threads run them in parallel.
+    // grids are loaded up front as workers must not create them
+    std::vector<VisibilityCandidates> candidates(cameras.size());
+    if (m_regionUpdater.activated() && cameras.size() > 1)
+    {
+        for (Camera* camera : cameras)
+            EnsureGridsLoadedAround(camera->GetBody(), camera->GetBody()->GetVisibilityData().GetVisibilityDistance());
+
+        size_t chunkSize = (cameras.size() + m_regionUpdater.threads() - 1) / m_regionUpdater.threads();
+        for (size_t begin = 0; begin < cameras.size(); begin += chunkSize)
+        {
+            size_t end = std::min(begin + chunkSize, cameras.size());
+            m_regionUpdater.schedule_update(new VisibilityCollectWorker(cameras.data() + begin, candidates.data() + begin, end - begin, m_regionUpdater));
+        }
+
+        m_regionUpdater.wait();
+    }
+    else
+    {
+        for (size_t i = 0; i < cameras.size(); ++i)
+            cameras[i]->CollectVisibilityCandidates(candidates[i], false);
+    }
+
+    // applying the result changes client state of the camera owners, so it stays on the map thread
+    for (size_t i = 0; i < cameras.size(); ++i)
+        cameras[i]->UpdateVisibilityForOwner(candidates[i]);
+
+    // the movers for the other cameras around them, the cameras updated above already saw them
+    for (Unit* unit : movers)
+    {
+        CellPair p = MaNGOS::ComputeCellPair(unit->GetPositionX(), unit->GetPositionY());
+        Cell cell(p);
+        cell.SetNoCreate();
+        MaNGOS::VisibleChangesNotifier notifier(*unit, &updatedCameras);
+        TypeContainerVisitor<MaNGOS::VisibleChangesNotifier, WorldTypeMapContainer > player_notifier(notifier);
+        cell.Visit(p, player_notifier, *this, *unit, unit->GetVisibilityData().GetVisibilityDistance());
+    }
+}
+
+// loads the grids which a visit of the radius around the object may load, so that the visit can use no-create cells.
+// works on the bounding square of the cells, which can include a corner grid the visit itself would skip
+void Map::EnsureGridsLoadedAround(WorldObject const* obj, float radius)
+{
+    radius = std::min(radius + obj->GetObjectBoundingRadius(), MAX_VISIBILITY_DISTANCE);
+    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), radius);
+    for (uint32 x = area.low_bound.x_coord / MAX_NUMBER_OF_CELLS; x <= area.high_bound.x_coord / MAX_NUMBER_OF_CELLS; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord / MAX_NUMBER_OF_CELLS; y <= area.high_bound.y_coord / MAX_NUMBER_OF_CELLS; ++y)
+        {
+            if (!loaded(GridPair(x, y)))
+                EnsureGridLoaded(Cell(CellPair(x * MAX_NUMBER_OF_CELLS, y * MAX_NUMBER_OF_CELLS)));
+        }
+    }
+}
+
 void Map::SendInitSelf(Player* player) const
 {
     DETAIL_LOG("Creating player data for himself %u", player->GetGUIDLow());
@@ -1112,8 +1435,15 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 {
     MANGOS_ASSERT(obj->GetMapId() == GetId() && obj->GetInstanceId() == GetInstanceId());
 
+    RegionStateGuard guard = LockRegionState();
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
 
+    if (MapRegionContext* region = GetRegionContext())
+    {
+        region->objectsToRemove.push_back(obj);
+        return;
+    }
+
     i_objectsToRemove.insert(obj);
     // DEBUG_LOG("Object (GUID: %u TypeId: %u ) added to removing list.",obj->GetGUIDLow(),obj->GetTypeId());
 }
@@ -1227,6 +1557,7 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    RegionStateGuard guard = LockRegionState();
     m_activeNonPlayers.insert(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
@@ -1255,6 +1586,8 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive(WorldObject* obj)
 {
+    RegionStateGuard guard = LockRegionState();
+
     // Map::Update for active object in proccess
     if (m_activeNonPlayersIter != m_activeNonPlayers.end())
     {
@@ -1774,6 +2107,8 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
 {
     MANGOS_ASSERT(source);
 
+    RegionStateGuard guard = LockRegionState();
+
     ///- Find the script map
     ScriptMapMap::const_iterator scriptInfoMapMapItr = scripts.second.find(id);
     if (scriptInfoMapMapItr == scripts.second.end())
@@ -1832,6 +2167,7 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
 void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* source, Object* target)
 {
     // NOTE: script record _must_ exist until command executed
+    RegionStateGuard guard = LockRegionState();
 
     // prepare static data
     ObjectGuid sourceGuid = source->GetObjectGuid();
@@ -1911,6 +2247,7 @@ Player* Map::GetPlayer(ObjectGuid guid)
  */
 Creature* Map::GetCreature(ObjectGuid guid)
 {
+    RegionStateGuard guard = LockRegionState();
     return m_objectsStore.find<Creature>(guid, (Creature*)nullptr);
 }
 
@@ -1921,6 +2258,7 @@ Creature* Map::GetCreature(ObjectGuid guid)
  */
 Pet* Map::GetPet(ObjectGuid guid)
 {
+    RegionStateGuard guard = LockRegionState();
     return m_objectsStore.find<Pet>(guid, (Pet*)nullptr);
 }
 
@@ -1962,6 +2300,7 @@ Creature* Map::GetAnyTypeCreature(ObjectGuid guid)
  */
 GameObject* Map::GetGameObject(ObjectGuid guid)
 {
+    RegionStateGuard guard = LockRegionState();
     return m_objectsStore.find<GameObject>(guid, (GameObject*)nullptr);
 }
 
@@ -1972,6 +2311,7 @@ GameObject* Map::GetGameObject(ObjectGuid guid)
  */
 DynamicObject* Map::GetDynamicObject(ObjectGuid guid)
 {
+    RegionStateGuard guard = LockRegionState();
     return m_objectsStore.find<DynamicObject>(guid, (DynamicObject*)nullptr);
 }
 
@@ -2029,6 +2369,33 @@ void Map::SendObjectUpdates()
         obj->BuildUpdateData(update_players);
     }
 
+    // continents with region threads build and compress the packets in parallel, sending stays on the map thread
+    if (m_regionUpdater.activated() && update_players.size() > 1 && sWorld.getConfig(CONFIG_BOOL_MAP_REGIONS_BUILD_PACKETS))
+    {
+        std::vector<UpdatePacketJob> jobs(update_players.size());
+        size_t index = 0;
+        for (auto& update_player : update_players)
+        {
+            jobs[index].player = update_player.first;
+            jobs[index].data = &update_player.second;
+            ++index;
+        }
+
+        size_t chunkSize = (jobs.size() + m_regionUpdater.threads() - 1) / m_regionUpdater.threads();
+        for (size_t begin = 0; begin < jobs.size(); begin += chunkSize)
+        {
+            size_t end = std::min(begin + chunkSize, jobs.size());
+            m_regionUpdater.schedule_update(new UpdatePacketWorker(jobs.data() + begin, jobs.data() + end, m_regionUpdater));
+        }
+
+        m_regionUpdater.wait();
+
+        for (auto& job : jobs)
+            if (job.built)
+                job.player->GetSession()->SendPacket(job.packet);
+        return;
+    }
+
     WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
     for (auto& update_player : update_players)
     {
@@ -2041,6 +2408,7 @@ void Map::SendObjectUpdates()
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
 {
     // TODO: for map local guid counters possible force reload map instead shutdown server at guid counter overflow
+    RegionStateGuard guard = LockRegionState();
     switch (guidhigh)
     {
         case HIGHGUID_UNIT:
@@ -2161,8 +2529,79 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
  */
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model)
-           && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+    bool useCache = sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE);
+    LineOfSightKey key(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+    if (useCache)
+    {
+        LineOfSightCacheGuard guard = LockLineOfSightCache();
+        auto itr = m_lineOfSightCache.find(key);
+        if (itr != m_lineOfSightCache.end())
+            return itr->second;
+    }
+
+    bool result = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model);
+
+    // a model change can't drop the cache between the check and the insert
+    DynamicTreeReadGuard guard = ReadLockDynamicTree();
+    if (result)
+        result = m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask, ignoreM2Model);
+    if (useCache)
+    {
+        LineOfSightCacheGuard cacheGuard = LockLineOfSightCache();
+        m_lineOfSightCache.emplace(key, result);
+    }
+    return result;
+}
+
+void Map::IsInLineOfSight(std::vector<G3D::Vector3> const& sources, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model, std::vector<bool>& results) const
+{
+    bool useCache = sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE);
+    results.assign(sources.size(), true);
+
+    // only the rays missing from the tick cache go to the vmap tree
+    std::vector<G3D::Vector3> uncachedSources;
+    std::vector<size_t> uncachedIndexes;
+    {
+        LineOfSightCacheGuard guard = LockLineOfSightCache();
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            if (useCache)
+            {
+                auto itr = m_lineOfSightCache.find(LineOfSightKey(sources[i].x, sources[i].y, sources[i].z, destX, destY, destZ, phasemask, ignoreM2Model));
+                if (itr != m_lineOfSightCache.end())
+                {
+                    results[i] = itr->second;
+                    continue;
+                }
+            }
+            uncachedSources.push_back(sources[i]);
+            uncachedIndexes.push_back(i);
+        }
+    }
+
+    if (uncachedSources.empty())
+        return;
+
+    std::vector<bool> staticResults;
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), uncachedSources, destX, destY, destZ, staticResults, ignoreM2Model);
+
+    DynamicTreeReadGuard guard = ReadLockDynamicTree();
+    for (size_t i = 0; i < uncachedSources.size(); ++i)
+    {
+        G3D::Vector3 const& source = uncachedSources[i];
+        bool result = staticResults[i] && m_dyn_tree.isInLineOfSight(source.x, source.y, source.z, destX, destY, destZ, phasemask, ignoreM2Model);
+        results[uncachedIndexes[i]] = result;
+    }
+
+    if (useCache)
+    {
+        LineOfSightCacheGuard cacheGuard = LockLineOfSightCache();
+        for (size_t i = 0; i < uncachedSources.size(); ++i)
+        {
+            G3D::Vector3 const& source = uncachedSources[i];
+            m_lineOfSightCache.emplace(LineOfSightKey(source.x, source.y, source.z, destX, destY, destZ, phasemask, ignoreM2Model), bool(results[uncachedIndexes[i]]));
+        }
+    }
 }
 
 /**
@@ -2182,6 +2621,7 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
         destZ = tempZ;
     }
     // at second all dynamic objects, if static check has an hit, then we can calculate only to this closer point
+    DynamicTreeReadGuard guard = ReadLockDynamicTree();
     bool result1 = m_dyn_tree.getObjectHitPos(phasemask, srcX, srcY, srcZ, destX, destY, destZ, tempX, tempY, tempZ, modifyDist);
     if (result1)
     {
@@ -2245,6 +2685,7 @@ bool Map::GetHeightInRange(uint32 phasemask, float x, float y, float& z, float m
             return false;
     }
 
+    DynamicTreeReadGuard guard = ReadLockDynamicTree();
     z = std::max<float>(height, m_dyn_tree.getHeight(x, y, height + 1.0f, maxSearchDist, phasemask));
     return true;
 }
@@ -2255,24 +2696,47 @@ float Map::GetHeight(uint32 phasemask, float x, float y, float z) const
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
+    DynamicTreeReadGuard guard = ReadLockDynamicTree();
     return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight, phasemask));
 }
 
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
+    DynamicTreeWriteGuard guard = WriteLockDynamicTree();
     m_dyn_tree.insert(mdl);
+    if (m_updatingRegions)
+        m_dyn_tree.balance();
+
+    LineOfSightCacheGuard cacheGuard = LockLineOfSightCache();
+    m_lineOfSightCache.clear();
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
+    DynamicTreeWriteGuard guard = WriteLockDynamicTree();
     m_dyn_tree.remove(mdl);
+    if (m_updatingRegions)
+        m_dyn_tree.balance();
+
+    LineOfSightCacheGuard cacheGuard = LockLineOfSightCache();
+    m_lineOfSightCache.clear();
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
 {
+    DynamicTreeReadGuard guard = ReadLockDynamicTree();
     return m_dyn_tree.contains(mdl);
 }
 
+void Map::EnableGameObjectModel(GameObjectModel& mdl, uint32 phasemask)
+{
+    DynamicTreeWriteGuard guard = WriteLockDynamicTree();
+    mdl.enable(phasemask);
+
+    LineOfSightCacheGuard cacheGuard = LockLineOfSightCache();
+    m_lineOfSightCache.clear();
+}
+
 // This will generate a random point to all directions in water for the provided point in radius range.
 bool Map::GetRandomPointUnderWater(uint32 phaseMask, float& x, float& y, float& z, float radius, GridMapLiquidData& liquid_status, bool randomRange/* = true*/) const
 {
@@ -2472,16 +2936,19 @@ void Map::OnEventHappened(uint16 event_id, bool activate, bool resume)
 
 uint32 Map::SpawnedCountForEntry(uint32 entry)
 {
+    RegionStateGuard guard = LockRegionState();
     return m_spawnedCount[entry].size();
 }
 
 void Map::AddToSpawnCount(const ObjectGuid& guid)
 {
+    RegionStateGuard guard = LockRegionState();
     m_spawnedCount[guid.GetEntry()].insert(guid);
 }
 
 void Map::RemoveFromSpawnCount(const ObjectGuid& guid)
 {
+    RegionStateGuard guard = LockRegionState();
     m_spawnedCount[guid.GetEntry()].erase(guid);
 }
 
@@ -34,10 +34,14 @@
 #include "DBScripts/ScriptMgr.h"
 #include "Entities/CreatureLinkingMgr.h"
 #include "Vmap/DynamicTree.h"
+#include "Maps/MapUpdater.h"
+
+#include <boost/thread/shared_mutex.hpp>
 
 #include <bitset>
 #include <functional>
 #include <list>
+#include <mutex>
 
 struct CreatureInfo;
 class Creature;
@@ -105,8 +109,73 @@ struct ZoneDynamicInfo
 
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
 
+// position a unit moves to once the regions are merged
+struct MapRegionRelocation
+{
+    ObjectGuid guid;
+    float x, y, z, orientation;
+};
+
+// Objects of one map region are to be updated by a single region worker thread.
+// Side effects on shared map state are collected here while regions run in parallel
+// and merged into the map in region order once all regions of the tick have finished.
+struct MapRegionContext
+{
+    explicit MapRegionContext(Map* _map) : map(_map), grids(0), updateTime(0) {}
+
+    Map* map;
+    std::vector<WorldObject*> objects;                      // objects to update in this region
+    std::set<Object*> updateObjects;                        // deferred Map::AddUpdateObject
+    std::set<Object*> removedUpdateObjects;                 // deferred Map::RemoveUpdateObject
+    std::vector<WorldObject*> objectsToRemove;              // deferred Map::AddObjectToRemoveList
+    std::vector<ObjectGuid> relocatedObjects;               // deferred Map::AddRelocatedObject
+    std::vector<MapRegionRelocation> gridRelocations;       // deferred Map::CreatureRelocation and PlayerRelocation into another grid
+    uint32 grids;
+    uint32 updateTime;                                      // in microseconds
+};
+
+struct MapRegionStats
+{
+    uint32 objects;
+    uint32 grids;
+    uint32 updateTime;                                      // in microseconds
+};
+
 typedef std::unordered_map<uint32 /*zoneId*/, ZoneDynamicInfo> ZoneDynamicInfoMap;
 
+// Line of sight results are kept for the rest of the map tick, AoE spells and aggro checks repeat the same rays
+struct LineOfSightKey
+{
+    LineOfSightKey(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 _phasemask, bool _ignoreM2Model) :
+        phasemask(_phasemask), ignoreM2Model(_ignoreM2Model)
+    {
+        coords[0] = srcX; coords[1] = srcY; coords[2] = srcZ;
+        coords[3] = destX; coords[4] = destY; coords[5] = destZ;
+    }
+
+    bool operator==(LineOfSightKey const& other) const
+    {
+        return std::equal(coords, coords + 6, other.coords) && phasemask == other.phasemask && ignoreM2Model == other.ignoreM2Model;
+    }
+
+    float coords[6];
+    uint32 phasemask;
+    bool ignoreM2Model;
+};
+
+struct LineOfSightKeyHash
+{
+    size_t operator()(LineOfSightKey const& key) const
+    {
+        size_t hash = std::hash<uint32>()(key.phasemask) ^ size_t(key.ignoreM2Model);
+        for (float coord : key.coords)
+            hash = hash * 31 + std::hash<float>()(coord);
+        return hash;
+    }
+};
+
+typedef std::unordered_map<LineOfSightKey, bool, LineOfSightKeyHash> LineOfSightCache;
+
 class Map : public GridRefManager<NGridType>
 {
         friend class MapReference;
@@ -162,6 +231,9 @@ class Map : public GridRefManager<NGridType>
 
         template<class T, class CONTAINER> void Visit(const Cell& cell, TypeContainerVisitor<T, CONTAINER>& visitor);
 
+        // objects of the type mask with their combat reach within radius of x, y, found in the cell indexes of loaded grids
+        void GetObjectsInRange(float x, float y, float radius, uint32 typeMask, std::vector<WorldObject*>& result);
+
         bool IsRemovalGrid(float x, float y) const
         {
             GridPair p = MaNGOS::ComputeGridPair(x, y);
@@ -228,6 +300,11 @@ class Map : public GridRefManager<NGridType>
 
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& cellpair);
 
+        // queues the visibility update of a moved unit, done for all units moved in the tick by one pass after the object updates
+        void AddRelocatedObject(Unit* unit);
+        // runs that pass, also called by MapManager for units moved after the map update like transport passengers
+        void UpdateRelocatedObjectsVisibility();
+
         void resetMarkedCells() { marked_cells.reset(); }
         bool isCellMarked(uint32 pCellId) const { return marked_cells.test(pCellId); }
         void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
@@ -283,11 +360,25 @@ class Map : public GridRefManager<NGridType>
 
         void AddUpdateObject(Object* obj)
         {
+            if (MapRegionContext* region = GetRegionContext())
+            {
+                region->removedUpdateObjects.erase(obj);
+                region->updateObjects.insert(obj);
+                return;
+            }
+
             i_objectsToClientUpdate.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            if (MapRegionContext* region = GetRegionContext())
+            {
+                region->updateObjects.erase(obj);
+                region->removedUpdateObjects.insert(obj);
+                return;
+            }
+
             i_objectsToClientUpdate.erase(obj);
         }
 
@@ -309,12 +400,16 @@ class Map : public GridRefManager<NGridType>
         float GetHeight(uint32 phasemask, float x, float y, float z) const;
         bool GetHeightInRange(uint32 phasemask, float x, float y, float& z, float maxSearchDist = 4.0f) const;
         bool IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model) const;
+        // checks every source against one destination with a single vmap tree walk, results[i] belongs to sources[i]
+        void IsInLineOfSight(std::vector<G3D::Vector3> const& sources, float destX, float destY, float destZ, uint32 phasemask, bool ignoreM2Model, std::vector<bool>& results) const;
         bool GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, uint32 phasemask, float modifyDist) const;
 
         // Object Model insertion/remove/test for dynamic vmaps use
         void InsertGameObjectModel(const GameObjectModel& mdl);
         void RemoveGameObjectModel(const GameObjectModel& mdl);
         bool ContainsGameObjectModel(const GameObjectModel& mdl) const;
+        // changes the phases a model collides in, 0 disables it
+        void EnableGameObjectModel(GameObjectModel& mdl, uint32 phasemask);
 
         // Get Holder for Creature Linking
         CreatureLinkingHolder* GetCreatureLinkingHolder() { return &m_creatureLinkingHolder; }
@@ -346,7 +441,12 @@ class Map : public GridRefManager<NGridType>
 
         uint32 GetUpdateTimeMin() { return m_updateTimeMin; }
         uint32 GetUpdateTimeMax() { return m_updateTimeMax; }
-        uint32 GetUpdateTimeAvg() { return uint32(m_updateTimeTotal / m_cycleCounter); }
+        uint32 GetUpdateTimeAvg() { return m_cycleCounter ? uint32(m_updateTimeTotal / m_cycleCounter) : 0; }
+
+        // Region update (continents only, see MapUpdate.Regions.Threads), the regions are not run in parallel yet
+        bool IsUpdatingRegions() const { return m_updatingRegions; }
+        void UpdateRegion(MapRegionContext& region, uint32 diff);
+        std::vector<MapRegionStats> GetLastRegionStats();
 
         uint32 GetCurrentMSTime() const;
         TimePoint GetCurrentClockTime() const;
@@ -373,10 +473,12 @@ class Map : public GridRefManager<NGridType>
         void SendZoneDynamicInfo(Player* player) const;
 
         bool CreatureCellRelocation(Creature* c, const Cell& new_cell);
+        bool QueueGridRelocation(Unit* unit, Cell const& old_cell, Cell const& new_cell, float x, float y, float z, float orientation);
 
         bool loaded(const GridPair&) const;
         void EnsureGridCreated(const GridPair&);
         bool EnsureGridLoaded(Cell const&);
+        void PrefetchGridsAhead(Player* player);
         void EnsureGridLoadedAtEnter(Cell const&, Player* player = nullptr);
 
         void buildNGridLinkage(NGridType* pNGridType) { pNGridType->link(this); }
@@ -397,6 +499,45 @@ class Map : public GridRefManager<NGridType>
         void SendObjectUpdates();
         std::set<Object*> i_objectsToClientUpdate;
 
+        void UpdateObjects(WorldObjectUnSet& objToUpdate, uint32 diff);
+        void BuildRegions(WorldObjectUnSet& objToUpdate, std::vector<MapRegionContext>& regions);
+        void MergeRegion(MapRegionContext& region);
+
+        void EnsureGridsLoadedAround(WorldObject const* obj, float radius);
+        std::vector<ObjectGuid> m_relocatedObjects;
+
+        // returns the region context of the calling thread while this map updates its regions in parallel
+        MapRegionContext* GetRegionContext() const
+        {
+            return (m_updatingRegions && s_regionContext && s_regionContext->map == this) ? s_regionContext : nullptr;
+        }
+
+        // shared map state touched by region workers is serialized by this lock, only taken while regions are updated
+        typedef std::unique_lock<std::recursive_mutex> RegionStateGuard;
+        RegionStateGuard LockRegionState() const
+        {
+            return m_updatingRegions ? RegionStateGuard(m_regionStateLock) : RegionStateGuard();
+        }
+
+        // region workers share the dynamic tree for reading, model changes rebalance it under the exclusive lock.
+        // the line of sight cache is locked after the tree
+        typedef boost::shared_lock<boost::shared_mutex> DynamicTreeReadGuard;
+        typedef boost::unique_lock<boost::shared_mutex> DynamicTreeWriteGuard;
+        DynamicTreeReadGuard ReadLockDynamicTree() const
+        {
+            return m_updatingRegions ? DynamicTreeReadGuard(m_dynTreeLock) : DynamicTreeReadGuard();
+        }
+        DynamicTreeWriteGuard WriteLockDynamicTree() const
+        {
+            return m_updatingRegions ? DynamicTreeWriteGuard(m_dynTreeLock) : DynamicTreeWriteGuard();
+        }
+
+        typedef std::unique_lock<std::mutex> LineOfSightCacheGuard;
+        LineOfSightCacheGuard LockLineOfSightCache() const
+        {
+            return m_updatingRegions ? LineOfSightCacheGuard(m_lineOfSightCacheLock) : LineOfSightCacheGuard();
+        }
+
     protected:
         MapEntry const* i_mapEntry;
         uint8 i_spawnMode;
@@ -460,6 +601,9 @@ class Map : public GridRefManager<NGridType>
         // Dynamic Map tree object
         DynamicMapTree m_dyn_tree;
 
+        // line of sight results of the current tick, dropped on each update and whenever a gameobject model changes
+        mutable LineOfSightCache m_lineOfSightCache;
+
         // WeatherSystem
         WeatherSystem* m_weatherSystem;
 
@@ -473,6 +617,16 @@ class Map : public GridRefManager<NGridType>
         std::atomic<uint32> m_updateTimeMin;
         std::atomic<uint32> m_updateTimeMax;
         std::atomic<uint64> m_updateTimeTotal;
+
+        // Parallel region update
+        MapUpdater m_regionUpdater;
+        std::atomic<bool> m_updatingRegions;
+        mutable std::recursive_mutex m_regionStateLock;
+        mutable boost::shared_mutex m_dynTreeLock;
+        mutable std::mutex m_lineOfSightCacheLock;
+        std::vector<MapRegionStats> m_lastRegionStats;
+        std::mutex m_regionStatsLock;
+        static thread_local MapRegionContext* s_regionContext;
 };
 
 class WorldMap : public Map
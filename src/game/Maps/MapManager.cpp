@@ -27,14 +27,18 @@
 #include "Grids/CellImpl.h"
 #include "Globals/ObjectMgr.h"
 #include "Maps/MapWorkers.h"
+#include "MotionGenerators/PathFinder.h"
 #include <future>
+#include <algorithm>
+#include <chrono>
 
 #define CLASS_LOCK MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex>
 INSTANTIATE_SINGLETON_2(MapManager, CLASS_LOCK);
 INSTANTIATE_CLASS_MUTEX(MapManager, std::recursive_mutex);
 
 MapManager::MapManager()
-    : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN))
+    : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)), m_updaterTickTime(0), m_updaterIdleTime(0),
+      m_pathSearchRequests(0), m_pathSearchDeduplicated(0), m_pathSearchWaitTime(0), m_pathSearchMaxWaitTime(0)
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
 }
@@ -58,6 +62,59 @@ void MapManager::Initialize()
     int num_threads(sWorld.getConfig(CONFIG_UINT32_NUM_MAP_THREADS));
     if (num_threads > 0)
         m_updater.activate(num_threads);
+
+    if (uint32 prefetchThreads = sWorld.getConfig(CONFIG_UINT32_NUM_GRID_PREFETCH_THREADS))
+        m_gridLoader.activate(prefetchThreads);
+
+    if (uint32 pathThreads = sWorld.getConfig(CONFIG_UINT32_NUM_PATH_SEARCH_THREADS))
+        m_pathSearcher.activate(pathThreads);
+}
+
+void MapManager::ScheduleGridPrefetch(TerrainInfo* terrain, uint32 x, uint32 y)
+{
+    if (terrain->RequestPrefetch(x, y))
+        m_gridLoader.schedule_update(new GridPrefetchWorker(*terrain, x, y, m_gridLoader));
+}
+
+std::shared_ptr<PathRequest> MapManager::RequestPath(std::shared_ptr<PathRequest> const& request)
+{
+    ++m_pathSearchRequests;
+
+    PathRequestKey key(request->mapId, uint64(request->startPoly), uint64(request->endPoly),
+                       (uint32(request->filter.getIncludeFlags()) << 16) | request->filter.getExcludeFlags(),
+                       (request->useStraightPath ? 0x80000000 : 0) | request->pointPathLimit);
+    {
+        std::lock_guard<std::mutex> lock(m_pathRequestsLock);
+        std::shared_ptr<PathRequest>& queued = m_pathRequests[key];
+        if (queued)
+        {
+            ++m_pathSearchDeduplicated;
+            return queued;
+        }
+        queued = request;
+    }
+
+    request->queueTime = std::chrono::steady_clock::now();
+    m_pathSearcher.schedule_update(new PathSearchWorker(request, m_pathSearcher));
+    return request;
+}
+
+void MapManager::AddPathSearchWait(uint64 waitTime)
+{
+    m_pathSearchWaitTime += waitTime;
+
+    uint64 maxWaitTime = m_pathSearchMaxWaitTime;
+    while (waitTime > maxWaitTime && !m_pathSearchMaxWaitTime.compare_exchange_weak(maxWaitTime, waitTime)) {}
+}
+
+PathSearchStats MapManager::GetPathSearchStats() const
+{
+    PathSearchStats stats;
+    stats.requests = m_pathSearchRequests;
+    stats.deduplicated = m_pathSearchDeduplicated;
+    stats.waitTime = m_pathSearchWaitTime;
+    stats.maxWaitTime = m_pathSearchMaxWaitTime;
+    return stats;
 }
 
 void MapManager::InitStateMachine()
@@ -195,20 +252,53 @@ void MapManager::Update(uint32 diff)
     if (!i_timer.Passed())
         return;
 
-    for (auto& map : i_maps)
+    // searches of the last tick are not shared anymore, the navmesh may have changed since
     {
-        if (m_updater.activated())
-            m_updater.schedule_update(new MapUpdateWorker(*map.second, (uint32)i_timer.GetCurrent(), m_updater));
-        else
-            map.second->Update((uint32)i_timer.GetCurrent());
+        std::lock_guard<std::mutex> lock(m_pathRequestsLock);
+        m_pathRequests.clear();
     }
 
     if (m_updater.activated())
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint64 busyTime = m_updater.GetStats().busyTime;
+
+        // most expensive maps first, the cheap ones fill the gaps at the end of the tick
+        std::vector<std::pair<uint32, Map*> > maps;
+        maps.reserve(i_maps.size());
+        for (auto& map : i_maps)
+            maps.push_back(std::make_pair(map.second->GetUpdateTimeAvg(), map.second));
+
+        std::stable_sort(maps.begin(), maps.end(), [](std::pair<uint32, Map*> const& left, std::pair<uint32, Map*> const& right)
+        {
+            return left.first > right.first;
+        });
+
+        for (auto& map : maps)
+            m_updater.schedule_update(new MapUpdateWorker(*map.second, (uint32)i_timer.GetCurrent(), m_updater));
+
         m_updater.wait();
 
+        uint64 tickTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        busyTime = m_updater.GetStats().busyTime - busyTime;
+        uint64 availableTime = tickTime * m_updater.threads();
+
+        m_updaterTickTime = uint32(tickTime);
+        m_updaterIdleTime = availableTime > busyTime ? uint32(availableTime - busyTime) : 0;
+    }
+    else
+    {
+        for (auto& map : i_maps)
+            map.second->Update((uint32)i_timer.GetCurrent());
+    }
+
     for (Transport* m_Transport : m_Transports)
         m_Transport->Update((uint32)i_timer.GetCurrent());
 
+    // units moved outside of the map updates would otherwise wait for the next tick
+    for (auto& map : i_maps)
+        map.second->UpdateRelocatedObjectsVisibility();
+
     // remove all maps which can be unloaded
     MapMapType::iterator iter = i_maps.begin();
     while (iter != i_maps.end())
@@ -254,6 +344,10 @@ bool MapManager::IsValidMAP(uint32 mapid)
 
 void MapManager::UnloadAll()
 {
+    // no searches may run while the navmeshes are unloaded
+    if (m_pathSearcher.activated())
+        m_pathSearcher.deactivate();
+
     for (auto& i_map : i_maps)
         i_map.second->UnloadAll(true);
 
@@ -266,6 +360,9 @@ void MapManager::UnloadAll()
     if (m_updater.activated())
         m_updater.deactivate();
 
+    if (m_gridLoader.activated())
+        m_gridLoader.deactivate();
+
     TerrainManager::Instance().UnloadAll();
 }
 
@@ -27,8 +27,21 @@
 #include "Grids/GridStates.h"
 #include "Maps/MapUpdater.h"
 
+#include <atomic>
+#include <memory>
+#include <tuple>
+
 class Transport;
 class BattleGround;
+struct PathRequest;
+
+struct PathSearchStats
+{
+    uint64 requests;                                        // full searches requested by path finders
+    uint64 deduplicated;                                    // requests served by a search of the same polygons requested in the same tick
+    uint64 waitTime;                                        // time the searches waited for a search thread, in microseconds
+    uint64 maxWaitTime;
+};
 
 struct MapID
 {
@@ -149,6 +162,22 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         uint32 GetMapUpdateMaxTime(uint32 mapId, uint32 instance = 0);
         uint32 GetMapUpdateAvgTime(uint32 mapId, uint32 instance = 0);
 
+        // map updater thread statistics, times of the last tick in microseconds
+        MapUpdaterStats GetMapUpdaterStats() const { return m_updater.GetStats(); }
+        uint32 GetMapUpdaterTickTime() const { return m_updaterTickTime; }
+        uint32 GetMapUpdaterIdleTime() const { return m_updaterIdleTime; }
+
+        // background reading of terrain files for grids players are heading to
+        bool IsGridPrefetchEnabled() { return m_gridLoader.activated(); }
+        void ScheduleGridPrefetch(TerrainInfo* terrain, uint32 x, uint32 y);
+
+        // navmesh searches of path finders done by background threads
+        bool IsPathSearchEnabled() { return m_pathSearcher.activated(); }
+        // return: the queued search, or the one of the same polygons already requested this tick
+        std::shared_ptr<PathRequest> RequestPath(std::shared_ptr<PathRequest> const& request);
+        void AddPathSearchWait(uint64 waitTime);
+        PathSearchStats GetPathSearchStats() const;
+
         // get list of all maps
         const MapMapType& Maps() const { return i_maps; }
 
@@ -184,6 +213,21 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         IntervalTimer i_timer;
 
         MapUpdater m_updater;
+        uint32 m_updaterTickTime;
+        uint32 m_updaterIdleTime;
+
+        MapUpdater m_gridLoader;
+
+        // map, start and end poly, filter flags, point path options
+        typedef std::tuple<uint32, uint64, uint64, uint32, uint32> PathRequestKey;
+
+        MapUpdater m_pathSearcher;
+        std::mutex m_pathRequestsLock;
+        std::map<PathRequestKey, std::shared_ptr<PathRequest> > m_pathRequests;     // requested this tick
+        std::atomic<uint64> m_pathSearchRequests;
+        std::atomic<uint64> m_pathSearchDeduplicated;
+        std::atomic<uint64> m_pathSearchWaitTime;
+        std::atomic<uint64> m_pathSearchMaxWaitTime;
 };
 
 template<typename Do>
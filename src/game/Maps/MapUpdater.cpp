@@ -19,10 +19,12 @@
 #include "MapUpdater.h"
 #include "MapWorkers.h"
 
-MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), pending_requests(0)
+#include <chrono>
+
+MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), _queued_requests(0), _sleeping_threads(0), _next_queue(0), pending_requests(0),
+    _executed(0), _stolen(0), _busyTime(0)
 {
-    for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+    activate(num_threads);
 }
 
 void MapUpdater::activate(size_t num_threads)
@@ -30,26 +32,43 @@ void MapUpdater::activate(size_t num_threads)
     if (activated())
         return;
 
+    _cancelationToken = false;
+
+    // all queues must exist before the first thread starts stealing
     for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+        _queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue));
+
+    for (size_t i = 0; i < num_threads; ++i)
+        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this, i));
 }
 
 void MapUpdater::deactivate()
 {
-    _cancelationToken = true;
-
-    _queue.Cancel();
+    {
+        std::lock_guard<std::mutex> lock(_sleepLock);
+        _cancelationToken = true;
+    }
+    _sleepCondition.notify_all();
 
     for (auto& thread : _workerThreads)
         thread.join();
+
+    for (auto& queue : _queues)
+    {
+        for (Worker* request : queue->requests)
+            delete request;
+    }
+
+    _workerThreads.clear();
+    _queues.clear();
+    _queued_requests = 0;
 }
 
 void MapUpdater::wait()
 {
     std::unique_lock<std::mutex> lock(_lock);
 
-    while (pending_requests > 0)
-        _condition.wait(lock);
+    _condition.wait(lock, [this] { return pending_requests == 0; });
 }
 
 void MapUpdater::join()
@@ -65,36 +84,97 @@ bool MapUpdater::activated()
 
 void MapUpdater::update_finished()
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    if (--pending_requests > 0)
+        return;
 
-    --pending_requests;
+    // last request of the batch, the waiter may be between checking the counter and sleeping
+    std::lock_guard<std::mutex> lock(_lock);
     _condition.notify_all();
 }
 
 void MapUpdater::schedule_update(Worker* worker)
 {
-    std::lock_guard<std::mutex> lock(_lock);
-
     ++pending_requests;
-    _queue.Push(std::move(worker));
+    ++_queued_requests;
+
+    // round robin over the thread queues keeps the scheduling order per thread
+    WorkerQueue& queue = *_queues[_next_queue++ % _queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.requests.push_back(worker);
+    }
+
+    // sleeping threads recheck the queued counter under the sleep lock before they wait
+    if (_sleeping_threads > 0)
+    {
+        { std::lock_guard<std::mutex> lock(_sleepLock); }
+        _sleepCondition.notify_one();
+    }
+}
+
+MapUpdaterStats MapUpdater::GetStats() const
+{
+    MapUpdaterStats stats;
+    stats.executed = _executed;
+    stats.stolen = _stolen;
+    stats.busyTime = _busyTime;
+    return stats;
 }
 
-void MapUpdater::WorkerThread()
+Worker* MapUpdater::PopRequest(size_t index)
 {
-    while (true)
+    // own queue first, oldest request first
     {
-        Worker* request = nullptr;
+        WorkerQueue& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.requests.empty())
+        {
+            Worker* request = queue.requests.front();
+            queue.requests.pop_front();
+            return request;
+        }
+    }
 
-        _queue.WaitAndPop(request);
+    // steal the newest (cheapest) request of another thread
+    for (size_t i = 1; i < _queues.size(); ++i)
+    {
+        WorkerQueue& queue = *_queues[(index + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.requests.empty())
+        {
+            Worker* request = queue.requests.back();
+            queue.requests.pop_back();
+            ++_stolen;
+            return request;
+        }
+    }
+
+    return nullptr;
+}
 
-        if (_cancelationToken)
+void MapUpdater::WorkerThread(size_t index)
+{
+    while (!_cancelationToken)
+    {
+        Worker* request = PopRequest(index);
+        if (!request)
         {
-            delete request;
-            return;
+            std::unique_lock<std::mutex> lock(_sleepLock);
+            ++_sleeping_threads;
+            _sleepCondition.wait(lock, [this] { return _queued_requests > 0 || _cancelationToken; });
+            --_sleeping_threads;
+            continue;
         }
 
+        --_queued_requests;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
         request->execute();
 
+        _busyTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        ++_executed;
+
         delete request;
     }
-}
\ No newline at end of file
+}
@@ -20,42 +20,76 @@
 #define _MAP_UPDATER_H_INCLUDED
 
 #include "Platform/Define.h"
-#include "ProducerConsumerQueue.h"
 
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <condition_variable>
 
 class Worker;
 
+struct MapUpdaterStats
+{
+    uint64 executed;                                        // finished requests
+    uint64 stolen;                                          // requests executed by another thread than the one they were queued for
+    uint64 busyTime;                                        // time spent in Worker::execute, in microseconds
+};
+
 class MapUpdater
 {
     public:
-        MapUpdater() : _cancelationToken(false), pending_requests(0) {}
+        MapUpdater() : _cancelationToken(false), _queued_requests(0), _sleeping_threads(0), _next_queue(0), pending_requests(0),
+            _executed(0), _stolen(0), _busyTime(0) {}
         MapUpdater(size_t num_threads);
         MapUpdater(const MapUpdater&) = delete;
-        
+
         void activate(size_t num_threads);
         void deactivate();
         void wait();
         void join();
         bool activated();
+        size_t threads() const { return _workerThreads.size(); }
         void update_finished();
+        // requests are started in scheduling order, schedule the most expensive ones first
         void schedule_update(Worker* worker);
 
+        MapUpdaterStats GetStats() const;
+
     private:
-        ProducerConsumerQueue<Worker *> _queue;
+        // every thread owns a queue and takes its work from the front,
+        // idle threads steal from the back of the other queues
+        struct WorkerQueue
+        {
+            std::mutex lock;
+            std::deque<Worker*> requests;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
 
         std::vector<std::thread> _workerThreads;
         std::atomic<bool> _cancelationToken;
 
+        // idle threads sleep until new requests are queued
+        std::mutex _sleepLock;
+        std::condition_variable _sleepCondition;
+        std::atomic<size_t> _queued_requests;
+        std::atomic<size_t> _sleeping_threads;
+        std::atomic<size_t> _next_queue;
+
+        // completion barrier, the lock is only taken by the waiter and the last finished request
         std::mutex _lock;
         std::condition_variable _condition;
-        size_t pending_requests;
+        std::atomic<size_t> pending_requests;
+
+        std::atomic<uint64> _executed;
+        std::atomic<uint64> _stolen;
+        std::atomic<uint64> _busyTime;
 
-        void WorkerThread();
+        Worker* PopRequest(size_t index);
+        void WorkerThread(size_t index);
 };
 
-#endif //_MAP_UPDATER_H_INCLUDED
\ No newline at end of file
+#endif //_MAP_UPDATER_H_INCLUDED
@@ -23,13 +23,17 @@
 #include "Grids/GridNotifiersImpl.h"
 #include "MapUpdater.h"
 #include "MotionGenerators/MovementGenerator.h"
+#include "MotionGenerators/PathFinder.h"
 #include "Entities/Object.h"
+#include "Entities/UpdateData.h"
 #include "Platform/Define.h"
+#include "WorldPacket.h"
 
 class Worker
 {
     public:
         Worker(MapUpdater& updater) : m_updater(updater) {}
+        virtual ~Worker() {}
         virtual void execute() {};
 
     protected:
@@ -87,6 +91,57 @@ class GridCrawler : public Worker
 };
 
 
+struct UpdatePacketJob
+{
+    UpdatePacketJob() : player(nullptr), data(nullptr), built(false) {}
+
+    Player* player;
+    UpdateData* data;
+    WorldPacket packet;
+    bool built;
+};
+
+class UpdatePacketWorker : public Worker
+{
+    public:
+        UpdatePacketWorker(UpdatePacketJob* begin, UpdatePacketJob* end, MapUpdater& updater) :
+            Worker(updater), m_begin(begin), m_end(end)
+        {}
+
+        void execute() override
+        {
+            for (UpdatePacketJob* job = m_begin; job != m_end; ++job)
+                job->built = job->data->BuildPacket(job->packet);
+
+            GetWorker().update_finished();
+        }
+
+    private:
+        UpdatePacketJob* m_begin;
+        UpdatePacketJob* m_end;
+};
+
+class VisibilityCollectWorker : public Worker
+{
+    public:
+        VisibilityCollectWorker(Camera* const* cameras, VisibilityCandidates* candidates, size_t count, MapUpdater& updater) :
+            Worker(updater), m_cameras(cameras), m_candidates(candidates), m_count(count)
+        {}
+
+        void execute() override
+        {
+            for (size_t i = 0; i < m_count; ++i)
+                m_cameras[i]->CollectVisibilityCandidates(m_candidates[i], true);
+
+            GetWorker().update_finished();
+        }
+
+    private:
+        Camera* const* m_cameras;
+        VisibilityCandidates* m_candidates;
+        size_t m_count;
+};
+
 class ObjectUpdateWorker : public Worker
 {
     public:
@@ -107,4 +162,49 @@ class ObjectUpdateWorker : public Worker
         uint32 m_diff;
 };
 
+class GridPrefetchWorker : public Worker
+{
+    public:
+        GridPrefetchWorker(TerrainInfo& terrain, uint32 x, uint32 y, MapUpdater& updater) :
+            Worker(updater), m_terrain(terrain), m_x(x), m_y(y)
+        {
+            // keep the terrain while the request is queued
+            m_terrain.AddRef();
+        }
+
+        // an unreferenced terrain is not unloaded from here, that would race the world thread.
+        // it stays cached until the next unload of its map
+        ~GridPrefetchWorker() { m_terrain.Release(); }
+
+        void execute() override
+        {
+            m_terrain.Prefetch(m_x, m_y);
+            GetWorker().update_finished();
+        }
+
+    private:
+        TerrainInfo& m_terrain;
+        uint32 m_x;
+        uint32 m_y;
+};
+
+class PathSearchWorker : public Worker
+{
+    public:
+        PathSearchWorker(PathRequestPtr const& request, MapUpdater& updater) :
+            Worker(updater), m_request(request)
+        {}
+
+        // the requesting path finders are gone with their map (or have repathed), nobody waits for the result
+        void execute() override
+        {
+            if (PathRequestPtr request = m_request.lock())
+                request->Search();
+            GetWorker().update_finished();
+        }
+
+    private:
+        std::weak_ptr<PathRequest> m_request;
+};
+
 #endif //_MAP_WORKERS_H_INCLUDED
\ No newline at end of file
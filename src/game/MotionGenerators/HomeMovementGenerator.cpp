@@ -51,8 +51,10 @@ void HomeMovementGenerator<Creature>::_setTargetLocation(Creature& owner)
         owner.GetRespawnCoord(x, y, z, &o);
 
     PathFinder path(&owner);
+    path.setLongPath(true);
 
     path.calculate(x, y, z, true);
+    pathCut = (path.getPathType() & PATHFIND_SHORT) != 0;
 
     Movement::MoveSplineInit init(owner);
     init.MovebyPath(path.getPath());
@@ -69,6 +71,12 @@ void HomeMovementGenerator<Creature>::_setTargetLocation(Creature& owner)
 bool HomeMovementGenerator<Creature>::Update(Creature& owner, const uint32& /*time_diff*/)
 {
     arrived = owner.movespline->Finalized();
+    if (arrived && pathCut)
+    {
+        _setTargetLocation(owner);
+        return true;
+    }
+
     return !arrived;
 }
 
@@ -32,7 +32,7 @@ class HomeMovementGenerator<Creature>
 {
     public:
 
-        HomeMovementGenerator(bool _runHome = true) : arrived(false), runHome(_runHome), wasActive(false)
+        HomeMovementGenerator(bool _runHome = true) : arrived(false), runHome(_runHome), wasActive(false), pathCut(false)
         {
         }
 
@@ -50,5 +50,6 @@ class HomeMovementGenerator<Creature>
         bool arrived;
         bool runHome;
         bool wasActive;
+        bool pathCut;                                       // home is out of the range of one spline, move on from its end
 };
 #endif
@@ -118,15 +118,14 @@ namespace MMAP
     // ######################## MMapManager ########################
     MMapManager::~MMapManager()
     {
-        for (auto& loadedMMap : loadedMMaps)
-            delete loadedMMap.second;
-
         // by now we should not have maps loaded
         // if we had, tiles in MMapData->mmapLoadedTiles, their actual data is lost!
     }
 
     bool MMapManager::loadMapData(uint32 mapId)
     {
+        std::lock_guard<std::mutex> lock(loadedMMapsLock);
+
         // we already have this map loaded?
         if (loadedMMaps.find(mapId) != loadedMMaps.end())
             return true;
@@ -165,10 +164,7 @@ namespace MMAP
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMapData: Loaded %03i.mmap", mapId);
 
         // store inside our map list
-        MMapData* mmap_data = new MMapData(mesh);
-        mmap_data->mmapLoadedTiles.clear();
-
-        loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data));
+        loadedMMaps.insert(MMapDataSet::value_type(mapId, std::make_shared<MMapData>(mesh)));
         return true;
     }
 
@@ -177,41 +173,219 @@ namespace MMAP
         return uint32(x << 16 | y);
     }
 
-    bool MMapManager::IsMMapIsLoaded(uint32 mapId, uint32 x, uint32 y) const
+    std::shared_ptr<MMapData> MMapManager::GetMMapData(uint32 mapId)
     {
-        // get this mmap data
-        auto itr = loadedMMaps.find(mapId);
+        std::lock_guard<std::mutex> lock(loadedMMapsLock);
 
-        if (itr == loadedMMaps.end())
-            return false;
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        return itr != loadedMMaps.end() ? itr->second : std::shared_ptr<MMapData>();
+    }
 
-        auto mmap = itr->second;
+    uint32 MMapManager::getLoadedMapsCount()
+    {
+        std::lock_guard<std::mutex> lock(loadedMMapsLock);
+        return loadedMMaps.size();
+    }
+
+    bool MMapManager::IsMMapIsLoaded(uint32 mapId, uint32 x, uint32 y)
+    {
+        // get this mmap data
+        std::shared_ptr<MMapData> mmap = GetMMapData(mapId);
+        if (!mmap)
+            return false;
 
         uint32 packedGridPos = packTileID(x, y);
+
+        std::lock_guard<std::mutex> lock(mmap->lock);
         if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
             return true;
 
+        for (MMapPendingTile const& tile : mmap->pendingTiles)
+            if (tile.packedGridPos == packedGridPos)
+                return true;
+
         return false;
     }
 
     bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
+    {
+        return loadMap(mapId, x, y, nullptr, 0);
+    }
+
+    // thread local: navmesh of the query held by this thread, its tiles can not be changed until the query is returned
+    static thread_local MMapData* t_queryMMap = nullptr;
+
+    bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y, unsigned char* data, int dataSize)
     {
         // make sure the mmap is loaded and ready to load tiles
         if (!loadMapData(mapId))
+        {
+            dtFree(data);
             return false;
+        }
 
         // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
+        std::shared_ptr<MMapData> mmap = GetMMapData(mapId);
         MANGOS_ASSERT(mmap->navMesh);
 
         // check if we already have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+        if (IsMMapIsLoaded(mapId, x, y))
         {
             sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
+            dtFree(data);
+            return false;
+        }
+
+        // tile not read in advance
+        if (!data && !readTile(mapId, x, y, data, dataSize))
             return false;
+
+        // a terrain lookup of a path search loads the grid, wait until the search is done
+        if (t_queryMMap == mmap.get())
+        {
+            std::lock_guard<std::mutex> lock(mmap->lock);
+            mmap->pendingTiles.push_back({ packedGridPos, data, dataSize });
+            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Deferred mmtile %03i[%02i,%02i] until the navmesh query is returned", mapId, x, y);
+            return true;
+        }
+
+        boost::unique_lock<boost::shared_mutex> tileLock(mmap->tileLock);
+        addTile(mmap.get(), mapId, packedGridPos, data, dataSize);
+        return true;
+    }
+
+    // call with the exclusive tile lock held
+    void MMapManager::addTile(MMapData* mmap, uint32 mapId, uint32 packedGridPos, unsigned char* data, int dataSize)
+    {
+        int32 x = int32(packedGridPos >> 16);
+        int32 y = int32(packedGridPos & 0x0000FFFF);
+
+        {
+            // another instance of the map loaded it meanwhile
+            std::lock_guard<std::mutex> lock(mmap->lock);
+            if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+            {
+                dtFree(data);
+                return;
+            }
+        }
+
+        dtMeshHeader* header = (dtMeshHeader*)data;
+        dtTileRef tileRef = 0;
+
+        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
+        dtStatus dtResult = mmap->navMesh->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, &tileRef);
+        if (dtStatusFailed(dtResult))
+        {
+            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
+            dtFree(data);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mmap->lock);
+            mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+        }
+        ++loadedTiles;
+        newGeneration(mmap);
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
+    }
+
+    void MMapManager::addPendingTiles(MMapData* mmap, uint32 mapId)
+    {
+        std::vector<MMapPendingTile> pendingTiles;
+        {
+            std::lock_guard<std::mutex> lock(mmap->lock);
+            if (mmap->pendingTiles.empty())
+                return;
+            pendingTiles.swap(mmap->pendingTiles);
+        }
+
+        // the tiles count as loaded while they are added, concurrent loads of them are refused
+        boost::unique_lock<boost::shared_mutex> tileLock(mmap->tileLock);
+        for (MMapPendingTile& tile : pendingTiles)
+            addTile(mmap, mapId, tile.packedGridPos, tile.data, tile.dataSize);
+    }
+
+    // call with the exclusive tile lock held
+    void MMapManager::newGeneration(MMapData* mmap)
+    {
+        std::lock_guard<std::mutex> lock(mmap->pathCacheLock);
+        pathCacheInvalidations += mmap->pathCache.size();
+        mmap->pathCache.clear();
+        mmap->pathCacheIndex.clear();
+    }
+
+    dtStatus MMapManager::findPath(dtNavMeshQuery const* query, dtPolyRef startRef, dtPolyRef endRef, float const* startPos, float const* endPos,
+                                   dtQueryFilter const& filter, dtPolyRef* path, int* pathCount, int maxPath)
+    {
+        MMapData* mmap = t_queryMMap;
+        uint32 cacheSize = sWorld.getConfig(CONFIG_UINT32_PATH_FIND_CACHE_SIZE);
+        if (!cacheSize || !mmap || query->getAttachedNavMesh() != mmap->navMesh)
+            return query->findPath(startRef, endRef, startPos, endPos, &filter, path, pathCount, maxPath);
+
+        MMapPathKey key(startRef, endRef, (uint32(filter.getIncludeFlags()) << 16) | filter.getExcludeFlags());
+        {
+            std::lock_guard<std::mutex> lock(mmap->pathCacheLock);
+            std::map<MMapPathKey, MMapPathList::iterator>::iterator itr = mmap->pathCacheIndex.find(key);
+
+            // a corridor cut by a smaller buffer cannot fill a larger one
+            if (itr != mmap->pathCacheIndex.end() &&
+                (!dtStatusDetail(itr->second->status, DT_BUFFER_TOO_SMALL) || int(itr->second->polys.size()) >= maxPath))
+            {
+                mmap->pathCache.splice(mmap->pathCache.begin(), mmap->pathCache, itr->second);
+
+                MMapCachedPath const& cached = mmap->pathCache.front();
+                int count = std::min(int(cached.polys.size()), maxPath);
+                std::copy(cached.polys.begin(), cached.polys.begin() + count, path);
+                *pathCount = count;
+
+                ++pathCacheHits;
+                return count < int(cached.polys.size()) ? (cached.status | DT_BUFFER_TOO_SMALL) : cached.status;
+            }
+        }
+
+        ++pathCacheMisses;
+        dtStatus status = query->findPath(startRef, endRef, startPos, endPos, &filter, path, pathCount, maxPath);
+        if (dtStatusFailed(status) || !*pathCount)
+            return status;
+
+        std::lock_guard<std::mutex> lock(mmap->pathCacheLock);
+        std::map<MMapPathKey, MMapPathList::iterator>::iterator itr = mmap->pathCacheIndex.find(key);
+        if (itr != mmap->pathCacheIndex.end())
+        {
+            mmap->pathCache.erase(itr->second);
+            mmap->pathCacheIndex.erase(itr);
         }
 
+        MMapCachedPath cached;
+        cached.key = key;
+        cached.status = status;
+        cached.polys.assign(path, path + *pathCount);
+        mmap->pathCache.push_front(cached);
+        mmap->pathCacheIndex[key] = mmap->pathCache.begin();
+
+        while (mmap->pathCache.size() > cacheSize)
+        {
+            mmap->pathCacheIndex.erase(mmap->pathCache.back().key);
+            mmap->pathCache.pop_back();
+        }
+
+        return status;
+    }
+
+    MMapPathCacheStats MMapManager::getPathCacheStats() const
+    {
+        MMapPathCacheStats stats;
+        stats.hits = pathCacheHits;
+        stats.misses = pathCacheMisses;
+        stats.invalidations = pathCacheInvalidations;
+        return stats;
+    }
+
+    bool MMapManager::readTile(uint32 mapId, int32 x, int32 y, unsigned char*& data, int& dataSize)
+    {
         // load this tile :: mmaps/MMMXXYY.mmtile
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i%02i%02i.mmtile") + 1;
         char* fileName = new char[pathLen];
@@ -245,7 +419,7 @@ namespace MMAP
             return false;
         }
 
-        unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
+        data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
         MANGOS_ASSERT(data);
 
         size_t result = fread(data, fileHeader.size, 1, file);
@@ -253,51 +427,56 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
+            dtFree(data);
+            data = nullptr;
             return false;
         }
 
         fclose(file);
 
-        dtMeshHeader* header = (dtMeshHeader*)data;
-        dtTileRef tileRef = 0;
-
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        dtStatus dtResult = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
-        if (dtStatusFailed(dtResult))
-        {
-            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
-            dtFree(data);
-            return false;
-        }
-
-        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
-        ++loadedTiles;
-        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
+        dataSize = fileHeader.size;
         return true;
     }
 
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
         // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        std::shared_ptr<MMapData> mmap = GetMMapData(mapId);
+        if (!mmap)
         {
             // file may not exist, therefore not loaded
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh map. %03u%02i%02i.mmtile", mapId, x, y);
             return false;
         }
 
-        MMapData* mmap = loadedMMaps[mapId];
+        MANGOS_ASSERT(t_queryMMap != mmap.get());
 
-        // check if we have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) == mmap->mmapLoadedTiles.end())
+
+        boost::unique_lock<boost::shared_mutex> tileLock(mmap->tileLock);
+        std::lock_guard<std::mutex> lock(mmap->lock);
+
+        // tile never reached the navmesh
+        for (std::vector<MMapPendingTile>::iterator itr = mmap->pendingTiles.begin(); itr != mmap->pendingTiles.end(); ++itr)
+        {
+            if (itr->packedGridPos == packedGridPos)
+            {
+                dtFree(itr->data);
+                mmap->pendingTiles.erase(itr);
+                return true;
+            }
+        }
+
+        // check if we have this tile loaded
+        MMapTileSet::iterator itr = mmap->mmapLoadedTiles.find(packedGridPos);
+        if (itr == mmap->mmapLoadedTiles.end())
         {
             // file may not exist, therefore not loaded
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
             return false;
         }
 
-        dtTileRef tileRef = mmap->mmapLoadedTiles[packedGridPos];
+        dtTileRef tileRef = itr->second;
 
         // unload, and mark as non loaded
         dtStatus dtResult = mmap->navMesh->removeTile(tileRef, nullptr, nullptr);
@@ -311,8 +490,9 @@ namespace MMAP
         }
         else
         {
-            mmap->mmapLoadedTiles.erase(packedGridPos);
+            mmap->mmapLoadedTiles.erase(itr);
             --loadedTiles;
+            newGeneration(mmap.get());
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded mmtile %03i[%02i,%02i] from %03i", mapId, x, y, mapId);
             return true;
         }
@@ -322,15 +502,32 @@ namespace MMAP
 
     bool MMapManager::unloadMap(uint32 mapId)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        std::shared_ptr<MMapData> mmap;
         {
-            // file may not exist, therefore not loaded
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
+            std::lock_guard<std::mutex> lock(loadedMMapsLock);
+            MMapDataSet::iterator itr = loadedMMaps.find(mapId);
+            if (itr == loadedMMaps.end())
+            {
+                // file may not exist, therefore not loaded
+                DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Asked to unload not loaded navmesh map %03u", mapId);
+                return false;
+            }
+
+            mmap = itr->second;
+            loadedMMaps.erase(itr);
         }
 
+        MANGOS_ASSERT(t_queryMMap != mmap.get());
+
+        // guards taken before the erase keep the data alive, wait until their searches are done and leave them an empty navmesh
+        boost::unique_lock<boost::shared_mutex> tileLock(mmap->tileLock);
+        std::lock_guard<std::mutex> lock(mmap->lock);
+
+        for (MMapPendingTile& tile : mmap->pendingTiles)
+            dtFree(tile.data);
+        mmap->pendingTiles.clear();
+
         // unload all tiles from given map
-        MMapData* mmap = loadedMMaps[mapId];
         for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
         {
             uint32 x = (i->first >> 16);
@@ -345,70 +542,93 @@ namespace MMAP
             }
         }
 
-        delete mmap;
-        loadedMMaps.erase(mapId);
+        mmap->mmapLoadedTiles.clear();
+        newGeneration(mmap.get());
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded %03i.mmap", mapId);
 
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
+    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
-        // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-        {
-            // file may not exist, therefore not loaded
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
-        }
-
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
-            return false;
-        }
-
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
-
-        return true;
+        std::shared_ptr<MMapData> mmap = GetMMapData(mapId);
+        return mmap ? mmap->navMesh : nullptr;
     }
 
-    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
+    // ######################## NavMeshQueryGuard ########################
+    bool NavMeshQueryGuard::Acquire(uint32 mapId)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-            return nullptr;
+        Release();
 
-        return loadedMMaps[mapId]->navMesh;
-    }
+        MMapManager* manager = MMapFactory::createOrGetMMapManager();
+        std::shared_ptr<MMapData> mmap = manager->GetMMapData(mapId);
+        if (!mmap)
+            return false;
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
-    {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-            return nullptr;
+        // the shared lock is not taken twice by one thread, a waiting tile change would block the second lock
+        m_outerMMap = t_queryMMap;
+        if (m_outerMMap != mmap.get())
+            mmap->tileLock.lock_shared();
+
+        dtNavMeshQuery* query = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mmap->lock);
+            if (!mmap->freeQueries.empty())
+            {
+                query = mmap->freeQueries.back();
+                mmap->freeQueries.pop_back();
+            }
+        }
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        if (!query)
         {
             // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
+            query = dtAllocNavMeshQuery();
             MANGOS_ASSERT(query);
             dtStatus dtResult = query->init(mmap->navMesh, 1024);
             if (dtStatusFailed(dtResult))
             {
                 dtFreeNavMeshQuery(query);
-                sLog.outError("MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-                return nullptr;
+                if (m_outerMMap != mmap.get())
+                    mmap->tileLock.unlock_shared();
+                sLog.outError("MMAP:NavMeshQueryGuard: Failed to initialize dtNavMeshQuery for mapId %03u", mapId);
+                return false;
             }
 
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
+            std::lock_guard<std::mutex> lock(mmap->lock);
+            ++mmap->queryCount;
+            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:NavMeshQueryGuard: created dtNavMeshQuery %u for mapId %03u", mmap->queryCount, mapId);
+        }
+
+        m_mapId = mapId;
+        m_mmap = mmap;
+        m_query = query;
+        t_queryMMap = mmap.get();
+        return true;
+    }
+
+    void NavMeshQueryGuard::Release()
+    {
+        if (!m_query)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mmap->lock);
+            m_mmap->freeQueries.push_back(m_query);
+        }
+
+        t_queryMMap = m_outerMMap;
+        if (m_outerMMap != m_mmap.get())
+        {
+            m_mmap->tileLock.unlock_shared();
+
+            // tiles loaded by this thread while it was searching
+            MMapFactory::createOrGetMMapManager()->addPendingTiles(m_mmap.get(), m_mapId);
         }
 
-        return mmap->navMeshQueries[instanceId];
+        // frees the data when the map was unloaded meanwhile
+        m_mmap.reset();
+        m_query = nullptr;
+        m_outerMMap = nullptr;
     }
 }
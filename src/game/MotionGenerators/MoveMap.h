@@ -24,6 +24,16 @@
 #include <Detour/Include/DetourNavMesh.h>
 #include <Detour/Include/DetourNavMeshQuery.h>
 
+#include <boost/thread/shared_mutex.hpp>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
 class Unit;
 
 //  memory management
@@ -41,16 +51,39 @@ inline void dtCustomFree(void* ptr)
 namespace MMAP
 {
     typedef std::unordered_map<uint32, dtTileRef> MMapTileSet;
-    typedef std::unordered_map<uint32, dtNavMeshQuery*> NavMeshQuerySet;
 
-    // dummy struct to hold map's mmap data
+    // tile read by a thread which was using a query of the same navmesh, added after the query is returned
+    struct MMapPendingTile
+    {
+        uint32 packedGridPos;
+        unsigned char* data;
+        int dataSize;
+    };
+
+    // start poly, end poly, filter include and exclude flags
+    typedef std::tuple<dtPolyRef, dtPolyRef, uint32> MMapPathKey;
+
+    // corridor found by findPath between two polygons
+    struct MMapCachedPath
+    {
+        MMapPathKey key;
+        dtStatus status;
+        std::vector<dtPolyRef> polys;
+    };
+
+    typedef std::list<MMapCachedPath> MMapPathList;
+
+    // dummy struct to hold map's mmap data, kept alive by the NavMeshQueryGuards using it after the map is unloaded
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh) : navMesh(mesh), queryCount(0) {}
         ~MMapData()
         {
-            for (auto& navMeshQuerie : navMeshQueries)
-                dtFreeNavMeshQuery(navMeshQuerie.second);
+            for (dtNavMeshQuery* query : freeQueries)
+                dtFreeNavMeshQuery(query);
+
+            for (MMapPendingTile& tile : pendingTiles)
+                dtFree(tile.data);
 
             if (navMesh)
                 dtFreeNavMesh(navMesh);
@@ -58,39 +91,108 @@ namespace MMAP
 
         dtNavMesh* navMesh;
 
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
+        // held shared while a query is in use, tiles are only added and removed under the exclusive lock
+        boost::shared_mutex tileLock;
+
+        // guards the members below
+        std::mutex lock;
+
+        // dtNavMeshQuery keeps per search state, every thread using the navmesh takes its own from the pool
+        std::vector<dtNavMeshQuery*> freeQueries;
+        uint32 queryCount;
+
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+        std::vector<MMapPendingTile> pendingTiles;
+
+        // corridors of recent searches, most recently used first. they belong to one generation of
+        // the navmesh, every tile change starts a new one (under the exclusive tile lock) and drops them
+        std::mutex pathCacheLock;
+        MMapPathList pathCache;
+        std::map<MMapPathKey, MMapPathList::iterator> pathCacheIndex;
     };
 
-    typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
+    struct MMapPathCacheStats
+    {
+        uint64 hits;
+        uint64 misses;
+        uint64 invalidations;                                   // cached corridors dropped by tile changes
+    };
+
+    typedef std::unordered_map<uint32, std::shared_ptr<MMapData> > MMapDataSet;
 
     // singelton class
     // holds all all access to mmap loading unloading and meshes
     class MMapManager
     {
+            friend class NavMeshQueryGuard;
+
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), pathCacheHits(0), pathCacheMisses(0), pathCacheInvalidations(0) {}
             ~MMapManager();
 
             bool loadMap(uint32 mapId, int32 x, int32 y);
+            // adds a tile read before by readTile, the data is owned by the navmesh (or freed) afterwards
+            bool loadMap(uint32 mapId, int32 x, int32 y, unsigned char* data, int dataSize);
+            // tiles and maps must not be unloaded by a thread holding a NavMeshQueryGuard of the same map
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
-            bool IsMMapIsLoaded(uint32 mapId, uint32 x, uint32 y) const;
+            bool IsMMapIsLoaded(uint32 mapId, uint32 x, uint32 y);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
+            // only for checks and navmesh parameters, tiles must be read through a NavMeshQueryGuard
             dtNavMesh const* GetNavMesh(uint32 mapId);
 
+            // reads a mmtile file into dtAlloc'd memory, only touches the disk so any thread may call it
+            static bool readTile(uint32 mapId, int32 x, int32 y, unsigned char*& data, int& dataSize);
+
             uint32 getLoadedTilesCount() const { return loadedTiles; }
-            uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
+            uint32 getLoadedMapsCount();
+
+            // findPath of a query held by this thread, answered from the corridor cache of its navmesh when possible.
+            // the corridor only depends on the polygons, the points are used by the search only
+            dtStatus findPath(dtNavMeshQuery const* query, dtPolyRef startRef, dtPolyRef endRef, float const* startPos, float const* endPos,
+                              dtQueryFilter const& filter, dtPolyRef* path, int* pathCount, int maxPath);
+            MMapPathCacheStats getPathCacheStats() const;
         private:
             bool loadMapData(uint32 mapId);
+            std::shared_ptr<MMapData> GetMMapData(uint32 mapId);
+            void addTile(MMapData* mmap, uint32 mapId, uint32 packedGridPos, unsigned char* data, int dataSize);
+            void addPendingTiles(MMapData* mmap, uint32 mapId);
+            void newGeneration(MMapData* mmap);
             uint32 packTileID(int32 x, int32 y) const;
 
+            std::mutex loadedMMapsLock;
             MMapDataSet loadedMMaps;
-            uint32 loadedTiles;
+            std::atomic<uint32> loadedTiles;
+
+            std::atomic<uint64> pathCacheHits;
+            std::atomic<uint64> pathCacheMisses;
+            std::atomic<uint64> pathCacheInvalidations;
+    };
+
+    // takes a query from the pool of a map's navmesh and keeps the navmesh tiles unchanged while it is held.
+    // any thread may use a navmesh this way, each with its own query
+    class NavMeshQueryGuard
+    {
+        public:
+            NavMeshQueryGuard() : m_mapId(0), m_query(nullptr), m_outerMMap(nullptr) {}
+            explicit NavMeshQueryGuard(uint32 mapId) : NavMeshQueryGuard() { Acquire(mapId); }
+            ~NavMeshQueryGuard() { Release(); }
+
+            NavMeshQueryGuard(NavMeshQueryGuard const&) = delete;
+            NavMeshQueryGuard& operator=(NavMeshQueryGuard const&) = delete;
+
+            // false if the map has no navmesh
+            bool Acquire(uint32 mapId);
+            void Release();
+
+            dtNavMesh const* GetNavMesh() const { return m_query ? m_mmap->navMesh : nullptr; }
+            dtNavMeshQuery const* GetNavMeshQuery() const { return m_query; }
+
+        private:
+            uint32 m_mapId;
+            std::shared_ptr<MMapData> m_mmap;
+            dtNavMeshQuery* m_query;
+            MMapData* m_outerMMap;
     };
 
     // static class
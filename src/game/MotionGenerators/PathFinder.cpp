@@ -22,26 +22,23 @@
 #include "MotionGenerators/PathFinder.h"
 #include "Log.h"
 #include "World/World.h"
+#include "Maps/MapManager.h"
 
 #include <Detour/Include/DetourCommon.h>
 #include <Detour/Include/DetourMath.h>
 
+#include <queue>
+#include <unordered_map>
+
 ////////////////// PathFinder //////////////////
 PathFinder::PathFinder(Unit const* owner) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH), // TODO: Fix legitimate long paths
-    m_sourceUnit(owner), m_navMesh(nullptr), m_navMeshQuery(nullptr)
+    m_async(false), m_longPath(false), m_replacedSearches(0), m_pendingIncomplete(false),
+    m_sourceUnit(owner), m_useNavMesh(MMAP::MMapFactory::IsPathfindingEnabled(owner->GetMapId(), owner)), m_navMesh(nullptr), m_navMeshQuery(nullptr)
 {
     DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
 
-    uint32 mapId = m_sourceUnit->GetMapId();
-    if (MMAP::MMapFactory::IsPathfindingEnabled(mapId, owner))
-    {
-        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        m_navMesh = mmap->GetNavMesh(mapId);
-        m_navMeshQuery = mmap->GetNavMeshQuery(mapId, m_sourceUnit->GetInstanceId());
-    }
-
     createFilter();
 }
 
@@ -60,6 +57,19 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
 bool PathFinder::calculate(const Vector3& start, const Vector3& dest, bool forceDest/* = false*/)
 {
+    if (m_pendingRequest)
+    {
+        // the destination barely moved, wait for the running search instead of starting over
+        if (forceDest == m_forceDestination && (dest - m_endPosition).squaredLength() < PENDING_PATH_DEST_SLOP * PENDING_PATH_DEST_SLOP)
+        {
+            setStartPosition(start);
+            return false;
+        }
+
+        ++m_replacedSearches;
+        CancelPendingPath();
+    }
+
     if (!MaNGOS::IsValidMapCoord(dest.x, dest.y, dest.z))
         return false;
 
@@ -74,6 +84,14 @@ bool PathFinder::calculate(const Vector3& start, const Vector3& dest, bool force
 
     DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
 
+    // query from the navmesh pool, the navmesh tiles stay as they are until it is returned
+    MMAP::NavMeshQueryGuard navMeshGuard;
+    if (m_useNavMesh)
+        navMeshGuard.Acquire(m_sourceUnit->GetMapId());
+
+    m_navMesh = navMeshGuard.GetNavMesh();
+    m_navMeshQuery = navMeshGuard.GetNavMeshQuery();
+
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
     if (!m_navMesh || !m_navMeshQuery || m_sourceUnit->hasUnitState(UNIT_STAT_IGNORE_PATHFINDING) ||
@@ -81,12 +99,16 @@ bool PathFinder::calculate(const Vector3& start, const Vector3& dest, bool force
     {
         BuildShortcut();
         m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
-        return true;
     }
+    else
+    {
+        updateFilter();
 
-    updateFilter();
+        BuildPolyPath(start, dest);
+    }
 
-    BuildPolyPath(start, dest);
+    m_navMesh = nullptr;
+    m_navMeshQuery = nullptr;
     return true;
 }
 
@@ -255,6 +277,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
     bool endPolyFound = false;
     uint32 pathStartIndex = 0;
     uint32 pathEndIndex = 0;
+    bool polyPathTruncated = false;     // the route goes on after the last poly of the buffer
 
     if (m_polyLength)
     {
@@ -338,12 +361,12 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
 
         // generate suffix
         uint32 suffixPolyLength = 0;
-        dtResult = m_navMeshQuery->findPath(
+        dtResult = MMAP::MMapFactory::createOrGetMMapManager()->findPath(m_navMeshQuery,
                        suffixStartPoly,    // start polygon
                        endPoly,            // end polygon
                        suffixEndPoint,     // start position
                        endPoint,           // end position
-                       &m_filter,            // polygon search filter
+                       m_filter,           // polygon search filter
                        m_pathPolyRefs + prefixPolyLength - 1,    // [out] path
                        (int*)&suffixPolyLength,
                        MAX_PATH_LENGTH - prefixPolyLength); // max number of polygons in output path
@@ -358,6 +381,8 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
 
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", m_polyLength, prefixPolyLength, suffixPolyLength);
 
+        polyPathTruncated = dtStatusDetail(dtResult, DT_BUFFER_TOO_SMALL | DT_OUT_OF_NODES);
+
         // new path = prefix + suffix - overlap
         m_polyLength = prefixPolyLength + suffixPolyLength - 1;
     }
@@ -369,15 +394,36 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         // or something went really wrong -> we aren't moving along the path to the target
         // just generate new path
 
+        // the search threads generate it, the old path is kept until it is done.
+        // a destination moving on faster than the searches are done is searched here
+        if (m_async && !m_longPath && m_replacedSearches < MAX_REPLACED_SEARCHES && sMapMgr.IsPathSearchEnabled())
+        {
+            PathRequestPtr request(new PathRequest);
+            request->mapId = m_sourceUnit->GetMapId();
+            request->startPoly = startPoly;
+            request->endPoly = endPoly;
+            dtVcopy(request->startPoint, startPoint);
+            dtVcopy(request->endPoint, endPoint);
+            request->filter = m_filter;
+            request->useStraightPath = m_useStraightPath;
+            request->pointPathLimit = m_pointPathLimit;
+
+            m_pendingRequest = sMapMgr.RequestPath(request);
+            m_pendingIncomplete = (m_type & PATHFIND_INCOMPLETE) != 0;
+            return;
+        }
+
+        m_replacedSearches = 0;
+
         // free and invalidate old path data
         clear();
 
-        dtResult = m_navMeshQuery->findPath(
+        dtResult = MMAP::MMapFactory::createOrGetMMapManager()->findPath(m_navMeshQuery,
                        startPoly,          // start polygon
                        endPoly,            // end polygon
                        startPoint,         // start position
                        endPoint,           // end position
-                       &m_filter,           // polygon search filter
+                       m_filter,           // polygon search filter
                        m_pathPolyRefs,     // [out] path
                        (int*)&m_polyLength,
                        MAX_PATH_LENGTH);   // max number of polygons in output path
@@ -390,6 +436,8 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
             m_type = PATHFIND_NOPATH;
             return;
         }
+
+        polyPathTruncated = dtStatusDetail(dtResult, DT_BUFFER_TOO_SMALL | DT_OUT_OF_NODES);
     }
 
     // by now we know what type of path we can get
@@ -399,40 +447,374 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         m_type = PATHFIND_INCOMPLETE;
 
     // generate the point-path out of our up-to-date poly-path
-    BuildPointPath(startPoint, endPoint);
+    if (!m_longPath || !polyPathTruncated)
+        BuildPointPath(startPoint, endPoint);
+
+    // the route does not fit the poly or point buffers, plan it over the navmesh tiles instead
+    if (m_longPath && (polyPathTruncated || m_type == PATHFIND_SHORT))
+        BuildLongPath(startPoly, endPoly, startPoint, endPoint, farFromPoly);
 }
 
-void PathFinder::BuildPointPath(const float* startPoint, const float* endPoint)
+void PathFinder::BuildLongPath(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint, bool farFromPoly)
 {
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::BuildLongPath for %u\n", m_sourceUnit->GetGUIDLow());
+
+    // legs end at the tile crossings of the route and at the destination
+    std::vector<float> waypoints;
+    FindTileRoute(startPoly, endPoly, startPoint, endPoint, waypoints);
+    waypoints.insert(waypoints.end(), endPoint, endPoint + VERTEX_SIZE);
+
+    // the poly corridor is not kept, the next calculate searches from scratch
+    clear();
+    m_pathPoints.push_back(getStartPosition());
+
+    dtPolyRef polys[MAX_PATH_LENGTH];
+    float corners[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
+    dtPolyRef cornerPolys[MAX_POINT_PATH_LENGTH];
+
+    dtPolyRef curPoly = startPoly;
+    float curPoint[VERTEX_SIZE];
+    dtVcopy(curPoint, startPoint);
+
+    bool complete = true;
+    for (size_t leg = 0; complete && leg < waypoints.size(); leg += VERTEX_SIZE)
+    {
+        float targetPoint[VERTEX_SIZE];
+        dtPolyRef targetPoly = endPoly;
+        if (leg + VERTEX_SIZE == waypoints.size())
+            dtVcopy(targetPoint, endPoint);
+        else
+        {
+            float extents[VERTEX_SIZE] = {3.0f, 5.0f, 3.0f};
+            if (dtStatusFailed(m_navMeshQuery->findNearestPoly(&waypoints[leg], extents, &m_filter, &targetPoly, targetPoint)) || targetPoly == INVALID_POLYREF)
+                continue;                               // the next leg searches past this crossing
+        }
+
+        for (uint32 step = 0; curPoly != targetPoly; ++step)
+        {
+            uint32 polyCount = 0;
+            dtStatus dtResult = MMAP::MMapFactory::createOrGetMMapManager()->findPath(m_navMeshQuery, curPoly, targetPoly, curPoint, targetPoint,
+                                                                                      m_filter, polys, (int*)&polyCount, MAX_PATH_LENGTH);
+            if (step == MAX_LONG_PATH_STEPS || !polyCount || dtStatusFailed(dtResult))
+            {
+                complete = false;
+                break;
+            }
+
+            float legEnd[VERTEX_SIZE];
+            if (polys[polyCount - 1] == targetPoly)
+                dtVcopy(legEnd, targetPoint);
+            else if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(polys[polyCount - 1], targetPoint, legEnd, nullptr)))
+            {
+                complete = false;
+                break;
+            }
+
+            uint32 cornerCount = 0;
+            dtResult = m_navMeshQuery->findStraightPath(curPoint, legEnd, polys, polyCount, corners, nullptr, cornerPolys, (int*)&cornerCount, MAX_POINT_PATH_LENGTH);
+            if (cornerCount < 2 || dtStatusFailed(dtResult) || m_pathPoints.size() + cornerCount - 1 > MAX_LONG_PATH_POINTS)
+            {
+                complete = false;
+                break;
+            }
+
+            for (uint32 i = 1; i < cornerCount; ++i)
+            {
+                float const* corner = &corners[i * VERTEX_SIZE];
+                m_pathPoints.push_back(Vector3(corner[2], corner[0], corner[1]));
+            }
+
+            // the end point of a straight path has no poly, all others do
+            dtPolyRef lastPoly = dtStatusDetail(dtResult, DT_BUFFER_TOO_SMALL) ? cornerPolys[cornerCount - 1] : polys[polyCount - 1];
+            if (lastPoly == curPoly)
+            {
+                complete = false;
+                break;
+            }
+
+            curPoly = lastPoly;
+            dtVcopy(curPoint, &corners[(cornerCount - 1) * VERTEX_SIZE]);
+        }
+    }
+
+    if (m_pathPoints.size() < 2)
+    {
+        BuildShortcut();
+        m_type = PATHFIND_NOPATH;
+        return;
+    }
+
+    m_type = complete && curPoly == endPoly && !farFromPoly ? PATHFIND_NORMAL : PATHFIND_INCOMPLETE;
+
+    NormalizePath();
+
+    // the rest of the route is walked by the next path, the destination is not forced past the cut
+    if (CutToSplineRange())
+    {
+        m_type = PathType(PATHFIND_INCOMPLETE | PATHFIND_SHORT);
+        setActualEndPosition(m_pathPoints.back());
+        DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::BuildLongPath cut to size " SIZEFMTD "\n", m_pathPoints.size());
+        return;
+    }
+
+    setActualEndPosition(m_pathPoints.back());
+
+    if (m_forceDestination && !(m_type & PATHFIND_NORMAL))
+    {
+        setActualEndPosition(getEndPosition());
+        m_pathPoints.push_back(getEndPosition());
+        m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+    }
+
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::BuildLongPath path type %d size " SIZEFMTD "\n", m_type, m_pathPoints.size());
+}
+
+// A* over the loaded tiles, two tiles are connected where a polygon of one links to the other.
+// portals gets the crossing points of the route, without the start and end tile, bounded by the number of tiles
+bool PathFinder::FindTileRoute(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint, std::vector<float>& portals) const
+{
+    struct Crossing
+    {
+        float through;                      // length of the way from the tile entry over the crossing to the destination
+        float point[VERTEX_SIZE];
+    };
+
+    struct RouteNode
+    {
+        float point[VERTEX_SIZE];           // where the route enters the tile
+        float cost;
+        uint32 parent;
+        bool closed;
+    };
+
+    auto tileKey = [](dtMeshTile const* tile) { return (uint32(tile->header->x) << 16) | uint32(tile->header->y); };
+
+    dtMeshTile const* tile;
+    dtPoly const* poly;
+    m_navMesh->getTileAndPolyByRefUnsafe(endPoly, &tile, &poly);
+    uint32 endKey = tileKey(tile);
+    m_navMesh->getTileAndPolyByRefUnsafe(startPoly, &tile, &poly);
+    uint32 startKey = tileKey(tile);
+
+    std::unordered_map<uint32, RouteNode> nodes;
+    typedef std::pair<float, uint32> OpenEntry;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > open;
+
+    RouteNode& start = nodes[startKey];
+    dtVcopy(start.point, startPoint);
+    start.cost = 0.0f;
+    start.parent = startKey;
+    start.closed = false;
+    open.push(OpenEntry(dtVdist(startPoint, endPoint), startKey));
+
+    // nearest tile to the destination, the route gets there if the destination tile cannot be reached
+    uint32 bestKey = startKey;
+    float bestDist = dtVdist(startPoint, endPoint);
+
+    while (!open.empty())
+    {
+        uint32 key = open.top().second;
+        open.pop();
+
+        RouteNode& node = nodes[key];
+        if (node.closed)
+            continue;
+
+        node.closed = true;
+        if (key == endKey)
+        {
+            bestKey = key;
+            break;
+        }
+
+        float dist = dtVdist(node.point, endPoint);
+        if (dist < bestDist)
+        {
+            bestDist = dist;
+            bestKey = key;
+        }
+
+        tile = m_navMesh->getTileAt(int32(key >> 16), int32(key & 0xFFFF), 0);
+        if (!tile || !tile->header)
+            continue;
+
+        // best crossing to each neighbour tile, the one closest to the path through it
+        std::unordered_map<uint32, Crossing> crossings;
+        dtPolyRef base = m_navMesh->getPolyRefBase(tile);
+        for (int32 i = 0; i < tile->header->polyCount; ++i)
+        {
+            poly = &tile->polys[i];
+            if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION || !m_filter.passFilter(base | dtPolyRef(i), tile, poly))
+                continue;
+
+            for (uint32 k = poly->firstLink; k != DT_NULL_LINK; k = tile->links[k].next)
+            {
+                dtLink const& link = tile->links[k];
+                if (link.side == 0xff)
+                    continue;
+
+                dtMeshTile const* neighbourTile;
+                dtPoly const* neighbourPoly;
+                m_navMesh->getTileAndPolyByRefUnsafe(link.ref, &neighbourTile, &neighbourPoly);
+                if (!m_filter.passFilter(link.ref, neighbourTile, neighbourPoly))
+                    continue;
+
+                float const* v0 = &tile->verts[poly->verts[link.edge] * VERTEX_SIZE];
+                float const* v1 = &tile->verts[poly->verts[(link.edge + 1) % poly->vertCount] * VERTEX_SIZE];
+                Crossing crossing;
+                dtVlerp(crossing.point, v0, v1, 0.5f);
+                crossing.through = dtVdist(node.point, crossing.point) + dtVdist(crossing.point, endPoint);
+
+                auto itr = crossings.find(tileKey(neighbourTile));
+                if (itr == crossings.end())
+                    crossings.insert(std::make_pair(tileKey(neighbourTile), crossing));
+                else if (crossing.through < itr->second.through)
+                    itr->second = crossing;
+            }
+        }
+
+        for (auto const& crossing : crossings)
+        {
+            float const* point = crossing.second.point;
+            float cost = node.cost + dtVdist(node.point, point);
+
+            auto itr = nodes.find(crossing.first);
+            if (itr != nodes.end() && (itr->second.closed || itr->second.cost <= cost))
+                continue;
+
+            RouteNode& neighbour = nodes[crossing.first];
+            dtVcopy(neighbour.point, point);
+            neighbour.cost = cost;
+            neighbour.parent = key;
+            neighbour.closed = false;
+            open.push(OpenEntry(cost + dtVdist(point, endPoint), crossing.first));
+        }
+    }
+
+    // walk back from the last tile, the start tile has no crossing
+    std::vector<uint32> route;
+    for (uint32 key = bestKey; key != startKey; key = nodes[key].parent)
+        route.push_back(key);
+
+    portals.clear();
+    portals.reserve(route.size() * VERTEX_SIZE);
+    for (auto itr = route.rbegin(); itr != route.rend(); ++itr)
+        portals.insert(portals.end(), nodes[*itr].point, nodes[*itr].point + VERTEX_SIZE);
+
+    return bestKey == endKey;
+}
+
+bool PathFinder::UpdatePendingPath()
+{
+    if (!m_pendingRequest || !m_pendingRequest->ready)
+        return false;
+
+    PathRequestPtr request;
+    request.swap(m_pendingRequest);
+    m_replacedSearches = 0;
+
+    if (!request->polyLength || dtStatusFailed(request->pathStatus))
+    {
+        // only happens if we passed bad data to findPath(), or navmesh is messed up (or the tiles were reloaded meanwhile)
+        sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+        BuildShortcut();
+        m_type = PATHFIND_NOPATH;
+        return true;
+    }
+
+    m_polyLength = request->polyLength;
+    memcpy(m_pathPolyRefs, request->polyRefs, m_polyLength * sizeof(dtPolyRef));
+
+    bool reachedEndPoly = m_pathPolyRefs[m_polyLength - 1] == request->endPoly;
+    m_type = reachedEndPoly && !m_pendingIncomplete ? PATHFIND_NORMAL : PATHFIND_INCOMPLETE;
+
     float pathPoints[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
-    uint32 pointCount = 0;
-    dtStatus dtResult;
+    uint32 pointCount = request->pointCount;
+    memcpy(pathPoints, request->points, pointCount * VERTEX_SIZE * sizeof(float));
 
-    if (m_useStraightPath)
+    // a shared search may have started and ended elsewhere on the same polygons
+    if (pointCount >= 2)
     {
-        dtResult = m_navMeshQuery->findStraightPath(
-                       startPoint,         // start position
-                       endPoint,           // end position
-                       m_pathPolyRefs,     // current path
-                       m_polyLength,       // lenth of current path
-                       pathPoints,         // [out] path corner points
-                       nullptr,               // [out] flags
-                       nullptr,               // [out] shortened path
-                       (int*)&pointCount,
-                       m_pointPathLimit);   // maximum number of points/polygons to use
+        float* startPoint = pathPoints;
+        startPoint[0] = m_startPosition.y;
+        startPoint[1] = m_startPosition.z;
+        startPoint[2] = m_startPosition.x;
+        if (reachedEndPoly)
+        {
+            float* endPoint = pathPoints + (pointCount - 1) * VERTEX_SIZE;
+            endPoint[0] = m_actualEndPosition.y;
+            endPoint[1] = m_actualEndPosition.z;
+            endPoint[2] = m_actualEndPosition.x;
+        }
     }
-    else
+
+    ApplyPointPath(pathPoints, pointCount, request->pointStatus);
+    return true;
+}
+
+void PathRequest::Search()
+{
+    sMapMgr.AddPathSearchWait(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queueTime).count());
+
+    // fails once the terrain of the map is unloaded, the guard keeps the navmesh alive otherwise
+    MMAP::NavMeshQueryGuard navMeshGuard;
+    if (navMeshGuard.Acquire(mapId))
     {
-        dtResult = findSmoothPath(
-                       startPoint,         // start position
-                       endPoint,           // end position
-                       m_pathPolyRefs,     // current path
-                       m_polyLength,       // length of current path
-                       pathPoints,         // [out] path corner points
-                       (int*)&pointCount,
-                       m_pointPathLimit);    // maximum number of points
+        dtNavMeshQuery const* navMeshQuery = navMeshGuard.GetNavMeshQuery();
+        pathStatus = MMAP::MMapFactory::createOrGetMMapManager()->findPath(navMeshQuery, startPoly, endPoly, startPoint, endPoint,
+                                                                           filter, polyRefs, (int*)&polyLength, MAX_PATH_LENGTH);
+
+        if (polyLength && dtStatusSucceed(pathStatus))
+            pointStatus = PathFinder::FindPointPath(navMeshGuard.GetNavMesh(), navMeshQuery, filter, startPoint, endPoint,
+                                                    polyRefs, polyLength, useStraightPath, pointPathLimit, points, pointCount);
+    }
+
+    ready = true;
+}
+
+void PathFinder::BuildPointPath(const float* startPoint, const float* endPoint)
+{
+    float pathPoints[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
+    uint32 pointCount = 0;
+    dtStatus dtResult = FindPointPath(m_navMesh, m_navMeshQuery, m_filter, startPoint, endPoint,
+                                      m_pathPolyRefs, m_polyLength, m_useStraightPath, m_pointPathLimit, pathPoints, pointCount);
+
+    ApplyPointPath(pathPoints, pointCount, dtResult);
+}
+
+dtStatus PathFinder::FindPointPath(dtNavMesh const* navMesh, dtNavMeshQuery const* navMeshQuery, dtQueryFilter const& filter,
+                                   const float* startPoint, const float* endPoint, const dtPolyRef* polyPath, uint32 polyPathSize,
+                                   bool useStraightPath, uint32 maxPointCount, float* pathPoints, uint32& pointCount)
+{
+    if (useStraightPath)
+    {
+        return navMeshQuery->findStraightPath(
+                   startPoint,         // start position
+                   endPoint,           // end position
+                   polyPath,           // current path
+                   polyPathSize,       // lenth of current path
+                   pathPoints,         // [out] path corner points
+                   nullptr,               // [out] flags
+                   nullptr,               // [out] shortened path
+                   (int*)&pointCount,
+                   maxPointCount);     // maximum number of points/polygons to use
     }
 
+    return findSmoothPath(
+               navMesh,
+               navMeshQuery,
+               filter,
+               startPoint,         // start position
+               endPoint,           // end position
+               polyPath,           // current path
+               polyPathSize,       // length of current path
+               pathPoints,         // [out] path corner points
+               (int*)&pointCount,
+               maxPointCount);     // maximum number of points
+}
+
+void PathFinder::ApplyPointPath(float* pathPoints, uint32 pointCount, dtStatus dtResult)
+{
     if (pointCount < 2 || dtStatusFailed(dtResult))
     {
         // only happens if pass bad data to findStraightPath or navmesh is broken
@@ -562,6 +944,45 @@ void PathFinder::NormalizePath()
         m_sourceUnit->UpdateAllowedPositionZ(m_pathPoint.x, m_pathPoint.y, m_pathPoint.z);
 }
 
+// the middle points of a linear spline are sent packed relative to the middle of its first and last point,
+// in quarter yards of 11 bits for x and y and 10 bits for z. cuts the path at the farthest point keeping them in range
+bool PathFinder::CutToSplineRange()
+{
+    if (m_pathPoints.size() <= 2)
+        return false;
+
+    float const maxOffsetXY = 255.0f;
+    float const maxOffsetZ = 127.0f;
+
+    Vector3 const& start = m_pathPoints[0];
+    Vector3 low = m_pathPoints[1];                          // bounds of the points between start and end
+    Vector3 high = m_pathPoints[1];
+    size_t end = 1;
+
+    for (size_t i = 2; i < m_pathPoints.size(); ++i)
+    {
+        Vector3 const& point = m_pathPoints[i];
+        Vector3 middle = (start + point) / 2.0f;
+        if (middle.x - low.x <= maxOffsetXY && high.x - middle.x <= maxOffsetXY &&
+            middle.y - low.y <= maxOffsetXY && high.y - middle.y <= maxOffsetXY &&
+            middle.z - low.z <= maxOffsetZ && high.z - middle.z <= maxOffsetZ)
+            end = i;
+
+        low.x = std::min(low.x, point.x);
+        low.y = std::min(low.y, point.y);
+        low.z = std::min(low.z, point.z);
+        high.x = std::max(high.x, point.x);
+        high.y = std::max(high.y, point.y);
+        high.z = std::max(high.z, point.z);
+    }
+
+    if (end + 1 == m_pathPoints.size())
+        return false;
+
+    m_pathPoints.resize(end + 1);
+    return true;
+}
+
 void PathFinder::BuildShortcut()
 {
     DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::BuildShortcut :: making shortcut\n");
@@ -703,9 +1124,9 @@ uint32 PathFinder::fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath,
     return req + size;
 }
 
-bool PathFinder::getSteerTarget(const float* startPos, const float* endPos,
+bool PathFinder::getSteerTarget(dtNavMeshQuery const* navMeshQuery, const float* startPos, const float* endPos,
                                 float minTargetDist, const dtPolyRef* path, uint32 pathSize,
-                                float* steerPos, unsigned char& steerPosFlag, dtPolyRef& steerPosRef) const
+                                float* steerPos, unsigned char& steerPosFlag, dtPolyRef& steerPosRef)
 {
     // Find steer target.
     static const uint32 MAX_STEER_POINTS = 3;
@@ -713,7 +1134,7 @@ bool PathFinder::getSteerTarget(const float* startPos, const float* endPos,
     unsigned char steerPathFlags[MAX_STEER_POINTS];
     dtPolyRef steerPathPolys[MAX_STEER_POINTS];
     uint32 nsteerPath = 0;
-    dtStatus dtResult = m_navMeshQuery->findStraightPath(startPos, endPos, path, pathSize,
+    dtStatus dtResult = navMeshQuery->findStraightPath(startPos, endPos, path, pathSize,
                         steerPath, steerPathFlags, steerPathPolys, (int*)&nsteerPath, MAX_STEER_POINTS);
     if (!nsteerPath || dtStatusFailed(dtResult))
         return false;
@@ -740,7 +1161,8 @@ bool PathFinder::getSteerTarget(const float* startPos, const float* endPos,
     return true;
 }
 
-dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
+dtStatus PathFinder::findSmoothPath(dtNavMesh const* navMesh, dtNavMeshQuery const* navMeshQuery, dtQueryFilter const& filter,
+                                    const float* startPos, const float* endPos,
                                     const dtPolyRef* polyPath, uint32 polyPathSize,
                                     float* smoothPath, int* smoothPathSize, uint32 maxSmoothPathSize)
 {
@@ -752,11 +1174,11 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
     uint32 npolys = polyPathSize;
 
     float iterPos[VERTEX_SIZE];
-    if (dtStatusFailed(m_navMeshQuery->closestPointOnPolyBoundary(polys[0], startPos, iterPos)))
+    if (dtStatusFailed(navMeshQuery->closestPointOnPolyBoundary(polys[0], startPos, iterPos)))
         return DT_FAILURE;
 
     float targetPos[VERTEX_SIZE];
-    if (dtStatusFailed(m_navMeshQuery->closestPointOnPolyBoundary(polys[npolys - 1], endPos, targetPos)))
+    if (dtStatusFailed(navMeshQuery->closestPointOnPolyBoundary(polys[npolys - 1], endPos, targetPos)))
         return DT_FAILURE;
 
     dtVcopy(&smoothPath[nsmoothPath * VERTEX_SIZE], iterPos);
@@ -771,7 +1193,7 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
         unsigned char steerPosFlag;
         dtPolyRef steerPosRef = INVALID_POLYREF;
 
-        if (!getSteerTarget(iterPos, targetPos, SMOOTH_PATH_SLOP, polys, npolys, steerPos, steerPosFlag, steerPosRef))
+        if (!getSteerTarget(navMeshQuery, iterPos, targetPos, SMOOTH_PATH_SLOP, polys, npolys, steerPos, steerPosFlag, steerPosRef))
             break;
 
         const bool endOfPath = (steerPosFlag & DT_STRAIGHTPATH_END) != 0;
@@ -796,10 +1218,10 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
         dtPolyRef visited[MAX_VISIT_POLY];
 
         uint32 nvisited = 0;
-        m_navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &m_filter, result, visited, (int*)&nvisited, MAX_VISIT_POLY);
+        navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter, result, visited, (int*)&nvisited, MAX_VISIT_POLY);
         npolys = fixupCorridor(polys, npolys, MAX_PATH_LENGTH, visited, nvisited);
 
-        m_navMeshQuery->getPolyHeight(polys[0], result, &result[1]);
+        navMeshQuery->getPolyHeight(polys[0], result, &result[1]);
         result[1] += 0.5f;
         dtVcopy(iterPos, result);
 
@@ -835,7 +1257,7 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
 
             // Handle the connection.
             float newStartPos[VERTEX_SIZE], newEndPos[VERTEX_SIZE];
-            if (dtStatusSucceed(m_navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, newStartPos, newEndPos)))
+            if (dtStatusSucceed(navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, newStartPos, newEndPos)))
             {
                 if (nsmoothPath < maxSmoothPathSize)
                 {
@@ -845,7 +1267,7 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
                 // Move position at the other side of the off-mesh link.
                 dtVcopy(iterPos, newEndPos);
 
-                m_navMeshQuery->getPolyHeight(polys[0], iterPos, &iterPos[1]);
+                navMeshQuery->getPolyHeight(polys[0], iterPos, &iterPos[1]);
                 iterPos[1] += 0.5f;
             }
         }
@@ -864,7 +1286,7 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
     return nsmoothPath < MAX_POINT_PATH_LENGTH ? DT_SUCCESS : DT_FAILURE;
 }
 
-bool PathFinder::inRangeYZX(const float* v1, const float* v2, float r, float h) const
+bool PathFinder::inRangeYZX(const float* v1, const float* v2, float r, float h)
 {
     const float dx = v2[0] - v1[0];
     const float dy = v2[1] - v1[1]; // elevation
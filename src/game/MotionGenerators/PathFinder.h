@@ -26,6 +26,11 @@
 
 #include "Movement/MoveSplineInitArgs.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
 using Movement::Vector3;
 using Movement::PointsArray;
 
@@ -37,6 +42,17 @@ class Unit;
 #define MAX_PATH_LENGTH         74
 #define MAX_POINT_PATH_LENGTH   74
 
+// long paths are planned over the navmesh tiles and refined leg by leg,
+// the unit has to repath once it reaches the end of the refined points.
+// they are cut where a spline could not send them anymore (PATHFIND_SHORT)
+#define MAX_LONG_PATH_POINTS    1024
+#define MAX_LONG_PATH_STEPS     8       // searches per leg, one tile crossing may not fit MAX_PATH_LENGTH
+
+// a running path search is kept while the destination moves less than this,
+// after that many replaced searches in a row the path is searched by the map thread
+#define PENDING_PATH_DEST_SLOP  2.0f
+#define MAX_REPLACED_SEARCHES   3
+
 #define SMOOTH_PATH_STEP_SIZE   4.0f
 #define SMOOTH_PATH_SLOP        0.3f
 
@@ -60,6 +76,36 @@ enum PathType
     PATHFIND_SHORT          = 0x0020,   // path is longer or equal to its limited path length
 };
 
+// Full navmesh search of a PathFinder done by the path search threads of the map manager.
+// The input is filled by the requesting map thread, the output belongs to the search thread until ready is set
+struct PathRequest
+{
+    PathRequest() : mapId(0), startPoly(INVALID_POLYREF), endPoly(INVALID_POLYREF), useStraightPath(false),
+        pointPathLimit(MAX_POINT_PATH_LENGTH), ready(false), polyLength(0), pointCount(0), pathStatus(DT_FAILURE), pointStatus(DT_FAILURE) {}
+
+    void Search();
+
+    uint32 mapId;
+    dtPolyRef startPoly;
+    dtPolyRef endPoly;
+    float startPoint[VERTEX_SIZE];
+    float endPoint[VERTEX_SIZE];
+    dtQueryFilter filter;
+    bool useStraightPath;
+    uint32 pointPathLimit;
+    std::chrono::steady_clock::time_point queueTime;
+
+    std::atomic<bool> ready;
+    dtPolyRef polyRefs[MAX_PATH_LENGTH];
+    uint32 polyLength;
+    float points[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
+    uint32 pointCount;
+    dtStatus pathStatus;
+    dtStatus pointStatus;
+};
+
+typedef std::shared_ptr<PathRequest> PathRequestPtr;
+
 class PathFinder
 {
     public:
@@ -74,6 +120,22 @@ class PathFinder
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance / SMOOTH_PATH_STEP_SIZE), MAX_POINT_PATH_LENGTH); };
+        // routes not fitting MAX_PATH_LENGTH polygons are planned over the navmesh tiles (straight path only)
+        void setLongPath(bool longPath) { m_longPath = longPath; }
+        // paths needing a full navmesh search are requested from the path search threads, see IsPending
+        void setAsync(bool async) { m_async = async; }
+
+        // a requested search is running, the previous path and type are kept until it is done
+        bool IsPending() const { return bool(m_pendingRequest); }
+        // takes over the result of the pending search once it is done
+        // return: true if the path was updated
+        bool UpdatePendingPath();
+        void CancelPendingPath() { m_pendingRequest.reset(); }
+
+        // point path along a poly path, usable from any thread holding the navmesh query
+        static dtStatus FindPointPath(dtNavMesh const* navMesh, dtNavMeshQuery const* navMeshQuery, dtQueryFilter const& filter,
+                                      const float* startPoint, const float* endPoint, const dtPolyRef* polyPath, uint32 polyPathSize,
+                                      bool useStraightPath, uint32 maxPointCount, float* pathPoints, uint32& pointCount);
 
         // result getters
         Vector3 getStartPosition()      const { return m_startPosition; }
@@ -94,14 +156,21 @@ class PathFinder
         bool           m_useStraightPath;  // type of path will be generated
         bool           m_forceDestination; // when set, we will always arrive at given point
         uint32         m_pointPathLimit;   // limit point path size; min(this, MAX_POINT_PATH_LENGTH)
+        bool           m_async;            // full searches are done by the path search threads
+        bool           m_longPath;         // plan routes longer than the path buffers over the tiles
+
+        PathRequestPtr m_pendingRequest;   // running search of the path search threads
+        uint32         m_replacedSearches; // searches replaced by a new destination before they were done
+        bool           m_pendingIncomplete;// the pending path cannot reach the destination
 
         Vector3        m_startPosition;    // {x, y, z} of current location
         Vector3        m_endPosition;      // {x, y, z} of the destination
         Vector3        m_actualEndPosition;// {x, y, z} of the closest possible point to given destination
 
         const Unit* const       m_sourceUnit;       // the unit that is moving
-        const dtNavMesh*        m_navMesh;          // the nav mesh
-        const dtNavMeshQuery*   m_navMeshQuery;     // the nav mesh query used to find the path
+        bool                    m_useNavMesh;       // pathfinding enabled for the unit on its map
+        const dtNavMesh*        m_navMesh;          // the nav mesh, only set during calculate
+        const dtNavMeshQuery*   m_navMeshQuery;     // the nav mesh query used to find the path, only set during calculate
 
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
@@ -109,6 +178,7 @@ class PathFinder
         void setEndPosition(const Vector3& point) { m_actualEndPosition = point; m_endPosition = point; }
         void setActualEndPosition(const Vector3& point) { m_actualEndPosition = point; }
         void NormalizePath();
+        bool CutToSplineRange();
 
         void clear()
         {
@@ -118,7 +188,7 @@ class PathFinder
 
         bool inRange(const Vector3& p1, const Vector3& p2, float r, float h) const;
         float dist3DSqr(const Vector3& p1, const Vector3& p2) const;
-        bool inRangeYZX(const float* v1, const float* v2, float r, float h) const;
+        static bool inRangeYZX(const float* v1, const float* v2, float r, float h);
 
         dtPolyRef getPathPolyByPosition(const dtPolyRef* polyPath, uint32 polyPathSize, const float* point, float* distance = nullptr) const;
         dtPolyRef getPolyByLocation(const float* point, float* distance) const;
@@ -126,21 +196,25 @@ class PathFinder
 
         void BuildPolyPath(const Vector3& startPos, const Vector3& endPos);
         void BuildPointPath(const float* startPoint, const float* endPoint);
+        void ApplyPointPath(float* pathPoints, uint32 pointCount, dtStatus dtResult);
         void BuildShortcut();
+        void BuildLongPath(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint, bool farFromPoly);
+        bool FindTileRoute(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint, std::vector<float>& portals) const;
 
         NavTerrain getNavTerrain(float x, float y, float z) const;
         void createFilter();
         void updateFilter();
 
         // smooth path aux functions
-        uint32 fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath,
-                             const dtPolyRef* visited, uint32 nvisited);
-        bool getSteerTarget(const float* startPos, const float* endPos, float minTargetDist,
-                            const dtPolyRef* path, uint32 pathSize, float* steerPos,
-                            unsigned char& steerPosFlag, dtPolyRef& steerPosRef) const;
-        dtStatus findSmoothPath(const float* startPos, const float* endPos,
-                                const dtPolyRef* polyPath, uint32 polyPathSize,
-                                float* smoothPath, int* smoothPathSize, uint32 maxSmoothPathSize);
+        static uint32 fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath,
+                                    const dtPolyRef* visited, uint32 nvisited);
+        static bool getSteerTarget(dtNavMeshQuery const* navMeshQuery, const float* startPos, const float* endPos, float minTargetDist,
+                                   const dtPolyRef* path, uint32 pathSize, float* steerPos,
+                                   unsigned char& steerPosFlag, dtPolyRef& steerPosRef);
+        static dtStatus findSmoothPath(dtNavMesh const* navMesh, dtNavMeshQuery const* navMeshQuery, dtQueryFilter const& filter,
+                                       const float* startPos, const float* endPos,
+                                       const dtPolyRef* polyPath, uint32 polyPathSize,
+                                       float* smoothPath, int* smoothPathSize, uint32 maxSmoothPathSize);
 };
 
 #endif
@@ -81,6 +81,8 @@ class FixedPathMovementGenerator : public AbstractPathMovementGenerator
         uint32 m_forcedMovement;
 };
 
+#define TAXI_FLIGHT_SPEED        32.0f
+
 class TaxiMovementGenerator : public AbstractPathMovementGenerator
 {
     public:
@@ -84,6 +84,8 @@ bool PointMovementGenerator::Update(Unit& unit, const uint32&/* diff*/)
 
     if ((!unit.hasUnitState(UNIT_STAT_ROAMING_MOVE) && unit.movespline->Finalized()) || m_speedChanged)
         Initialize(unit);
+    else if (m_pathCut && unit.movespline->Finalized())
+        Move(unit);
 
     return !unit.movespline->Finalized();
 }
@@ -91,7 +93,7 @@ bool PointMovementGenerator::Update(Unit& unit, const uint32&/* diff*/)
 void PointMovementGenerator::Move(Unit& unit)
 {
     Movement::MoveSplineInit init(unit);
-    init.MoveTo(m_x, m_y, m_z, m_generatePath);
+    m_pathCut = !init.MoveTo(m_x, m_y, m_z, m_generatePath, false, true);
     if (m_forcedMovement == FORCED_MOVEMENT_WALK)
         init.SetWalk(true);
     if (m_forcedMovement == FORCED_MOVEMENT_FLIGHT)
@@ -25,7 +25,7 @@ class PointMovementGenerator : public MovementGenerator
 {
     public:
         PointMovementGenerator(uint32 id, float x, float y, float z, float o, bool generatePath, uint32 forcedMovement, float speed = 0) :
-            m_x(x), m_y(y), m_z(z), m_o(o), m_speed(speed), m_generatePath(generatePath), m_forcedMovement(forcedMovement), m_id(id), m_speedChanged(false) {}
+            m_x(x), m_y(y), m_z(z), m_o(o), m_speed(speed), m_generatePath(generatePath), m_forcedMovement(forcedMovement), m_pathCut(false), m_id(id), m_speedChanged(false) {}
         PointMovementGenerator(uint32 id, float x, float y, float z, bool generatePath, uint32 forcedMovement, float speed = 0) :
             PointMovementGenerator(id, x, y, z, 0, generatePath, forcedMovement, speed) {}
 
@@ -47,6 +47,7 @@ class PointMovementGenerator : public MovementGenerator
         float m_x, m_y, m_z, m_o, m_speed;
         bool m_generatePath;
         uint32 m_forcedMovement;
+        bool m_pathCut;                                     // the spline ends short of the point, see MoveSplineInit::MoveTo
 
     private:
         uint32 m_id;
@@ -21,6 +21,12 @@
 #include "Movement/MoveSplineInit.h"
 #include "Movement/MoveSpline.h"
 #include "MotionGenerators/RandomMovementGenerator.h"
+#include "MotionGenerators/PathFinder.h"
+
+AbstractRandomMovementGenerator::~AbstractRandomMovementGenerator()
+{
+    delete i_path;
+}
 
 void AbstractRandomMovementGenerator::Initialize(Unit& owner)
 {
@@ -66,6 +72,9 @@ void AbstractRandomMovementGenerator::Finalize(Unit& owner)
 
 void AbstractRandomMovementGenerator::Interrupt(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelPendingPath();
+
     owner.InterruptMoving();
 
     owner.clearUnitState(i_stateMotion);
@@ -73,6 +82,9 @@ void AbstractRandomMovementGenerator::Interrupt(Unit& owner)
 
 void AbstractRandomMovementGenerator::Reset(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelPendingPath();
+
     i_nextMoveTimer.Reset(0);
 
     Initialize(owner);
@@ -85,6 +97,9 @@ bool AbstractRandomMovementGenerator::Update(Unit& owner, const uint32& diff)
 
     if (owner.hasUnitState(UNIT_STAT_NO_FREE_MOVE & ~i_stateActive))
     {
+        if (i_path)
+            i_path->CancelPendingPath();
+
         i_nextMoveTimer.Update(diff);
         owner.clearUnitState(i_stateMotion);
         return true;
@@ -92,28 +107,44 @@ bool AbstractRandomMovementGenerator::Update(Unit& owner, const uint32& diff)
 
     if (owner.movespline->Finalized())
     {
+        // the path of the next move is still searched for
+        if (i_path && i_path->IsPending())
+        {
+            if (i_path->UpdatePendingPath())
+                _scheduleNextMove(owner, _launchPath(owner) != 0);
+
+            return true;
+        }
+
         i_nextMoveTimer.Update(diff);
 
         if (i_nextMoveTimer.Passed())
         {
-            if (_setLocation(owner))
-            {
-                if (i_nextMoveCount > 1)
-                    --i_nextMoveCount;
-                else
-                {
-                    i_nextMoveCount = urand(1, i_nextMoveCountMax);
-                    i_nextMoveTimer.Reset(urand(i_nextMoveDelayMin, i_nextMoveDelayMax));
-                }
-            }
-            else
-                i_nextMoveTimer.Reset(owner.HasFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_PLAYER_CONTROLLED) ? 100 : 500);
+            int32 duration = _setLocation(owner);
+            if (!i_path || !i_path->IsPending())
+                _scheduleNextMove(owner, duration != 0);
         }
     }
 
     return true;
 }
 
+void AbstractRandomMovementGenerator::_scheduleNextMove(Unit& owner, bool moved)
+{
+    if (moved)
+    {
+        if (i_nextMoveCount > 1)
+            --i_nextMoveCount;
+        else
+        {
+            i_nextMoveCount = urand(1, i_nextMoveCountMax);
+            i_nextMoveTimer.Reset(urand(i_nextMoveDelayMin, i_nextMoveDelayMax));
+        }
+    }
+    else
+        i_nextMoveTimer.Reset(owner.HasFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_PLAYER_CONTROLLED) ? 100 : 500);
+}
+
 bool AbstractRandomMovementGenerator::_getLocation(Unit& owner, float& x, float& y, float& z)
 {
     return owner.GetMap()->GetReachableRandomPosition(&owner, x, y, z, i_radius);
@@ -127,18 +158,29 @@ int32 AbstractRandomMovementGenerator::_setLocation(Unit& owner)
     if (!_getLocation(owner, x, y, z))
         return 0;
 
-    PathFinder pf(&owner);
+    delete i_path;
+    i_path = new PathFinder(&owner);
+    i_path->setAsync(true);
 
     if (i_pathLength != 0.0f)
-        pf.setPathLengthLimit(i_pathLength);
+        i_path->setPathLengthLimit(i_pathLength);
 
-    pf.calculate(x, y, z);
+    i_path->calculate(x, y, z);
 
-    if (pf.getPathType() & PATHFIND_NOPATH)
+    // launched by Update once the path search is done
+    if (i_path->IsPending())
+        return 0;
+
+    return _launchPath(owner);
+}
+
+int32 AbstractRandomMovementGenerator::_launchPath(Unit& owner)
+{
+    if (i_path->getPathType() & PATHFIND_NOPATH)
         return 0;
 
     Movement::MoveSplineInit init(owner);
-    init.MovebyPath(pf.getPath());
+    init.MovebyPath(i_path->getPath());
     init.SetWalk(i_walk);
 
     int32 duration = init.Launch();
@@ -52,6 +52,9 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
     // prevent movement while casting spells with cast time or channel time
     if (owner.IsNonMeleeSpellCasted(false, false, true, true))
     {
+        if (i_path)
+            i_path->CancelPendingPath();
+
         if (!owner.movespline->Finalized())
         {
             if (owner.IsClientControlled())
@@ -64,6 +67,9 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
 
     if (_hasUnitStateNotMove(owner))
     {
+        if (i_path)
+            i_path->CancelPendingPath();
+
         HandleMovementFailure(owner);
         return true;
     }
@@ -71,13 +77,20 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
     // prevent crash after creature killed pet
     if (static_cast<D*>(this)->_lostTarget(owner))
     {
+        if (i_path)
+            i_path->CancelPendingPath();
+
         HandleMovementFailure(owner);
         return true;
     }
 
+    if (i_path && i_path->UpdatePendingPath())
+        HandleSearchedPath(owner);
+
     HandleTargetedMovement(owner, time_diff);
 
-    if (owner.movespline->Finalized() && !i_targetReached) 
+    // the previous spline may end before the searched path is there
+    if (owner.movespline->Finalized() && !i_targetReached && !(i_path && i_path->IsPending()))
         HandleFinalizedMovement(owner);
 
     return true;
@@ -131,6 +144,9 @@ void ChaseMovementGenerator::Finalize(Unit& owner)
 
 void ChaseMovementGenerator::Interrupt(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelPendingPath();
+
     owner.InterruptMoving();
     owner.clearUnitState(UNIT_STAT_CHASE_MOVE);
     if (m_currentMode == CHASE_MODE_DISTANCING)
@@ -290,6 +306,13 @@ void ChaseMovementGenerator::HandleMovementFailure(Unit& owner)
     _clearUnitStateMove(owner);
 }
 
+void ChaseMovementGenerator::HandleSearchedPath(Unit& owner)
+{
+    // same as a failed dispatch in HandleTargetedMovement
+    if (!LaunchPath(owner, m_pendingWalk, m_pendingCutPath, m_pendingTarget))
+        m_reachable = false;
+}
+
 void ChaseMovementGenerator::HandleFinalizedMovement(Unit& owner)
 {
     this->i_targetReached = true;
@@ -423,10 +446,27 @@ bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, floa
     }
 
     if (!this->i_path)
+    {
         this->i_path = new PathFinder(&owner);
+        this->i_path->setAsync(true);
+    }
 
     this->i_path->calculate(x, y, z, false);
 
+    // keep following the current spline until the path search is done
+    if (this->i_path->IsPending())
+    {
+        m_pendingWalk = walk;
+        m_pendingCutPath = cutPath;
+        m_pendingTarget = target;
+        return true;
+    }
+
+    return LaunchPath(owner, walk, cutPath, target);
+}
+
+bool ChaseMovementGenerator::LaunchPath(Unit& owner, bool walk, bool cutPath, bool target)
+{
     if (this->i_path->getPathType() & PATHFIND_NOPATH)
         return false;
 
@@ -652,6 +692,9 @@ void FollowMovementGenerator::Finalize(Unit& owner)
 
 void FollowMovementGenerator::Interrupt(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelPendingPath();
+
     _clearUnitStateMove(owner);
     owner.InterruptMoving();
 }
@@ -688,12 +731,24 @@ bool FollowMovementGenerator::Move(Unit& owner, float x, float y, float z)
     }
 
     if (!i_path)
+    {
         i_path = new PathFinder(&owner);
-
-    bool stuck = false;
+        i_path->setAsync(true);
+    }
 
     i_path->calculate(x, y, z);
 
+    // keep following the current spline until the path search is done
+    if (i_path->IsPending())
+        return true;
+
+    return LaunchPath(owner);
+}
+
+bool FollowMovementGenerator::LaunchPath(Unit& owner)
+{
+    bool stuck = false;
+
     auto& path = i_path->getPath();
 
     if (i_path->getPathType() & (PATHFIND_NOPATH | PATHFIND_SHORTCUT))
@@ -727,7 +782,7 @@ bool FollowMovementGenerator::Move(Unit& owner, float x, float y, float z)
 
     if (stuck)
     {
-        float o;
+        float x, y, z, o;
         _getOrientation(owner, o);
         _getLocation(owner, x, y, z, false);
 
@@ -935,6 +990,11 @@ void FollowMovementGenerator::HandleMovementFailure(Unit& owner)
     _clearUnitStateMove(owner);
 }
 
+void FollowMovementGenerator::HandleSearchedPath(Unit& owner)
+{
+    i_targetReached = !LaunchPath(owner);
+}
+
 void FollowMovementGenerator::HandleFinalizedMovement(Unit& owner)
 {
     i_targetReached = true;
@@ -68,6 +68,8 @@ class TargetedMovementGeneratorMedium
         virtual void HandleTargetedMovement(T& owner, const uint32& time_diff) = 0;
         virtual void HandleFinalizedMovement(T& owner) = 0;
         virtual void HandleMovementFailure(T& owner) = 0;
+        // the path search started by the last dispatch is done, the path may be launched
+        virtual void HandleSearchedPath(T& owner) = 0;
 
         virtual bool _hasUnitStateNotMove(Unit& owner) = 0;
         virtual void _clearUnitStateMove(Unit& owner) = 0;
@@ -108,7 +110,8 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
     public:
         ChaseMovementGenerator(Unit& target, float offset, float angle, bool moveFurther = true, bool walk = false, bool combat = true)
             : TargetedMovementGeneratorMedium<Unit, ChaseMovementGenerator >(target, offset, angle), m_moveFurther(moveFurther), m_walk(walk), m_combat(combat), m_currentMode(CHASE_MODE_NORMAL),
-              m_fanningEnabled(true), m_closenessAndFanningTimer(0), m_closenessExpired(false), m_reachable(true) {}
+              m_fanningEnabled(true), m_closenessAndFanningTimer(0), m_closenessExpired(false), m_reachable(true),
+              m_pendingWalk(false), m_pendingCutPath(false), m_pendingTarget(false) {}
         ~ChaseMovementGenerator() {}
 
         MovementGeneratorType GetMovementGeneratorType() const override { return CHASE_MOTION_TYPE; }
@@ -126,6 +129,7 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
         void _reachTarget(Unit&);
         bool GetResetPosition(Unit& /*u*/, float& /*x*/, float& /*y*/, float& /*z*/, float& /*o*/) const override { return false; }
         void HandleMovementFailure(Unit& owner) override;
+        void HandleSearchedPath(Unit& owner) override;
 
         ChaseMovementMode GetCurrentMode() const { return m_currentMode; }
         virtual bool IsReachable() const override;
@@ -147,6 +151,7 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
         virtual void _setLocation(Unit& owner);
 
         bool DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target = false);
+        bool LaunchPath(Unit& owner, bool walk, bool cutPath, bool target);
         void CutPath(Unit& owner, PointsArray& path);
         void Backpedal(Unit& owner);
 
@@ -159,6 +164,11 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
         uint32 m_closenessAndFanningTimer;
         bool m_closenessExpired;
 
+        // spline options of the dispatch waiting for its path search
+        bool m_pendingWalk;
+        bool m_pendingCutPath;
+        bool m_pendingTarget;
+
         ChaseMovementMode m_currentMode;
 };
 
@@ -188,6 +198,7 @@ class FollowMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Fol
         void _reachTarget(Unit& owner);
 
         void HandleMovementFailure(Unit& owner) override;
+        void HandleSearchedPath(Unit& owner) override;
 
         virtual bool IsRemovedOnDirectExpire() const override { return !m_main; }
 
@@ -206,6 +217,7 @@ class FollowMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Fol
         virtual bool IsUnstuckAllowed(Unit& owner) const;
 
         virtual bool Move(Unit& owner, float x, float y, float z);
+        bool LaunchPath(Unit& owner);
 
     private:
         virtual bool _getOrientation(Unit& owner, float& o) const;
@@ -76,9 +76,11 @@ namespace Movement
             void MovebyPath(const PointsArray& controls, int32 path_offset = 0);
 
             /* Initializes simple A to B mition, A is current unit's position, B is destination
+             * longPath plans a generated path beyond the path buffers, it may be cut to the range of one spline then
+             * @return false if such a path ends short of the destination, the unit has to move on from the end of it
              */
-            void MoveTo(const Vector3& dest, bool generatePath = false, bool forceDestination = false);
-            void MoveTo(float x, float y, float z, bool generatePath = false, bool forceDestination = false);
+            bool MoveTo(const Vector3& dest, bool generatePath = false, bool forceDestination = false, bool longPath = false);
+            bool MoveTo(float x, float y, float z, bool generatePath = false, bool forceDestination = false, bool longPath = false);
 
             /* Sets Id of fisrt point of the path. When N-th path point will be done ILisener will notify that pointId + N done
              * Needed for waypoint movement where path splitten into parts
@@ -147,26 +149,27 @@ namespace Movement
         args.path.assign(controls.begin(), controls.end());
     }
 
-    inline void MoveSplineInit::MoveTo(float x, float y, float z, bool generatePath, bool forceDestination)
+    inline bool MoveSplineInit::MoveTo(float x, float y, float z, bool generatePath, bool forceDestination, bool longPath)
     {
         Vector3 v(x, y, z);
-        MoveTo(v, generatePath, forceDestination);
+        return MoveTo(v, generatePath, forceDestination, longPath);
     }
 
-    inline void MoveSplineInit::MoveTo(const Vector3& dest, bool generatePath, bool forceDestination)
+    inline bool MoveSplineInit::MoveTo(const Vector3& dest, bool generatePath, bool forceDestination, bool longPath)
     {
         if (generatePath)
         {
             PathFinder path(&unit);
+            path.setLongPath(longPath);
             path.calculate(dest.x, dest.y, dest.z, forceDestination);
             MovebyPath(path.getPath());
+            return !longPath || !(path.getPathType() & PATHFIND_SHORT);
         }
-        else
-        {
-            args.path_Idx_offset = 0;
-            args.path.resize(2);
-            args.path[1] = dest;
-        }
+
+        args.path_Idx_offset = 0;
+        args.path.resize(2);
+        args.path[1] = dest;
+        return true;
     }
 
     inline void MoveSplineInit::SetParabolic(float amplitude, float time_shift)
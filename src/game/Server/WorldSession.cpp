@@ -172,7 +172,7 @@ void WorldSession::SetExpansion(uint8 expansion)
 }
 
 /// Send a packet to the client
-void WorldSession::SendPacket(WorldPacket const& packet) const
+void WorldSession::SendPacket(WorldPacket const& packet, MaNGOS::SharedBuffer* sharedPayload /*= nullptr*/) const
 {
 #ifdef BUILD_PLAYERBOT
     // Send packet to bot AI
@@ -224,7 +224,26 @@ void WorldSession::SendPacket(WorldPacket const& packet) const
 
 #endif                                                  // !MANGOS_DEBUG
 
-    m_Socket->SendPacket(packet);
+    if (sharedPayload)
+        m_Socket->SendPacket(packet, *sharedPayload);
+    else
+        m_Socket->SendPacket(packet);
+}
+
+/// Send the packets buffered so far, called once the producing world or map tick is done
+void WorldSession::FlushPackets() const
+{
+    if (m_Socket && !m_Socket->IsClosed())
+        m_Socket->Flush();
+}
+
+bool WorldSession::GetSocketSendStats(MaNGOS::SocketSendStats& stats) const
+{
+    if (!m_Socket)
+        return false;
+
+    stats = m_Socket->GetSendStats();
+    return true;
 }
 
 /// Add an incoming packet to the queue
@@ -575,10 +594,8 @@ void WorldSession::LogoutPlayer()
         // GM ticket notification
         sTicketMgr.OnPlayerOnlineState(*_player, false);
 
-#ifdef BUILD_PLAYERBOT
         // Remember player GUID for update SQL below
         uint32 guid = _player->GetGUIDLow();
-#endif
 
         ///- Remove the player from the world
         // the player may not be in the world when logging out
@@ -606,6 +623,9 @@ void WorldSession::LogoutPlayer()
 
         static SqlStatementID updChars;
 
+        // keep the order with character save above
+        CharacterDatabase.BeginTransaction(guid);
+
 #ifdef BUILD_PLAYERBOT
         // Set for only character instead of accountid
         // Different characters can be alive as bots
@@ -618,6 +638,8 @@ void WorldSession::LogoutPlayer()
         stmt.PExecute(GetAccountId());
 #endif
 
+        CharacterDatabase.CommitTransaction();
+
         DEBUG_LOG("SESSION: Sent SMSG_LOGOUT_COMPLETE Message");
     }
 
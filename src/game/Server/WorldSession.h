@@ -288,7 +288,10 @@ class WorldSession
         void ReadAddonsInfo(WorldPacket& data);
         void SendAddonsInfo();
 
-        void SendPacket(WorldPacket const& packet) const;
+        // sharedPayload is set for packets broadcast to many sessions, see WorldSocket::SendPacket
+        void SendPacket(WorldPacket const& packet, MaNGOS::SharedBuffer* sharedPayload = nullptr) const;
+        void FlushPackets() const;
+        bool GetSocketSendStats(MaNGOS::SocketSendStats& stats) const;
         void SendExpectedSpamRecords();
         void SendMotd();
         void SendOfflineNameQueryResponses();
@@ -84,6 +84,9 @@ struct ServerPktHeader
 #pragma pack(pop)
 #endif
 
+std::atomic<uint64> WorldSocket::s_payloadBytesCopied(0);
+std::atomic<uint64> WorldSocket::s_payloadBytesReferenced(0);
+
 WorldSocket::WorldSocket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler) : Socket(service, std::move(closeHandler)), m_lastPingTime(std::chrono::system_clock::time_point::min()), m_overSpeedPings(0), m_existingHeader(),
     m_useExistingHeader(false), m_session(nullptr), m_seed(urand())
 {
@@ -101,12 +104,50 @@ void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
     m_crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
 
     if (!pct.empty())
+    {
         Write(reinterpret_cast<const char*>(&header.header), header.getHeaderLength(), reinterpret_cast<const char*>(pct.contents()), pct.size());
+        s_payloadBytesCopied.fetch_add(pct.size(), std::memory_order_relaxed);
+    }
     else
         Write(reinterpret_cast<const char*>(&header.header), header.getHeaderLength());
 
     if (immediate)
-        ForceFlushOut();
+        Flush();
+}
+
+void WorldSocket::SendPacket(const WorldPacket& pct, MaNGOS::SharedBuffer& sharedPayload)
+{
+    if (pct.size() < MinSharedPayloadSize)
+    {
+        SendPacket(pct);
+        return;
+    }
+
+    if (IsClosed())
+        return;
+
+    // Dump outgoing packet.
+    sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), pct.GetOpcode(), pct.GetOpcodeName(), pct, false);
+
+    if (!sharedPayload)
+    {
+        sharedPayload = std::make_shared<std::vector<uint8>>(pct.contents(), pct.contents() + pct.size());
+        s_payloadBytesCopied.fetch_add(pct.size(), std::memory_order_relaxed);
+    }
+
+    ServerPktHeader header(pct.size() + 2, pct.GetOpcode());
+    m_crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
+
+    Write(reinterpret_cast<const char*>(&header.header), header.getHeaderLength(), sharedPayload);
+    s_payloadBytesReferenced.fetch_add(pct.size(), std::memory_order_relaxed);
+}
+
+PacketPayloadStats WorldSocket::GetPayloadStats()
+{
+    PacketPayloadStats stats;
+    stats.copied = s_payloadBytesCopied.load(std::memory_order_relaxed);
+    stats.referenced = s_payloadBytesReferenced.load(std::memory_order_relaxed);
+    return stats;
 }
 
 bool WorldSocket::Open()
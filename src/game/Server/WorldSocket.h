@@ -30,6 +30,7 @@
 #include "Auth/BigNumber.h"
 #include "Network/Socket.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 
@@ -73,9 +74,21 @@ class WorldSession;
  *
  */
 
+struct PacketPayloadStats
+{
+    uint64 copied;                                          // payload bytes copied into socket send queues or shared buffers
+    uint64 referenced;                                      // payload bytes queued by reference to a shared buffer
+};
+
 class WorldSocket : public MaNGOS::Socket
 {
     private:
+        /// Payloads smaller than this are copied even for broadcasts, a separate buffer would cost more
+        static const size_t MinSharedPayloadSize = 64;
+
+        static std::atomic<uint64> s_payloadBytesCopied;
+        static std::atomic<uint64> s_payloadBytesReferenced;
+
 #if defined( __GNUC__ )
 #pragma pack(1)
 #else
@@ -126,6 +139,12 @@ class WorldSocket : public MaNGOS::Socket
         // send a packet \o/
         void SendPacket(const WorldPacket& pct, bool immediate = false);
 
+        /// Send a packet that goes to many sockets.  The payload is copied into sharedPayload by the
+        /// first recipient, the others only queue a reference to it next to their own encrypted header.
+        void SendPacket(const WorldPacket& pct, MaNGOS::SharedBuffer& sharedPayload);
+
+        static PacketPayloadStats GetPayloadStats();
+
         void FinalizeSession() { m_session = nullptr; }
 
         virtual bool Open() override;
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_AURALIST_H
+#define MANGOS_AURALIST_H
+
+#include <cstddef>
+#include <iterator>
+
+class Aura;
+class AuraList;
+
+// Link of an aura in the modifier list of its aura type, embedded in the aura
+class AuraListNode
+{
+        friend class AuraList;
+
+    public:
+        explicit AuraListNode(Aura* aura) : m_aura(aura), m_next(nullptr), m_prev(nullptr) {}
+        ~AuraListNode() { Unlink(); }
+
+        bool IsLinked() const { return m_prev != nullptr; }
+
+    private:
+        AuraListNode(AuraListNode const&) = delete;
+        AuraListNode& operator=(AuraListNode const&) = delete;
+
+        // m_next is kept on unlink so that an iterator standing on a just removed aura can still advance
+        void Unlink()
+        {
+            if (!IsLinked())
+                return;
+
+            m_prev->m_next = m_next;
+            m_next->m_prev = m_prev;
+            m_prev = nullptr;
+        }
+
+        Aura* m_aura;
+        AuraListNode* m_next;
+        AuraListNode* m_prev;
+};
+
+// Intrusive list of auras in application order, with the std::list subset used on Unit::GetAurasByType results.
+// Linking and unlinking never allocate, an aura can be in one such list at a time.
+class AuraList
+{
+    public:
+        class const_iterator
+        {
+                friend class AuraList;
+
+            public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef Aura* value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef Aura* const* pointer;
+                typedef Aura* const& reference;
+
+                const_iterator() : m_node(nullptr) {}
+
+                Aura* const& operator*() const { return m_node->m_aura; }
+
+                const_iterator& operator++() { m_node = m_node->m_next; return *this; }
+                const_iterator operator++(int) { const_iterator itr = *this; ++*this; return itr; }
+                const_iterator& operator--() { m_node = m_node->m_prev; return *this; }
+                const_iterator operator--(int) { const_iterator itr = *this; --*this; return itr; }
+
+                bool operator==(const_iterator const& other) const { return m_node == other.m_node; }
+                bool operator!=(const_iterator const& other) const { return m_node != other.m_node; }
+
+            private:
+                explicit const_iterator(AuraListNode const* node) : m_node(node) {}
+
+                AuraListNode const* m_node;
+        };
+
+        typedef const_iterator iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        AuraList() : m_head(nullptr)
+        {
+            m_head.m_next = &m_head;
+            m_head.m_prev = &m_head;
+        }
+
+        ~AuraList()
+        {
+            while (!empty())
+                m_head.m_next->Unlink();
+            m_head.m_prev = nullptr;
+        }
+
+        const_iterator begin() const { return const_iterator(m_head.m_next); }
+        const_iterator end() const { return const_iterator(&m_head); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        bool empty() const { return m_head.m_next == &m_head; }
+        Aura* front() const { return m_head.m_next->m_aura; }
+        Aura* back() const { return m_head.m_prev->m_aura; }
+
+        // walks the list, only used by rare checks and commands
+        size_t size() const
+        {
+            size_t count = 0;
+            for (AuraListNode const* node = m_head.m_next; node != &m_head; node = node->m_next)
+                ++count;
+            return count;
+        }
+
+        void push_back(AuraListNode& node)
+        {
+            node.Unlink();
+            node.m_prev = m_head.m_prev;
+            node.m_next = &m_head;
+            m_head.m_prev->m_next = &node;
+            m_head.m_prev = &node;
+        }
+
+        void remove(AuraListNode& node) { node.Unlink(); }
+
+        const_iterator erase(const_iterator itr)
+        {
+            AuraListNode* node = const_cast<AuraListNode*>(itr.m_node);
+            const_iterator next(node->m_next);
+            node->Unlink();
+            return next;
+        }
+
+    private:
+        AuraList(AuraList const&) = delete;
+        AuraList& operator=(AuraList const&) = delete;
+
+        AuraListNode m_head;                                // sentinel, its aura is nullptr
+};
+
+#endif
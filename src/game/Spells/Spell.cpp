@@ -48,6 +48,7 @@
 #include "MotionGenerators/PathFinder.h"
 #include "Spells/Scripts/SpellScript.h"
 #include "Entities/ObjectGuid.h"
+#include "Utilities/PoolAllocator.h"
 
 extern pEffect SpellEffects[MAX_SPELL_EFFECTS];
 
@@ -513,6 +514,18 @@ Spell::~Spell()
 {
 }
 
+static PoolAllocator s_spellPool("Spell");
+
+void* Spell::operator new(size_t size)
+{
+    return s_spellPool.Allocate(size);
+}
+
+void Spell::operator delete(void* pointer, size_t size)
+{
+    s_spellPool.Deallocate(pointer, size);
+}
+
 template<typename T>
 WorldObject* Spell::FindCorpseUsing()
 {
@@ -623,6 +636,7 @@ void Spell::FillTargetMap()
                     SpellTargetFilterScheme scheme = filterScheme[rightTarget];
                     if (!unitTargetList.empty()) // Unit case
                     {
+                        PrefetchTargetsLineOfSight(unitTargetList, SpellEffectIndex(i), bool(rightTarget));
                         for (auto itr = unitTargetList.begin(); itr != unitTargetList.end();)
                         {
                             if (!CheckTarget(*itr, SpellEffectIndex(i), bool(rightTarget), CheckException(targetingData.magnet)))
@@ -7354,6 +7368,47 @@ CurrentSpellTypes Spell::GetCurrentContainer() const
     return (CURRENT_GENERIC_SPELL);
 }
 
+// Casts the line of sight rays CheckTarget will need for an area target list in one batch, CheckTarget then finds them in the map tick cache
+void Spell::PrefetchTargetsLineOfSight(UnitList const& targets, SpellEffectIndex eff, bool targetB) const
+{
+    if (targets.size() < 2 || !sWorld.getConfig(CONFIG_BOOL_VMAP_LOS_CACHE))
+        return;
+
+    switch (m_spellInfo->Effect[eff])
+    {
+        case SPELL_EFFECT_SUMMON_PLAYER:
+        case SPELL_EFFECT_RESURRECT_NEW:
+            return;
+        default:
+            break;
+    }
+
+    SpellTargetInfo const& info = SpellTargetInfoTable[targetB ? m_spellInfo->EffectImplicitTargetB[eff] : m_spellInfo->EffectImplicitTargetA[eff]];
+    if (info.type == TARGET_TYPE_UNIT && info.filter == TARGET_SCRIPT)
+        return;
+
+    if (IsIgnoreLosSpellEffect(m_spellInfo, eff) || m_spellInfo->EffectImplicitTargetA[eff] == TARGET_LOCATION_DYNOBJ_POSITION)
+        return;
+
+    WorldObject* caster = GetCastingObject();
+    if (!caster)
+        return;
+
+    // same positions as WorldObject::IsWithinLOSInMap from each target to the casting object
+    uint32 phasemask = caster->GetPhaseMask();
+    std::vector<G3D::Vector3> sources;
+    sources.reserve(targets.size());
+    for (Unit* target : targets)
+        if (target != m_caster && target->GetPhaseMask() == phasemask && target->IsInMap(caster))
+            sources.push_back(G3D::Vector3(target->GetPositionX(), target->GetPositionY(), target->GetPositionZ() + target->GetCollisionHeight()));
+
+    if (sources.size() < 2)
+        return;
+
+    std::vector<bool> results;
+    caster->GetMap()->IsInLineOfSight(sources, caster->GetPositionX(), caster->GetPositionY(), caster->GetPositionZ() + caster->GetCollisionHeight(), phasemask, true, results);
+}
+
 bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff, bool targetB, CheckException exception) const
 {
     // Check targets for creature type mask and remove not appropriate (skip explicit self target case, maybe need other explicit targets)
@@ -7703,7 +7758,12 @@ SpellCastResult Spell::CanOpenLock(SpellEffectIndex effIndex, uint32 lockId, Ski
 void Spell::FillAreaTargets(UnitList& targetUnitMap, float radius, float cone, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster /*=nullptr*/)
 {
     MaNGOS::SpellNotifierCreatureAndPlayer notifier(*this, targetUnitMap, radius, cone, pushType, spellTargets, originalCaster);
-    Cell::VisitAllObjects(notifier.GetCenterX(), notifier.GetCenterY(), m_caster->GetMap(), notifier, radius);
+
+    // the cell indexes filter by distance first, so only units in reach are looked at
+    std::vector<WorldObject*> candidates;
+    m_caster->GetMap()->GetObjectsInRange(notifier.GetCenterX(), notifier.GetCenterY(), radius, TYPEMASK_UNIT, candidates);
+    for (WorldObject* target : candidates)
+        notifier.Visit(static_cast<Unit*>(target));
 }
 
 void Spell::FillRaidOrPartyTargets(UnitList& targetUnitMap, Unit* member, Unit* center, float radius, bool raid, bool withPets, bool withcaster) const
@@ -447,6 +447,10 @@ class Spell
         Spell(Unit* caster, SpellEntry const* info, uint32 triggeredFlags, ObjectGuid originalCasterGUID = ObjectGuid(), SpellEntry const* triggeredBy = nullptr);
         ~Spell();
 
+        // spells are allocated from per thread free lists, every cast creates one
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer, size_t size);
+
         SpellCastResult SpellStart(SpellCastTargets const* targets, Aura* triggeredByAura = nullptr);
 
         void cancel();
@@ -514,6 +518,7 @@ class Spell
         template<typename T> WorldObject* FindCorpseUsing();
 
         bool CheckTarget(Unit* target, SpellEffectIndex eff, bool targetB, CheckException exception = EXCEPTION_NONE) const;
+        void PrefetchTargetsLineOfSight(UnitList const& targets, SpellEffectIndex eff, bool targetB) const;
         bool CanAutoCast(Unit* target);
 
         static void SendCastResult(Player const* caster, SpellEntry const* spellInfo, uint8 cast_count, SpellCastResult result, bool isPetCastResult = false);
@@ -982,67 +987,70 @@ namespace MaNGOS
         }
 
         template<class T> inline void Visit(GridRefManager<T>&  m)
+        {
+            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+                Visit(itr->getSource());
+        }
+
+        inline void Visit(Unit* target)
         {
             if (!i_originalCaster || !i_castingObject)
                 return;
 
-            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+            // there are still more spells which can be casted on dead, but
+            // they are no AOE and don't have such a nice SPELL_ATTR flag
+            // mostly phase check
+            if (!target->IsInMap(i_originalCaster) || target->IsTaxiFlying())
+                return;
+
+            switch (i_TargetType)
             {
-                // there are still more spells which can be casted on dead, but
-                // they are no AOE and don't have such a nice SPELL_ATTR flag
-                // mostly phase check
-                if (!itr->getSource()->IsInMap(i_originalCaster) || itr->getSource()->IsTaxiFlying())
-                    continue;
+                case SPELL_TARGETS_ASSISTABLE:
+                    if (target->GetTypeId() == TYPEID_UNIT && ((Creature*)target)->IsTotem())
+                        return;
 
-                switch (i_TargetType)
+                    if (!i_originalCaster->CanAssistSpell(target, i_spell.m_spellInfo))
+                        return;
+                    break;
+                case SPELL_TARGETS_AOE_ATTACKABLE:
                 {
-                    case SPELL_TARGETS_ASSISTABLE:
-                        if (itr->getSource()->GetTypeId() == TYPEID_UNIT && ((Creature*)itr->getSource())->IsTotem())
-                            continue;
-
-                        if (!i_originalCaster->CanAssistSpell(itr->getSource(), i_spell.m_spellInfo))
-                            continue;
-                        break;
-                    case SPELL_TARGETS_AOE_ATTACKABLE:
-                    {
-                        if (itr->getSource()->GetTypeId() == TYPEID_UNIT && ((Creature*)itr->getSource())->IsTotem())
-                            continue;
+                    if (target->GetTypeId() == TYPEID_UNIT && ((Creature*)target)->IsTotem())
+                        return;
 
-                        if (!i_originalCaster->CanAttackSpell(itr->getSource(), i_spell.m_spellInfo, true))
-                            continue;
-                        break;
-                    }
-                    case SPELL_TARGETS_ALL:
-                        break;
-                    default: continue;
+                    if (!i_originalCaster->CanAttackSpell(target, i_spell.m_spellInfo, true))
+                        return;
+                    break;
                 }
+                case SPELL_TARGETS_ALL:
+                    break;
+                default: return;
+            }
 
-                // we don't need to check InMap here, it's already done some lines above
-                switch (i_push_type)
-                {
-                    case PUSH_CONE:
-                        if (i_cone >= 0.f)
-                        {
-                            if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, i_cone))
-                                i_data.push_back(itr->getSource());
-                        }
-                        else
-                        {
-                            if (i_castingObject->isInBack((Unit*)(itr->getSource()), i_radius, -i_cone))
-                                i_data.push_back(itr->getSource());
-                        }
-                        break;
-                    case PUSH_SELF_CENTER:
-                        if (itr->getSource()->GetDistance2d(i_centerX, i_centerY, DIST_CALC_COMBAT_REACH) <= i_radius)
-                            i_data.push_back(itr->getSource());
-                        break;
-                    case PUSH_SRC_CENTER:
-                    case PUSH_DEST_CENTER:
-                    case PUSH_TARGET_CENTER:
-                        if (itr->getSource()->GetDistance(i_centerX, i_centerY, i_centerZ, DIST_CALC_COMBAT_REACH) <= i_radius)
-                            i_data.push_back(itr->getSource());
-                        break;
-                }
+            // we don't need to check InMap here, it's already done some lines above
+            switch (i_push_type)
+            {
+                case PUSH_CONE:
+                    if (i_cone >= 0.f)
+                    {
+                        if (i_castingObject->isInFront(target, i_radius, i_cone))
+                            i_data.push_back(target);
+                    }
+                    else
+                    {
+                        if (i_castingObject->isInBack(target, i_radius, -i_cone))
+                            i_data.push_back(target);
+                    }
+                    break;
+                case PUSH_SELF_CENTER:
+                    if (target->GetDistance2d(i_centerX, i_centerY, DIST_CALC_COMBAT_REACH) <= i_radius)
+                        i_data.push_back(target);
+                    break;
+                case PUSH_SRC_CENTER:
+                case PUSH_DEST_CENTER:
+                case PUSH_TARGET_CENTER:
+                    if (target->GetDistance(i_centerX, i_centerY, i_centerZ, DIST_CALC_COMBAT_REACH) <= i_radius)
+                        i_data.push_back(target);
+                    break;
             }
         }
 
@@ -47,6 +47,7 @@
 #include "Tools/Language.h"
 #include "Maps/MapManager.h"
 #include "Loot/LootMgr.h"
+#include "Utilities/PoolAllocator.h"
 #include "Entities/TemporarySpawn.h"
 #include "Maps/InstanceData.h"
 #include "AI/ScriptDevAI/include/sc_grid_searchers.h"
@@ -384,7 +385,7 @@ Aura::Aura(SpellEntry const* spellproto, SpellEffectIndex eff, int32 const* curr
     m_periodicTimer(0), m_periodicTick(0), m_removeMode(AURA_REMOVE_BY_DEFAULT),
     m_effIndex(eff), m_positive(false), m_isPeriodic(false), m_isAreaAura(false),
     m_isPersistent(false), m_magnetUsed(false), m_spellAuraHolder(holder),
-    m_scriptValue(0)
+    m_scriptValue(0), m_modListNode(this)
 {
     MANGOS_ASSERT(target);
     MANGOS_ASSERT(spellproto && spellproto == sSpellTemplate.LookupEntry<SpellEntry>(spellproto->Id) && "`info` must be pointer to sSpellTemplate element");
@@ -459,6 +460,29 @@ Aura::~Aura()
 {
 }
 
+static PoolAllocator s_auraPool("Aura");
+static PoolAllocator s_auraHolderPool("SpellAuraHolder");
+
+void* Aura::operator new(size_t size)
+{
+    return s_auraPool.Allocate(size);
+}
+
+void Aura::operator delete(void* pointer, size_t size)
+{
+    s_auraPool.Deallocate(pointer, size);
+}
+
+void* SpellAuraHolder::operator new(size_t size)
+{
+    return s_auraHolderPool.Allocate(size);
+}
+
+void SpellAuraHolder::operator delete(void* pointer, size_t size)
+{
+    s_auraHolderPool.Deallocate(pointer, size);
+}
+
 AreaAura::AreaAura(SpellEntry const* spellproto, SpellEffectIndex eff, int32 const* currentDamage, int32 const* currentBasePoints, SpellAuraHolder* holder, Unit* target,
                    Unit* caster, Item* castItem, uint32 originalRankSpellId)
     : Aura(spellproto, eff, currentDamage, currentBasePoints, holder, target, caster, castItem), m_originalRankSpellId(originalRankSpellId)
@@ -19,6 +19,7 @@
 #define MANGOS_SPELLAURAS_H
 
 #include "Spells/SpellAuraDefines.h"
+#include "Spells/AuraList.h"
 #include "Server/DBCEnums.h"
 #include "Entities/ObjectGuid.h"
 #include "Spells/Scripts/SpellScript.h"
@@ -96,6 +97,10 @@ class SpellAuraHolder
         ~SpellAuraHolder();
         Aura* m_auras[MAX_EFFECT_INDEX];
 
+        // holders and auras are allocated from per thread free lists, periodic refreshes and dispels churn them
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer, size_t size);
+
         void AddAura(Aura* aura, SpellEffectIndex index);
         void RemoveAura(SpellEffectIndex index);
         void ApplyAuraModifiers(bool apply, bool real = false);
@@ -439,6 +444,12 @@ class Aura
 
         virtual ~Aura();
 
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer, size_t size);
+
+        // link in the Unit::GetAurasByType list of the modifier aura type
+        AuraListNode& GetModListNode() { return m_modListNode; }
+
         void SetModifier(AuraType type, int32 amount, uint32 periodicTime, int32 miscValue);
         Modifier*       GetModifier()       { return &m_modifier; }
         Modifier const* GetModifier() const { return &m_modifier; }
@@ -566,6 +577,8 @@ class Aura
 
         // Scripting system
         uint64 m_scriptValue; // persistent value for spell script state
+
+        AuraListNode m_modListNode;
     private:
         void ReapplyAffectedPassiveAuras(Unit* target, bool owner_mode);
 };
@@ -1921,7 +1921,7 @@ void Spell::EffectDummy(SpellEffectIndex eff_idx)
                         }
                         case 40250: // Improved Duration - Anzu spirits
                         {
-                            auto periodicAuraList = unitTarget->GetAurasByType(SPELL_AURA_PERIODIC_HEAL);
+                            Unit::AuraList const& periodicAuraList = unitTarget->GetAurasByType(SPELL_AURA_PERIODIC_HEAL);
                             uint32 duration = 0;
                             for (auto itr = periodicAuraList.rbegin(); itr != periodicAuraList.rend(); ++itr)
                             {
@@ -42,7 +42,7 @@ bool IsPrimaryProfessionSkill(uint32 skill)
     return true;
 }
 
-SpellMgr::SpellMgr()
+SpellMgr::SpellMgr() : mSpellClassificationGeneration(0)
 {
 }
 
@@ -408,7 +408,7 @@ int32 CompareAuraRanks(uint32 spellId_1, uint32 spellId_2)
     return 0;
 }
 
-SpellSpecific GetSpellSpecific(uint32 spellId)
+static SpellSpecific CalculateSpellSpecific(uint32 spellId)
 {
     SpellEntry const* spellInfo = sSpellTemplate.LookupEntry<SpellEntry>(spellId);
     if (!spellInfo)
@@ -576,6 +576,19 @@ SpellSpecific GetSpellSpecific(uint32 spellId)
     return SPELL_NORMAL;
 }
 
+SpellSpecific GetSpellSpecific(uint32 spellId)
+{
+    if (SpellClassification const* classification = sSpellMgr.GetSpellClassification(spellId))
+        return SpellSpecific(classification->specific);
+
+    return CalculateSpellSpecific(spellId);
+}
+
+SpellClassification const* GetSpellClassification(uint32 spellId)
+{
+    return sSpellMgr.GetSpellClassification(spellId);
+}
+
 bool IsExplicitPositiveTarget(uint32 targetA)
 {
     // positive targets that in target selection code expect target in m_targers, so not that auto-select target by spell data by m_caster and etc
@@ -1180,6 +1193,96 @@ struct DoSpellProcEvent
     uint32 count;
 };
 
+// Mirrors CalculatePositiveEffectTargetMode: true when the result depends on who casts at whom
+static bool IsPositiveEffectTargetModeContextual(SpellEntry const* entry, SpellEffectIndex effIndex, bool recursive = false)
+{
+    if (IsSpellEffectTriggerSpell(entry, effIndex))
+    {
+        uint32 const spellid = entry->EffectTriggerSpell[effIndex];
+        if (!recursive && spellid && (spellid != entry->Id))
+        {
+            if (SpellEntry const* triggered = sSpellTemplate.LookupEntry<SpellEntry>(spellid))
+            {
+                for (uint32 i = EFFECT_INDEX_0; i < MAX_EFFECT_INDEX; ++i)
+                    if (IsPositiveEffectTargetModeContextual(triggered, SpellEffectIndex(i), true))
+                        return true;
+            }
+        }
+        return false;
+    }
+
+    uint32 const a = entry->EffectImplicitTargetA[effIndex];
+    uint32 const b = entry->EffectImplicitTargetB[effIndex];
+
+    if ((!a && !b) || IsEffectTargetPositive(a, b) || IsEffectTargetScript(a, b) || IsEffectTargetNegative(a, b))
+        return false;
+
+    if (IsEffectTargetNeutral(a, b))
+    {
+        uint32 const etarget = b ? b : a;
+        if (IsPointEffectTarget(SpellTarget(etarget)))
+            return false;
+        return etarget >= MAX_SPELL_TARGETS || SpellTargetInfoTable[etarget].type == TARGET_TYPE_UNIT;
+    }
+
+    return false;
+}
+
+void SpellMgr::LoadSpellClassifications()
+{
+    uint32 const startTime = WorldTimer::getMSTime();
+
+    std::vector<SpellClassification> classifications(sSpellTemplate.GetMaxEntry());
+    uint32 count = 0;
+    uint32 contextual = 0;
+
+    BarGoLink bar(sSpellTemplate.GetMaxEntry());
+    for (uint32 spellId = 0; spellId < sSpellTemplate.GetMaxEntry(); ++spellId)
+    {
+        bar.step();
+
+        SpellEntry const* spellInfo = sSpellTemplate.LookupEntry<SpellEntry>(spellId);
+        if (!spellInfo)
+            continue;
+
+        SpellClassification& classification = classifications[spellId];
+        classification.flags = SPELL_CLASSIFICATION_LOADED;
+        classification.specific = uint8(CalculateSpellSpecific(spellId));
+
+        SpellProcEventEntry const* procEvent = GetSpellProcEvent(spellId);
+        classification.procFlags = (procEvent && procEvent->procFlags) ? procEvent->procFlags : spellInfo->procFlags;
+
+        for (uint32 i = EFFECT_INDEX_0; i < MAX_EFFECT_INDEX; ++i)
+        {
+            SpellEffectIndex const effIndex = SpellEffectIndex(i);
+
+            if (IsAreaEffectTarget(SpellTarget(spellInfo->EffectImplicitTargetA[i])) || IsAreaEffectTarget(SpellTarget(spellInfo->EffectImplicitTargetB[i])))
+                classification.flags |= SPELL_CLASSIFICATION_AREA_OF_EFFECT;
+
+            // caster/target dependent effects keep being evaluated per call
+            if (IsPositiveEffectTargetModeContextual(spellInfo, effIndex))
+            {
+                ++contextual;
+                continue;
+            }
+
+            classification.staticEffects |= (1 << i);
+            if (CalculatePositiveEffect(spellInfo, effIndex))
+                classification.positiveEffects |= (1 << i);
+            if (CalculatePositiveEffectTargetMode(spellInfo, effIndex))
+                classification.positiveTargetModes |= (1 << i);
+        }
+
+        ++count;
+    }
+
+    mSpellClassifications.swap(classifications);
+    ++mSpellClassificationGeneration;
+
+    sLog.outString(">> Classified %u spells in %u ms, %u effects left to per-cast positivity checks", count, WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()), contextual);
+    sLog.outString();
+}
+
 void SpellMgr::LoadSpellProcEvents()
 {
     mSpellProcEventMap.clear();                             // need for reload case
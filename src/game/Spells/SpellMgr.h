@@ -85,6 +85,27 @@ enum SpellSpecific
 
 SpellSpecific GetSpellSpecific(uint32 spellId);
 
+enum SpellClassificationFlags
+{
+    SPELL_CLASSIFICATION_LOADED         = 0x01,
+    SPELL_CLASSIFICATION_AREA_OF_EFFECT = 0x02,         // IsAreaOfEffectSpell
+};
+
+// Answers of the spell helpers that only depend on the spell itself, built once by SpellMgr::LoadSpellClassifications.
+// Effects whose positivity needs caster and target stay out of staticEffects and are evaluated on each call.
+struct SpellClassification
+{
+    uint8 flags;                                        // SpellClassificationFlags
+    uint8 staticEffects;                                // effect mask with positivity independent of caster and target
+    uint8 positiveEffects;                              // IsPositiveEffect of the static effects
+    uint8 positiveTargetModes;                          // IsPositiveEffectTargetMode of the static effects
+    uint8 specific;                                     // GetSpellSpecific
+    uint32 procFlags;                                   // proc flags of spell_proc_event, else of the spell
+};
+
+// nullptr before the classifications are loaded and for unknown spells
+SpellClassification const* GetSpellClassification(uint32 spellId);
+
 // Different spell properties
 inline float GetSpellRadius(SpellRadiusEntry const* radius) { return (radius ? radius->Radius : 0); }
 uint32 GetSpellCastTime(SpellEntry const* spellInfo, WorldObject* caster, Spell* spell = nullptr);
@@ -871,6 +892,9 @@ inline bool IsAreaEffectTarget(SpellTarget target)
 
 inline bool IsAreaOfEffectSpell(SpellEntry const* spellInfo)
 {
+    if (SpellClassification const* classification = GetSpellClassification(spellInfo->Id))
+        return (classification->flags & SPELL_CLASSIFICATION_AREA_OF_EFFECT) != 0;
+
     if (IsAreaEffectTarget(SpellTarget(spellInfo->EffectImplicitTargetA[EFFECT_INDEX_0])) || IsAreaEffectTarget(SpellTarget(spellInfo->EffectImplicitTargetB[EFFECT_INDEX_0])))
         return true;
     if (IsAreaEffectTarget(SpellTarget(spellInfo->EffectImplicitTargetA[EFFECT_INDEX_1])) || IsAreaEffectTarget(SpellTarget(spellInfo->EffectImplicitTargetB[EFFECT_INDEX_1])))
@@ -1015,7 +1039,7 @@ inline bool IsNeutralEffectTargetPositive(uint32 etarget, const WorldObject* cas
     return !caster->CanAttackSpell(static_cast<const Unit*>(target));
 }
 
-inline bool IsPositiveEffectTargetMode(const SpellEntry* entry, SpellEffectIndex effIndex, const WorldObject* caster = nullptr, const WorldObject* target = nullptr, bool recursive = false)
+inline bool CalculatePositiveEffectTargetMode(const SpellEntry* entry, SpellEffectIndex effIndex, const WorldObject* caster = nullptr, const WorldObject* target = nullptr, bool recursive = false)
 {
     if (!entry)
         return false;
@@ -1031,7 +1055,7 @@ inline bool IsPositiveEffectTargetMode(const SpellEntry* entry, SpellEffectIndex
             {
                 for (uint32 i = EFFECT_INDEX_0; i < MAX_EFFECT_INDEX; ++i)
                 {
-                    if (!IsPositiveEffectTargetMode(triggered, SpellEffectIndex(i), caster, target, true))
+                    if (!CalculatePositiveEffectTargetMode(triggered, SpellEffectIndex(i), caster, target, true))
                         return false;
                 }
             }
@@ -1062,7 +1086,19 @@ inline bool IsPositiveEffectTargetMode(const SpellEntry* entry, SpellEffectIndex
     return true;
 }
 
-inline bool IsPositiveEffect(const SpellEntry* spellproto, SpellEffectIndex effIndex, const WorldObject* caster = nullptr, const WorldObject* target = nullptr)
+inline bool IsPositiveEffectTargetMode(const SpellEntry* entry, SpellEffectIndex effIndex, const WorldObject* caster = nullptr, const WorldObject* target = nullptr)
+{
+    if (!entry)
+        return false;
+
+    if (SpellClassification const* classification = GetSpellClassification(entry->Id))
+        if (classification->staticEffects & (1 << effIndex))
+            return (classification->positiveTargetModes & (1 << effIndex)) != 0;
+
+    return CalculatePositiveEffectTargetMode(entry, effIndex, caster, target);
+}
+
+inline bool CalculatePositiveEffect(const SpellEntry* spellproto, SpellEffectIndex effIndex, const WorldObject* caster = nullptr, const WorldObject* target = nullptr)
 {
     if (!spellproto)
         return false;
@@ -1219,7 +1255,19 @@ inline bool IsPositiveEffect(const SpellEntry* spellproto, SpellEffectIndex effI
     }
 
     // Generic effect check: negative on negative targets, positive on positive targets
-    return IsPositiveEffectTargetMode(spellproto, effIndex, caster, target);
+    return CalculatePositiveEffectTargetMode(spellproto, effIndex, caster, target);
+}
+
+inline bool IsPositiveEffect(const SpellEntry* spellproto, SpellEffectIndex effIndex, const WorldObject* caster = nullptr, const WorldObject* target = nullptr)
+{
+    if (!spellproto)
+        return false;
+
+    if (SpellClassification const* classification = GetSpellClassification(spellproto->Id))
+        if (classification->staticEffects & (1 << effIndex))
+            return (classification->positiveEffects & (1 << effIndex)) != 0;
+
+    return CalculatePositiveEffect(spellproto, effIndex, caster, target);
 }
 
 inline bool IsPositiveAuraEffect(const SpellEntry* entry, SpellEffectIndex effIndex, const WorldObject* /*caster*/ = nullptr, const WorldObject* /*target*/ = nullptr)
@@ -2144,6 +2192,16 @@ class SpellMgr
             return 1.0f;
         }
 
+        SpellClassification const* GetSpellClassification(uint32 spellId) const
+        {
+            if (spellId >= mSpellClassifications.size() || !(mSpellClassifications[spellId].flags & SPELL_CLASSIFICATION_LOADED))
+                return nullptr;
+            return &mSpellClassifications[spellId];
+        }
+
+        // changes with every (re)load of the classifications, cached proc flags are stale when it differs
+        uint32 GetSpellClassificationGeneration() const { return mSpellClassificationGeneration; }
+
         // Spell proc events
         SpellProcEventEntry const* GetSpellProcEvent(uint32 spellId) const
         {
@@ -2455,6 +2513,7 @@ class SpellMgr
         void LoadPetLevelupSpellMap();
         void LoadPetDefaultSpells();
         void LoadSpellAreas();
+        void LoadSpellClassifications();                    // must be after LoadSpellElixirs and LoadSpellProcEvents
 
     private:
         bool LoadPetDefaultSpells_helper(CreatureInfo const* cInfo, PetDefaultSpellsEntry& petDefSpells);
@@ -2478,6 +2537,8 @@ class SpellMgr
         SpellAreaMap         mSpellAreaMap;
         SpellAreaForAuraMap  mSpellAreaForAuraMap;
         SpellAreaForAreaMap  mSpellAreaForAreaMap;
+        std::vector<SpellClassification> mSpellClassifications; // indexed by spell id
+        uint32 mSpellClassificationGeneration;
 };
 
 #define sSpellMgr SpellMgr::Instance()
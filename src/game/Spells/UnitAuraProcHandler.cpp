@@ -351,6 +351,7 @@ pAuraProcHandler AuraProcHandler[TOTAL_AURAS] =
 
 struct ProcTriggeredData
 {
+    ProcTriggeredData() : spellProcEvent(nullptr), triggeredByHolder(nullptr) {}
     ProcTriggeredData(SpellProcEventEntry const* _spellProcEvent, SpellAuraHolder* _triggeredByHolder)
         : spellProcEvent(_spellProcEvent), triggeredByHolder(_triggeredByHolder)
     {}
@@ -358,7 +359,8 @@ struct ProcTriggeredData
     SpellAuraHolder* triggeredByHolder;
 };
 
-typedef std::list< ProcTriggeredData > ProcTriggeredList;
+// triggered holders of one proc call fit on the stack for nearly all units
+#define MAX_STACK_PROC_TRIGGERED 16
 
 uint32 createProcExtendMask(SpellNonMeleeDamage* damageInfo, SpellMissInfo missCondition)
 {
@@ -524,40 +526,118 @@ ProcExecutionData::ProcExecutionData(ProcSystemArguments& data, bool isVictim) :
     }
 }
 
+void Unit::AddProcHolder(SpellAuraHolder* holder)
+{
+    SpellEntry const* spellProto = holder->GetSpellProto();
+
+    ProcHolderEntry entry;
+    entry.holder = holder;
+    if (SpellClassification const* classification = sSpellMgr.GetSpellClassification(spellProto->Id))
+        entry.procFlags = classification->procFlags;
+    else
+    {
+        SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(spellProto->Id);
+        entry.procFlags = spellProcEvent && spellProcEvent->procFlags ? spellProcEvent->procFlags : spellProto->procFlags;
+    }
+    entry.interruptedByDamage = (spellProto->AuraInterruptFlags & AURA_INTERRUPT_FLAG_DAMAGE) != 0;
+    if (!entry.procFlags && !entry.interruptedByDamage)
+        return;
+
+    // same position as in the holder map, after holders of the same spell
+    auto itr = std::upper_bound(m_procHolders.begin(), m_procHolders.end(), holder->GetId(), [](uint32 spellId, ProcHolderEntry const& other)
+    {
+        return spellId < other.holder->GetId();
+    });
+    m_procHolders.insert(itr, entry);
+
+    m_procHolderFlags |= entry.procFlags;
+    if (entry.interruptedByDamage)
+        ++m_procHolderDamageInterrupts;
+}
+
+void Unit::RemoveProcHolder(SpellAuraHolder* holder)
+{
+    auto itr = std::find_if(m_procHolders.begin(), m_procHolders.end(), [holder](ProcHolderEntry const& entry) { return entry.holder == holder; });
+    if (itr == m_procHolders.end())
+        return;
+
+    if (itr->interruptedByDamage)
+        --m_procHolderDamageInterrupts;
+    m_procHolders.erase(itr);
+
+    m_procHolderFlags = 0;
+    for (ProcHolderEntry const& entry : m_procHolders)
+        m_procHolderFlags |= entry.procFlags;
+}
+
+void Unit::RebuildProcHolders()
+{
+    m_procHolders.clear();
+    m_procHolderFlags = 0;
+    m_procHolderDamageInterrupts = 0;
+    m_procHolderGeneration = sSpellMgr.GetSpellClassificationGeneration();
+
+    for (auto& itr : m_spellAuraHolders)
+        AddProcHolder(itr.second);
+}
+
 void Unit::ProcDamageAndSpellFor(ProcSystemArguments& argData, bool isVictim)
 {
+    // spell_proc_event was reloaded since the holders were indexed
+    if (m_procHolderGeneration != sSpellMgr.GetSpellClassificationGeneration())
+        RebuildProcHolders();
+
     ProcExecutionData execData(argData, isVictim);
 
-    ProcTriggeredList procTriggered;
+    // only process damage case on victim
+    bool damageInterrupts = m_procHolderDamageInterrupts && isVictim && (execData.procFlags & PROC_FLAG_TAKEN_ANY_DAMAGE) &&
+        !(execData.procSpell && execData.procSpell->HasAttribute(SPELL_ATTR_EX4_DAMAGE_DOESNT_BREAK_AURAS));
+
+    // Nothing can react
+    if (!(m_procHolderFlags & execData.procFlags) && !damageInterrupts)
+        return;
+
+    ProcTriggeredData stackProcTriggered[MAX_STACK_PROC_TRIGGERED];
+    std::vector<ProcTriggeredData> heapProcTriggered;
+    ProcTriggeredData* procTriggered = stackProcTriggered;
+    if (m_procHolders.size() > MAX_STACK_PROC_TRIGGERED)
+    {
+        heapProcTriggered.resize(m_procHolders.size());
+        procTriggered = heapProcTriggered.data();
+    }
+    uint32 procTriggeredCount = 0;
+
     std::vector<SpellAuraHolder*> removedHolders;
-    // Fill procTriggered list
-    for (SpellAuraHolderMap::const_iterator itr = GetSpellAuraHolderMap().begin(); itr != GetSpellAuraHolderMap().end(); ++itr)
+    // Fill procTriggered list, holders without matching proc flags can only be removed by damage
+    for (ProcHolderEntry const& entry : m_procHolders)
     {
+        SpellAuraHolder* holder = entry.holder;
+        if (!(entry.procFlags & execData.procFlags) && !(damageInterrupts && entry.interruptedByDamage))
+            continue;
+
         // skip deleted auras (possible at recursive triggered call
-        if (itr->second->GetState() != SPELLAURAHOLDER_STATE_READY || itr->second->IsDeleted())
+        if (holder->GetState() != SPELLAURAHOLDER_STATE_READY || holder->IsDeleted())
             continue;
 
         SpellProcEventEntry const* spellProcEvent = nullptr;
-        if (!IsTriggeredAtSpellProcEvent(execData, itr->second, spellProcEvent))
+        if (!(entry.procFlags & execData.procFlags) || !IsTriggeredAtSpellProcEvent(execData, holder, spellProcEvent))
         {
             // spell seem not managed by proc system, although some case need to be handled
-
-            // only process damage case on victim
-            if (!isVictim || !(execData.procFlags & PROC_FLAG_TAKEN_ANY_DAMAGE) || (execData.procSpell && execData.procSpell->HasAttribute(SPELL_ATTR_EX4_DAMAGE_DOESNT_BREAK_AURAS)))
+            if (!damageInterrupts || !entry.interruptedByDamage)
                 continue;
 
-            const SpellEntry* se = itr->second->GetSpellProto();
+            const SpellEntry* se = holder->GetSpellProto();
 
             // check if the aura is interruptible by damage and if its not just added by this spell (spell who is responsible for this damage is procSpell)
-            if (se->AuraInterruptFlags & AURA_INTERRUPT_FLAG_DAMAGE && (!execData.procSpell || execData.procSpell->Id != se->Id))
+            if (!execData.procSpell || execData.procSpell->Id != se->Id)
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_SPELL_CAST, "ProcDamageAndSpell: Added Spell %u to 'remove aura due to spell' list! Reason: Damage received.", se->Id);
-                removedHolders.push_back(itr->second);
+                removedHolders.push_back(holder);
             }
             continue;
         }
 
-        procTriggered.push_back(ProcTriggeredData(spellProcEvent, itr->second));
+        procTriggered[procTriggeredCount++] = ProcTriggeredData(spellProcEvent, holder);
     }
 
     for (auto holder : removedHolders)
@@ -565,18 +645,18 @@ void Unit::ProcDamageAndSpellFor(ProcSystemArguments& argData, bool isVictim)
             RemoveSpellAuraHolder(holder);
 
     // Nothing found
-    if (procTriggered.empty())
+    if (!procTriggeredCount)
         return;
 
     // Handle effects proceed this time
-    for (ProcTriggeredList::const_iterator itr = procTriggered.begin(); itr != procTriggered.end(); ++itr)
+    for (uint32 index = 0; index < procTriggeredCount; ++index)
     {
         // Some auras can be deleted in function called in this loop (except first, ofc)
-        SpellAuraHolder* triggeredByHolder = itr->triggeredByHolder;
+        SpellAuraHolder* triggeredByHolder = procTriggered[index].triggeredByHolder;
         if (triggeredByHolder->IsDeleted())
             continue;
 
-        SpellProcEventEntry const* spellProcEvent = itr->spellProcEvent;
+        SpellProcEventEntry const* spellProcEvent = procTriggered[index].spellProcEvent;
         bool useCharges = triggeredByHolder->GetAuraCharges() > 0;
         bool procSuccess = true;
         bool anyAuraProc = false;
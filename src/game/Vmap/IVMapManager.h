@@ -20,7 +20,9 @@
 #define _IVMAPMANAGER_H
 
 #include <string>
+#include <vector>
 #include <Platform/Define.h>
+#include <G3D/Vector3.h>
 
 //===========================================================
 
@@ -60,6 +62,10 @@ namespace VMAP
             virtual void unloadMap(unsigned int pMapId) = 0;
 
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model) = 0;
+            /**
+            check line of sight from every source position to x,y,z at once, results[i] holds the result of sources[i]
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, std::vector<G3D::Vector3> const& sources, float x, float y, float z, std::vector<bool>& results, bool ignoreM2Model) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
             test if we hit an object. return true if we hit one. rx,ry,rz will hold the hit position or the dest position, if no intersection was found
@@ -48,6 +48,16 @@ namespace VMAP
             ModelInstance* prims;
     };
 
+    class MapBoxCallback
+    {
+        public:
+            MapBoxCallback(std::vector<uint32>& entries): entries(entries) {}
+            void operator()(uint32 entry) { entries.push_back(entry); }
+
+        protected:
+            std::vector<uint32>& entries;
+    };
+
     class AreaInfoCallback
     {
         public:
@@ -165,6 +175,48 @@ namespace VMAP
     }
     //=========================================================
     /**
+    Check line of sight from every source to one destination. The tree is walked once for the box around
+    all rays, then each ray is only tested against the model instances found there.
+    */
+
+    void StaticMapTree::isInLineOfSight(std::vector<Vector3> const& sources, Vector3 const& dest, std::vector<bool>& results, bool ignoreM2Model) const
+    {
+        results.assign(sources.size(), true);
+        if (sources.empty())
+            return;
+
+        G3D::AABox box(dest);
+        for (auto const& source : sources)
+            box.merge(source);
+
+        std::vector<uint32> candidates;
+        MapBoxCallback boxCallback(candidates);
+        iTree.intersectBox(box, boxCallback);
+        if (candidates.empty())
+            return;
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            float maxDist = (dest - sources[i]).magnitude();
+            // valid map coords should *never ever* produce float overflow, but this would produce NaNs too:
+            MANGOS_ASSERT(maxDist < std::numeric_limits<float>::max());
+            if (maxDist < 1e-10f)
+                continue;
+
+            G3D::Ray ray = G3D::Ray::fromOriginAndDirection(sources[i], (dest - sources[i]) / maxDist);
+            for (uint32 entry : candidates)
+            {
+                float distance = maxDist;
+                if (iTreeValues[entry].intersectRay(ray, distance, true, ignoreM2Model))
+                {
+                    results[i] = false;
+                    break;
+                }
+            }
+        }
+    }
+    //=========================================================
+    /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
     Return the hit pos or the original dest pos
     */
@@ -171,6 +171,21 @@ namespace VMAP
         }
         return result;
     }
+
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, std::vector<Vector3> const& sources, float x, float y, float z, std::vector<bool>& results, bool ignoreM2Model)
+    {
+        results.assign(sources.size(), true);
+        if (!isLineOfSightCalcEnabled()) return;
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree != iInstanceMapTrees.end())
+        {
+            std::vector<Vector3> internalSources;
+            internalSources.reserve(sources.size());
+            for (auto const& source : sources)
+                internalSources.push_back(convertPositionToInternalRep(source.x, source.y, source.z));
+            instanceTree->second->isInLineOfSight(internalSources, convertPositionToInternalRep(x, y, z), results, ignoreM2Model);
+        }
+    }
     //=========================================================
     /**
     get the hit position and return true if we hit something
@@ -92,6 +92,7 @@ namespace VMAP
             void unloadMap(unsigned int pMapId) override;
 
             bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model) override;
+            void isInLineOfSight(unsigned int pMapId, std::vector<G3D::Vector3> const& sources, float x, float y, float z, std::vector<bool>& results, bool ignoreM2Model) override;
             /**
             fill the hit pos and return true, if an object was hit
             */
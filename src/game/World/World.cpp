@@ -623,6 +623,10 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_UINT32_NUM_MAP_THREADS, "MapUpdate.Threads", 3);
+    setConfig(CONFIG_UINT32_NUM_MAP_REGION_THREADS, "MapUpdate.Regions.Threads", 0);
+    setConfig(CONFIG_BOOL_MAP_REGIONS_BUILD_PACKETS, "MapUpdate.Regions.BuildPackets", true);
+    setConfig(CONFIG_UINT32_NUM_GRID_PREFETCH_THREADS, "MapUpdate.GridPrefetch.Threads", 1);
+    setConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD, "MapUpdate.GridPrefetch.LookAhead", 5);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_ORANGE, "SkillChance.Orange", 100);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_YELLOW, "SkillChance.Yellow", 75);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_GREEN,  "SkillChance.Green",  25);
@@ -858,6 +862,7 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK, "vmap.enableIndoorCheck", true);
+    setConfig(CONFIG_BOOL_VMAP_LOS_CACHE, "vmap.enableLOSCache", true);
     bool enableLOS = sConfig.GetBoolDefault("vmap.enableLOS", false);
     bool enableHeight = sConfig.GetBoolDefault("vmap.enableHeight", false);
     std::string ignoreSpellIds = sConfig.GetStringDefault("vmap.ignoreSpellIds");
@@ -872,6 +877,8 @@ void World::LoadConfigSettings(bool reload)
                    enableLOS, enableHeight, getConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK) ? 1 : 0);
     sLog.outString("WORLD: VMap data directory is: %svmaps", m_dataPath.c_str());
 
+    setConfig(CONFIG_BOOL_MAP_FILES_MAPPED, "MapFiles.Mapped", true);
+
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
     std::string ignoreMapIds = sConfig.GetStringDefault("mmap.ignoreMapIds");
     MMAP::MMapFactory::preventPathfindingOnMaps(ignoreMapIds.c_str());
@@ -879,6 +886,8 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_BOOL_PATH_FIND_OPTIMIZE, "PathFinder.OptimizePath", true);
     setConfig(CONFIG_BOOL_PATH_FIND_NORMALIZE_Z, "PathFinder.NormalizeZ", false);
+    setConfig(CONFIG_UINT32_NUM_PATH_SEARCH_THREADS, "PathFinder.Threads", 1);
+    setConfig(CONFIG_UINT32_PATH_FIND_CACHE_SIZE, "PathFinder.CacheSize", 256);
 
     sLog.outString();
 }
@@ -1018,6 +1027,9 @@ void World::SetInitialWorldSettings()
     sLog.outString("Loading Spell Proc Item Enchant...");
     sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
 
+    sLog.outString("Loading Spell Classifications...");
+    sSpellMgr.LoadSpellClassifications();                   // must be after LoadSpellElixirs and LoadSpellProcEvents
+
     sLog.outString("Loading Aggro Spells Definitions...");
     sSpellMgr.LoadSpellThreats();
 
@@ -1393,6 +1405,13 @@ void World::SetInitialWorldSettings()
     sLog.outString("Starting Outdoor PvP System");          // should be before loading maps
     sOutdoorPvPMgr.InitOutdoorPvP();
 
+    ///- Map the terrain of the busiest maps up front
+    if (getConfig(CONFIG_BOOL_MAP_FILES_MAPPED))
+    {
+        std::string prefaultMapIds = sConfig.GetStringDefault("MapFiles.Prefault");
+        sTerrainMgr.PrefaultMapFiles(prefaultMapIds.c_str());
+    }
+
     ///- Initialize MapManager
     sLog.outString("Starting Map System");
     sMapMgr.Initialize();
@@ -1634,6 +1653,10 @@ void World::Update(uint32 diff)
 
     // cleanup unused GridMap objects as well as VMaps
     sTerrainMgr.Update(diff);
+
+    // send what the sessions and world systems queued during this tick
+    for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+        itr->second->FlushPackets();
 }
 
 namespace MaNGOS
@@ -142,6 +142,11 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK,
     CONFIG_UINT32_UPTIME_UPDATE,
     CONFIG_UINT32_NUM_MAP_THREADS,
+    CONFIG_UINT32_NUM_MAP_REGION_THREADS,
+    CONFIG_UINT32_NUM_GRID_PREFETCH_THREADS,
+    CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD,
+    CONFIG_UINT32_NUM_PATH_SEARCH_THREADS,
+    CONFIG_UINT32_PATH_FIND_CACHE_SIZE,
     CONFIG_UINT32_AUCTION_DEPOSIT_MIN,
     CONFIG_UINT32_SKILL_CHANCE_ORANGE,
     CONFIG_UINT32_SKILL_CHANCE_YELLOW,
@@ -366,6 +371,8 @@ enum eConfigBoolValues
     CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT,
     CONFIG_BOOL_CLEAN_CHARACTER_DB,
     CONFIG_BOOL_VMAP_INDOOR_CHECK,
+    CONFIG_BOOL_VMAP_LOS_CACHE,
+    CONFIG_BOOL_MAP_FILES_MAPPED,
     CONFIG_BOOL_PET_UNSUMMON_AT_MOUNT,
     CONFIG_BOOL_PET_ATTACK_FROM_BEHIND,
     CONFIG_BOOL_AUTO_DOWNRANK,
@@ -373,6 +380,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_PLAYER_COMMANDS,
     CONFIG_BOOL_PATH_FIND_OPTIMIZE,
     CONFIG_BOOL_PATH_FIND_NORMALIZE_Z,
+    CONFIG_BOOL_MAP_REGIONS_BUILD_PACKETS,
     CONFIG_BOOL_VALUE_COUNT
 };
 
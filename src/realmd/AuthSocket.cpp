@@ -24,6 +24,7 @@
 #include "Auth/HMACSHA1.h"
 #include "Auth/base32.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 #include "Config/Config.h"
 #include "Log.h"
 #include "RealmList.h"
@@ -33,6 +34,7 @@
 
 #include <openssl/md5.h>
 #include <ctime>
+#include <memory>
 #include <utility>
 
 //#include "Util.h" -- for commented utf8ToUpperOnlyLatin
@@ -181,9 +183,80 @@ typedef struct AuthHandler
 
 std::array<uint8, 16> VersionChallenge = { { 0xBA, 0xA3, 0x1E, 0x99, 0xA0, 0x0B, 0x21, 0x57, 0xFC, 0x37, 0x3F, 0xB3, 0x69, 0xCD, 0xD2, 0xF1 } };
 
+enum LogonChallengeQuery
+{
+    LOGON_CHALLENGE_QUERY_IP_BANNED,
+    LOGON_CHALLENGE_QUERY_ACCOUNT,
+    LOGON_CHALLENGE_QUERY_CHARACTERS,
+
+    MAX_LOGON_CHALLENGE_QUERY
+};
+
+/// Hands async login database results back to the network thread of the socket which waits for them
+class AuthQueryHandler
+{
+    public:
+        void HandleLogonChallengeCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder, std::shared_ptr<AuthSocket> socket)
+        {
+            std::shared_ptr<SqlQueryHolder> holderPtr(holder);
+            socket->ResumeRead([socket, holderPtr]() { socket->_HandleLogonChallengeResult(*holderPtr); });
+        }
+
+        void HandleReconnectChallengeCallback(QueryResult* result, std::shared_ptr<AuthSocket> socket)
+        {
+            std::shared_ptr<QueryResult> resultPtr(result);
+            socket->ResumeRead([socket, resultPtr]() { socket->_HandleReconnectChallengeResult(resultPtr.get()); });
+        }
+
+        void HandleRealmListCallback(QueryResult* result, std::shared_ptr<AuthSocket> socket)
+        {
+            std::shared_ptr<QueryResult> resultPtr(result);
+            socket->ResumeRead([socket, resultPtr]() { socket->_HandleRealmListResult(resultPtr.get()); });
+        }
+
+        void HandleFailedLoginCallback(QueryResult* result, std::string login, std::string address);
+} authQueryHandler;
+
+/// Bans the account or IP once the failed logins reach WrongPass.MaxCount
+void AuthQueryHandler::HandleFailedLoginCallback(QueryResult* result, std::string login, std::string address)
+{
+    if (!result)
+        return;
+
+    Field* fields = result->Fetch();
+    uint32 failed_logins = fields[1].GetUInt32();
+
+    if (failed_logins >= uint32(sConfig.GetIntDefault("WrongPass.MaxCount", 0)))
+    {
+        uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+        bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+
+        if (WrongPassBanType)
+        {
+            uint32 acc_id = fields[0].GetUInt32();
+            LoginDatabase.PExecute("INSERT INTO account_banned(account_id, banned_at, expires_at, banned_by, reason, active)"
+                                   "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
+                                   acc_id, WrongPassBanTime);
+            BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
+                      login.c_str(), WrongPassBanTime, failed_logins);
+        }
+        else
+        {
+            std::string current_ip = address;
+            LoginDatabase.escape_string(current_ip);
+            LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+                                   current_ip.c_str(), WrongPassBanTime);
+            BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
+                      current_ip.c_str(), WrongPassBanTime, login.c_str(), failed_logins);
+        }
+    }
+
+    delete result;
+}
+
 /// Constructor - set the N and g values for SRP6
 AuthSocket::AuthSocket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler)
-    : Socket(service, std::move(closeHandler)), _status(STATUS_CHALLENGE), _build(0), _accountSecurityLevel(SEC_PLAYER)
+    : Socket(service, std::move(closeHandler)), _status(STATUS_CHALLENGE), _build(0), _accountId(0), _accountSecurityLevel(SEC_PLAYER)
 {
 }
 
@@ -207,7 +280,7 @@ bool AuthSocket::ProcessIncomingData()
 
     // the purpose of this loop is to handle multiple opcodes in the same tcp packet,
     // which presumably the client will never do, but lets support it anyway! \o/
-    while (ReadLengthRemaining() > 0)
+    while (ReadLengthRemaining() > 0 && !IsReadSuspended())
     {
         const eAuthCmd cmd = static_cast<eAuthCmd>(*InPeak());
         int i;
@@ -334,8 +407,6 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
-
     _login = (const char*)ch->I;
     _build = ch->build;
 
@@ -356,145 +427,162 @@ bool AuthSocket::_HandleLogonChallenge()
     _safelogin = _login;
     LoginDatabase.escape_string(_safelogin);
 
+    _localizationName.resize(4);
+    for (int i = 0; i < 4; ++i)
+        _localizationName[i] = ch->country[4 - i - 1];
+
+    ///- Look up the ip ban, the account with its active ban and its characters per realm in one go,
+    // reading from the socket is suspended until the results are handled
+    // No SQL injection (escaped user name, IP address as passed by the socket)
+    SqlQueryHolder* holder = new SqlQueryHolder;
+    holder->SetSize(MAX_LOGON_CHALLENGE_QUERY);
+    holder->SetPQuery(LOGON_CHALLENGE_QUERY_IP_BANNED, "SELECT expires_at FROM ip_banned "
+                      "WHERE (expires_at = banned_at OR expires_at > UNIX_TIMESTAMP()) AND ip = '%s'", m_address.c_str());
+    holder->SetPQuery(LOGON_CHALLENGE_QUERY_ACCOUNT, "SELECT a.id,a.locked,a.last_ip,a.gmlevel,a.v,a.s,a.token,b.banned_at,b.expires_at FROM account a "
+                      "LEFT JOIN account_banned b ON b.account_id = a.id AND b.active = 1 AND (b.expires_at > UNIX_TIMESTAMP() OR b.expires_at = b.banned_at) "
+                      "WHERE a.username = '%s'", _safelogin.c_str());
+    holder->SetPQuery(LOGON_CHALLENGE_QUERY_CHARACTERS, "SELECT rc.realmid,rc.numchars FROM realmcharacters rc "
+                      "JOIN account a ON a.id = rc.acctid WHERE a.username = '%s'", _safelogin.c_str());
+
+    SuspendRead();
+    if (!LoginDatabase.DelayQueryHolder(&authQueryHandler, &AuthQueryHandler::HandleLogonChallengeCallback, holder, shared<AuthSocket>()))
+    {
+        delete holder;
+        return false;
+    }
+
+    return true;
+}
+
+void AuthSocket::_HandleLogonChallengeResult(SqlQueryHolder& holder)
+{
+    std::unique_ptr<QueryResult> ip_banned_result(holder.GetResult(LOGON_CHALLENGE_QUERY_IP_BANNED));
+    std::unique_ptr<QueryResult> result(holder.GetResult(LOGON_CHALLENGE_QUERY_ACCOUNT));
+    std::unique_ptr<QueryResult> characters_result(holder.GetResult(LOGON_CHALLENGE_QUERY_CHARACTERS));
+
+    ByteBuffer pkt;
     pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
     pkt << (uint8) 0x00;
 
     ///- Verify that this IP is not in the ip_banned table
-    // No SQL injection possible (paste the IP address as passed by the socket)
-    std::unique_ptr<QueryResult> ip_banned_result(LoginDatabase.PQuery("SELECT expires_at FROM ip_banned "
-            "WHERE (expires_at = banned_at OR expires_at > UNIX_TIMESTAMP()) AND ip = '%s'", m_address.c_str()));
-
     if (ip_banned_result)
     {
         pkt << (uint8)WOW_FAIL_FAIL_NOACCESS;
         BASIC_LOG("[AuthChallenge] Banned ip %s tries to login!", m_address.c_str());
     }
-    else
+    else if (result)
     {
-        ///- Get the account details from the account table
-        // No SQL injection (escaped user name)
-        QueryResult* result = LoginDatabase.PQuery("SELECT id,locked,last_ip,gmlevel,v,s,token FROM account WHERE username = '%s'", _safelogin.c_str());
-        if (result)
+        Field* fields = result->Fetch();
+
+        ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
+        bool locked = false;
+        if (fields[1].GetUInt8() == 1)                      // if ip is locked
         {
-            Field* fields = result->Fetch();
+            DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), fields[2].GetString());
+            DEBUG_LOG("[AuthChallenge] Player address is '%s'", m_address.c_str());
+            if (strcmp(fields[2].GetString(), m_address.c_str()))
+            {
+                DEBUG_LOG("[AuthChallenge] Account IP differs");
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
+                locked = true;
+            }
+            else
+                DEBUG_LOG("[AuthChallenge] Account IP matches");
+        }
+        else
+            DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
 
-            ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            if (fields[1].GetUInt8() == 1)               // if ip is locked
+        std::string databaseV = fields[4].GetCppString();
+        std::string databaseS = fields[5].GetCppString();
+        bool broken = false;
+
+        if (!srp.SetVerifier(databaseV.c_str()) || !srp.SetSalt(databaseS.c_str()))
+        {
+            pkt << (uint8)WOW_FAIL_FAIL_NOACCESS;
+            DEBUG_LOG("[AuthChallenge] Broken v/s values in database for account %s!", _login.c_str());
+            broken = true;
+        }
+
+        if (!locked && !broken)
+        {
+            ///- If the account is banned, reject the logon attempt
+            if (!fields[7].IsNULL())
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), fields[2].GetString());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", m_address.c_str());
-                if (strcmp(fields[2].GetString(), m_address.c_str()))
+                if (fields[7].GetUInt64() == fields[8].GetUInt64())
                 {
-                    DEBUG_LOG("[AuthChallenge] Account IP differs");
-                    pkt << (uint8) WOW_FAIL_SUSPENDED;
-                    locked = true;
+                    pkt << (uint8) WOW_FAIL_BANNED;
+                    BASIC_LOG("[AuthChallenge] Banned account %s tries to login!", _login.c_str());
                 }
                 else
-                    DEBUG_LOG("[AuthChallenge] Account IP matches");
+                {
+                    pkt << (uint8) WOW_FAIL_SUSPENDED;
+                    BASIC_LOG("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str());
+                }
             }
             else
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+            {
+                DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
 
-            std::string databaseV = fields[4].GetCppString();
-            std::string databaseS = fields[5].GetCppString();
-            bool broken = false;
+                BigNumber s;
+                s.SetHexStr(databaseS.c_str());
 
-            if (!srp.SetVerifier(databaseV.c_str()) || !srp.SetSalt(databaseS.c_str()))
-            {
-                pkt << (uint8)WOW_FAIL_FAIL_NOACCESS;
-                DEBUG_LOG("[AuthChallenge] Broken v/s values in database for account %s!", _login.c_str());
-                broken = true;
-            }
+                srp.CalculateHostPublicEphemeral();
 
-            if (!locked && !broken)
-            {
-                ///- If the account is banned, reject the logon attempt
-                QueryResult* banresult = LoginDatabase.PQuery("SELECT banned_at,expires_at FROM account_banned WHERE "
-                                         "account_id = %u AND active = 1 AND (expires_at > UNIX_TIMESTAMP() OR expires_at = banned_at)", fields[1].GetUInt32());
-                if (banresult)
+                ///- Fill the response packet with the result
+                pkt << uint8(WOW_SUCCESS);
+
+                // B may be calculated < 32B so we force minimal length to 32B
+                pkt.append(srp.GetHostPublicEphemeral().AsByteArray(32), 32);      // 32 bytes
+                pkt << uint8(1);
+                pkt.append(srp.GetGeneratorModulo().AsByteArray(), 1);
+                pkt << uint8(32);
+                pkt.append(srp.GetPrime().AsByteArray(32), 32);
+                pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
+                pkt.append(VersionChallenge.data(), VersionChallenge.size());
+                uint8 securityFlags = 0;
+
+                _token = fields[6].GetCppString();
+                if (!_token.empty() && _build >= 8606) // authenticator was added in 2.4.3
+                    securityFlags = SECURITY_FLAG_AUTHENTICATOR;
+
+                pkt << uint8(securityFlags);                    // security flags (0x0...0x04)
+
+                if (securityFlags & SECURITY_FLAG_PIN)          // PIN input
                 {
-                    if ((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        pkt << (uint8) WOW_FAIL_BANNED;
-                        BASIC_LOG("[AuthChallenge] Banned account %s tries to login!", _login.c_str());
-                    }
-                    else
-                    {
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
-                        BASIC_LOG("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str());
-                    }
-
-                    delete banresult;
+                    pkt << uint32(0);
+                    pkt << uint64(0);
+                    pkt << uint64(0);
                 }
-                else
+
+                if (securityFlags & SECURITY_FLAG_UNK)          // Matrix input
                 {
-                    DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint64(0);
+                }
 
-                    BigNumber s;
-                    s.SetHexStr(databaseS.c_str());
+                if (securityFlags & SECURITY_FLAG_AUTHENTICATOR)    // Authenticator input
+                    pkt << uint8(1);
 
-                    srp.CalculateHostPublicEphemeral();
+                uint8 secLevel = fields[3].GetUInt8();
+                _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
 
-                    ///- Fill the response packet with the result
-                    pkt << uint8(WOW_SUCCESS);
+                BASIC_LOG("[AuthChallenge] account %s is using '%s' locale (%u)", _login.c_str(), _localizationName.c_str(), GetLocaleByName(_localizationName));
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(srp.GetHostPublicEphemeral().AsByteArray(32), 32);      // 32 bytes
-                    pkt << uint8(1);
-                    pkt.append(srp.GetGeneratorModulo().AsByteArray(), 1);
-                    pkt << uint8(32);
-                    pkt.append(srp.GetPrime().AsByteArray(32), 32);
-                    pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
-                    pkt.append(VersionChallenge.data(), VersionChallenge.size());
-                    uint8 securityFlags = 0;
-
-                    _token = fields[6].GetCppString();
-                    if (!_token.empty() && _build >= 8606) // authenticator was added in 2.4.3
-                        securityFlags = SECURITY_FLAG_AUTHENTICATOR;
-
-                    pkt << uint8(securityFlags);                    // security flags (0x0...0x04)
-
-                    if (securityFlags & SECURITY_FLAG_PIN)          // PIN input
-                    {
-                        pkt << uint32(0);
-                        pkt << uint64(0);
-                        pkt << uint64(0);
-                    }
-
-                    if (securityFlags & SECURITY_FLAG_UNK)          // Matrix input
-                    {
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint64(0);
-                    }
-
-                    if (securityFlags & SECURITY_FLAG_AUTHENTICATOR)    // Authenticator input
-                        pkt << uint8(1);
-
-                    uint8 secLevel = fields[3].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
-
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4 - i - 1];
-
-                    BASIC_LOG("[AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", _login.c_str(), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
-
-                    ///- All good, await client's proof
-                    _status = STATUS_LOGON_PROOF;
-                }
+                _accountId = fields[0].GetUInt32();
+                sRealmList.SetCharacterCounts(_accountId, characters_result.get());
+
+                ///- All good, await client's proof
+                _status = STATUS_LOGON_PROOF;
             }
-            delete result;
         }
-        else                                                // no account
-            pkt << (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
     }
+    else                                                    // no account
+        pkt << (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
 
     Write((const char*)pkt.contents(), pkt.size());
-    return true;
 }
 
 /// Logon Proof command handler
@@ -602,37 +690,8 @@ bool AuthSocket::_HandleLogonProof()
             // Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
             LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'", _safelogin.c_str());
 
-            if (QueryResult* loginfail = LoginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()))
-            {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
-
-                if (failed_logins >= MaxWrongPassCount)
-                {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
-
-                    if (WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO account_banned(account_id, banned_at, expires_at, banned_by, reason, active)"
-                                               "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
-                                               acc_id, WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                                  _login.c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = m_address;
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                                               current_ip.c_str(), WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                                  current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
-                    }
-                }
-                delete loginfail;
-            }
+            LoginDatabase.AsyncPQuery(&authQueryHandler, &AuthQueryHandler::HandleFailedLoginCallback, _login, m_address,
+                                      "SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str());
         }
     }
     return true;
@@ -681,19 +740,24 @@ bool AuthSocket::_HandleReconnectChallenge()
     EndianConvert(ch->build);
     _build = ch->build;
 
-    QueryResult* result = LoginDatabase.PQuery("SELECT sessionkey FROM account WHERE username = '%s'", _safelogin.c_str());
+    SuspendRead();
+    return LoginDatabase.AsyncPQuery(&authQueryHandler, &AuthQueryHandler::HandleReconnectChallengeCallback, shared<AuthSocket>(),
+                                     "SELECT id, sessionkey FROM account WHERE username = '%s'", _safelogin.c_str());
+}
 
+void AuthSocket::_HandleReconnectChallengeResult(QueryResult* result)
+{
     // Stop if the account is not found
     if (!result)
     {
         sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", _login.c_str());
         Close();
-        return false;
+        return;
     }
 
     Field* fields = result->Fetch();
-    srp.SetStrongSessionKey(fields[0].GetString());
-    delete result;
+    _accountId = fields[0].GetUInt32();
+    srp.SetStrongSessionKey(fields[1].GetString());
 
     ///- All good, await client's proof
     _status = STATUS_RECON_PROOF;
@@ -706,7 +770,6 @@ bool AuthSocket::_HandleReconnectChallenge()
     pkt.append(_reconnectProof.AsByteArray(16), 16);        // 16 bytes random
     pkt.append(VersionChallenge.data(), VersionChallenge.size());
     Write((const char*)pkt.contents(), pkt.size());
-    return true;
 }
 
 /// Reconnect Proof command handler
@@ -770,26 +833,34 @@ bool AuthSocket::_HandleRealmList()
 
     ReadSkip(5);
 
-    ///- Get the user id (else close the connection)
-    // No SQL injection (escaped user name)
+    ///- Update realm list if need
+    sRealmList.UpdateIfNeed();
 
-    QueryResult* result = LoginDatabase.PQuery("SELECT id FROM account WHERE username = '%s'", _safelogin.c_str());
-    if (!result)
+    ///- The characters per realm are usually loaded with the logon challenge, else load them for all realms at once
+    if (RealmList::RealmCharacterCounts const* characterCounts = sRealmList.GetCharacterCounts(_accountId))
     {
-        sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.", _login.c_str());
-        Close();
-        return false;
+        SendRealmList(*characterCounts);
+        sRealmList.DropCharacterCounts(_accountId);
+        return true;
     }
 
-    uint32 id = (*result)[0].GetUInt32();
-    delete result;
+    SuspendRead();
+    return LoginDatabase.AsyncPQuery(&authQueryHandler, &AuthQueryHandler::HandleRealmListCallback, shared<AuthSocket>(),
+                                     "SELECT realmid, numchars FROM realmcharacters WHERE acctid = '%u'", _accountId);
+}
 
-    ///- Update realm list if need
-    sRealmList.UpdateIfNeed();
+void AuthSocket::_HandleRealmListResult(QueryResult* result)
+{
+    sRealmList.SetCharacterCounts(_accountId, result);
+    SendRealmList(*sRealmList.GetCharacterCounts(_accountId));
+    sRealmList.DropCharacterCounts(_accountId);
+}
 
+void AuthSocket::SendRealmList(RealmList::RealmCharacterCounts const& characterCounts)
+{
     ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
     ByteBuffer pkt;
-    LoadRealmlist(pkt, id);
+    LoadRealmlist(pkt, characterCounts);
 
     ByteBuffer hdr;
     hdr << (uint8) CMD_REALM_LIST;
@@ -797,10 +868,9 @@ bool AuthSocket::_HandleRealmList()
     hdr.append(pkt);
 
     Write((const char*)hdr.contents(), hdr.size());
-    return true;
 }
 
-void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
+void AuthSocket::LoadRealmlist(ByteBuffer& pkt, RealmList::RealmCharacterCounts const& characterCounts)
 {
     switch (_build)
     {
@@ -813,18 +883,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
 
             for (const auto& i : sRealmList)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult* result = LoginDatabase.PQuery("SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i.second.m_ID, acctid);
-                if (result)
-                {
-                    Field* fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
+                RealmList::RealmCharacterCounts::const_iterator characters = characterCounts.find(i.second.m_ID);
+                uint8 AmountOfCharacters = characters != characterCounts.end() ? characters->second : 0;
 
                 bool ok_build = std::find(i.second.realmbuilds.begin(), i.second.realmbuilds.end(), _build) != i.second.realmbuilds.end();
 
@@ -874,18 +934,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
 
             for (const auto& i : sRealmList)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult* result = LoginDatabase.PQuery("SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i.second.m_ID, acctid);
-                if (result)
-                {
-                    Field* fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
+                RealmList::RealmCharacterCounts::const_iterator characters = characterCounts.find(i.second.m_ID);
+                uint8 AmountOfCharacters = characters != characterCounts.end() ? characters->second : 0;
 
                 bool ok_build = std::find(i.second.realmbuilds.begin(), i.second.realmbuilds.end(), _build) != i.second.realmbuilds.end();
 
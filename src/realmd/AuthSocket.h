@@ -28,6 +28,7 @@
 #include "Auth/Sha1.h"
 #include "SRP6/SRP6.h"
 #include "ByteBuffer.h"
+#include "RealmList.h"
 
 #include "Network/Socket.hpp"
 
@@ -37,6 +38,9 @@
 
 #define HMAC_RES_SIZE 20
 
+class QueryResult;
+class SqlQueryHolder;
+
 class AuthSocket : public MaNGOS::Socket
 {
     public:
@@ -45,7 +49,8 @@ class AuthSocket : public MaNGOS::Socket
         AuthSocket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler);
 
         void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer& pkt, uint32 acctid);
+        void LoadRealmlist(ByteBuffer& pkt, RealmList::RealmCharacterCounts const& characterCounts);
+        void SendRealmList(RealmList::RealmCharacterCounts const& characterCounts);
         int32 generateToken(char const* b32key);
 
         bool VerifyVersion(uint8 const* a, int32 aLength, uint8 const* versionProof, bool isReconnect);
@@ -54,6 +59,11 @@ class AuthSocket : public MaNGOS::Socket
         bool _HandleReconnectChallenge();
         bool _HandleReconnectProof();
         bool _HandleRealmList();
+
+        // continuations of the handlers above, run once their async login database queries are done
+        void _HandleLogonChallengeResult(SqlQueryHolder& holder);
+        void _HandleReconnectChallengeResult(QueryResult* result);
+        void _HandleRealmListResult(QueryResult* result);
         // data transfer handle for patch
 
         bool _HandleXferResume();
@@ -85,6 +95,7 @@ class AuthSocket : public MaNGOS::Socket
         // between enUS and enGB, which is important for the patch system
         std::string _localizationName;
         uint16 _build;
+        uint32 _accountId;
         AccountTypes _accountSecurityLevel;
 
         virtual bool ProcessIncomingData() override;
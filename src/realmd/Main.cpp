@@ -270,7 +270,7 @@ int main(int argc, char* argv[])
     LoginDatabase.AllowAsyncTransactions();
 
     // maximum counter for next ping
-    auto const numLoops = sConfig.GetIntDefault("MaxPingTime", 30) * MINUTE * 10;
+    auto const numLoops = sConfig.GetIntDefault("MaxPingTime", 30) * MINUTE * 100;
     uint32 loopCounter = 0;
 
 #ifndef _WIN32
@@ -285,7 +285,10 @@ int main(int argc, char* argv[])
             DETAIL_LOG("Ping MySQL to keep connection alive");
             LoginDatabase.Ping();
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // async login database results resume the waiting sockets from here, keep the wait short
+        LoginDatabase.ProcessResultQueue();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
 #ifdef _WIN32
         if (m_ServiceStatus == 0) stopEvent = true;
         while (m_ServiceStatus == 2) Sleep(1000);
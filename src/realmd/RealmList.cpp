@@ -141,13 +141,36 @@ void RealmList::UpdateIfNeed()
 
     m_NextUpdateTime = time(nullptr) + m_UpdateInterval;
 
-    // Clears Realm list
+    // Clears Realm list and the character counts loaded with it
     m_realms.clear();
+    m_characterCounts.clear();
 
     // Get the content of the realmlist table in the database
     UpdateRealms(false);
 }
 
+RealmList::RealmCharacterCounts const* RealmList::GetCharacterCounts(uint32 accountId) const
+{
+    auto itr = m_characterCounts.find(accountId);
+    return itr != m_characterCounts.end() ? &itr->second : nullptr;
+}
+
+void RealmList::SetCharacterCounts(uint32 accountId, QueryResult* result)
+{
+    RealmCharacterCounts& counts = m_characterCounts[accountId];
+    counts.clear();
+
+    if (!result)
+        return;
+
+    do
+    {
+        Field* fields = result->Fetch();
+        counts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+    }
+    while (result->NextRow());
+}
+
 void RealmList::UpdateRealms(bool init)
 {
     DETAIL_LOG("Updating Realm List...");
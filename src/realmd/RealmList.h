@@ -25,6 +25,9 @@
 
 #include "Common.h"
 #include <array>
+#include <unordered_map>
+
+class QueryResult;
 
 struct RealmBuildInfo
 {
@@ -60,6 +63,7 @@ class RealmList
 {
     public:
         typedef std::map<std::string, Realm> RealmMap;
+        typedef std::map<uint32, uint8> RealmCharacterCounts;    // realm id -> number of characters
 
         static RealmList& Instance();
 
@@ -73,11 +77,19 @@ class RealmList
         RealmMap::const_iterator begin() const { return m_realms.begin(); }
         RealmMap::const_iterator end() const { return m_realms.end(); }
         uint32 size() const { return m_realms.size(); }
+
+        /// Characters per realm of an account, kept until they are sent once.  nullptr if not loaded
+        RealmCharacterCounts const* GetCharacterCounts(uint32 accountId) const;
+        /// Stores the realmid, numchars rows of one account
+        void SetCharacterCounts(uint32 accountId, QueryResult* result);
+        /// Forgets the counts of an account, the next realm list request loads them again
+        void DropCharacterCounts(uint32 accountId) { m_characterCounts.erase(accountId); }
     private:
         void UpdateRealms(bool init);
         void UpdateRealm(uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, RealmFlags realmflags, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, const std::string& builds);
     private:
         RealmMap m_realms;                                  ///< Internal map of realms
+        std::unordered_map<uint32, RealmCharacterCounts> m_characterCounts;
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
 };
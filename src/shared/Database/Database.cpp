@@ -29,6 +29,8 @@
 #define MIN_CONNECTION_POOL_SIZE 1
 #define MAX_CONNECTION_POOL_SIZE 16
 
+#define MAX_BATCH_REQUEST_LEN (512*1024)
+
 //////////////////////////////////////////////////////////////////////////
 SqlPreparedStatement* SqlConnection::CreateStatement(const std::string& fmt)
 {
@@ -91,13 +93,101 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id)
     return pStmt->execute();
 }
 
+// split "INSERT INTO t (a, b) VALUES (?, ?)" into request head and single row template
+static bool SplitInsertFormat(const std::string& fmt, std::string& head, std::string& row)
+{
+    std::string upper(fmt);
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+    if (upper.compare(0, 6, "INSERT") != 0 && upper.compare(0, 7, "REPLACE") != 0)
+        return false;
+
+    // rows can't be appended to requests with trailing clauses
+    if (upper.find(" SELECT ") != std::string::npos || upper.find("ON DUPLICATE") != std::string::npos || upper.find("RETURNING") != std::string::npos)
+        return false;
+
+    size_t valuesPos = upper.rfind("VALUES");
+    if (valuesPos == std::string::npos)
+        return false;
+
+    size_t rowStart = fmt.find('(', valuesPos);
+    size_t rowEnd = fmt.rfind(')');
+    if (rowStart == std::string::npos || rowEnd == std::string::npos || rowEnd < rowStart)
+        return false;
+
+    if (fmt.find_first_not_of(" \t\r\n;", rowEnd + 1) != std::string::npos)
+        return false;
+
+    head = fmt.substr(0, rowStart);
+    row = fmt.substr(rowStart, rowEnd - rowStart + 1);
+    return true;
+}
+
+bool SqlConnection::ExecuteStmtBatch(int nIndex, const std::vector<const SqlStmtParameters*>& rows)
+{
+    if (nIndex == -1)
+        return false;
+
+    SqlPreparedStatement* pStmt = GetStmt(nIndex);
+
+    std::string head, row;
+    if (rows.size() < 2 || !SplitInsertFormat(pStmt->format(), head, row))
+    {
+        // not suitable for merging, reuse prepared statement for every parameter set
+        for (auto params : rows)
+        {
+            pStmt->bind(*params);
+            if (!pStmt->execute())
+                return false;
+        }
+        return true;
+    }
+
+    std::ostringstream request;
+    // keep float values exact, they are sent as text now
+    request.precision(17);
+
+    size_t nRows = 0;
+    for (auto params : rows)
+    {
+        if (nRows == 0)
+            request << head;
+        else
+            request << ", ";
+
+        SqlStmtParameters::ParameterContainer const& args = params->params();
+        size_t nArg = 0;
+        for (char c : row)
+        {
+            if (c == '?' && nArg < args.size())
+                SqlPlainPreparedStatement::DataToString(args[nArg++], request, *this);
+            else
+                request << c;
+        }
+
+        MANGOS_ASSERT(nArg == args.size());
+
+        // flush long requests before they hit server packet size limit
+        if (++nRows > 1 && request.tellp() > std::streampos(MAX_BATCH_REQUEST_LEN))
+        {
+            if (!Execute(request.str().c_str()))
+                return false;
+
+            request.str(std::string());
+            nRows = 0;
+        }
+    }
+
+    return nRows == 0 || Execute(request.str().c_str());
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -134,10 +224,25 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    // create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if (!m_pAsyncConn->Initialize(infoString))
-        return false;
+    // create and initialize connections for async requests
+    if (nAsyncConns < MIN_CONNECTION_POOL_SIZE)
+        nAsyncConns = MIN_CONNECTION_POOL_SIZE;
+    else if (nAsyncConns > MAX_CONNECTION_POOL_SIZE)
+        nAsyncConns = MAX_CONNECTION_POOL_SIZE;
+
+    for (int i = 0; i < nAsyncConns; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConnections.push_back(pConn);
+    }
+
+    m_pAsyncConn = m_pAsyncConnections[0];
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -150,7 +255,11 @@ void Database::StopServer()
     HaltDelayThread();
 
     delete m_pResultQueue;
-    delete m_pAsyncConn;
+
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
+        delete m_pAsyncConnection;
+
+    m_pAsyncConnections.clear();
 
     m_pResultQueue = nullptr;
     m_pAsyncConn = nullptr;
@@ -161,30 +270,40 @@ void Database::StopServer()
     m_pQueryConnections.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
+SqlDelayThread* Database::CreateDelayThread(SqlConnection* conn, bool pingDatabase)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn, pingDatabase);
 }
 
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(m_delayThreads.empty());
 
-    // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new MaNGOS::Thread(m_threadBody);
+    // New delay thread for delay execute on every async connection, first one also pings the database
+    for (size_t i = 0; i < m_pAsyncConnections.size(); ++i)
+    {
+        SqlDelayThread* threadBody = CreateDelayThread(m_pAsyncConnections[i], i == 0);
+        m_threadBodies.push_back(threadBody);               // will deleted at delay thread delete
+        m_delayThreads.push_back(new MaNGOS::Thread(threadBody));
+    }
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) return;
+    if (m_threadBodies.empty() || m_delayThreads.empty()) return;
 
-    m_threadBody->Stop();                                   // Stop event
-    m_delayThread->wait();                                  // Wait for flush to DB
-    delete m_delayThread;                                   // This also deletes m_threadBody
-    m_delayThread = nullptr;
-    m_threadBody = nullptr;
+    for (auto& threadBody : m_threadBodies)
+        threadBody->Stop();                                 // Stop event
+
+    for (auto& delayThread : m_delayThreads)
+    {
+        delayThread->wait();                                // Wait for flush to DB
+        delete delayThread;                                 // This also deletes thread body
+    }
+
+    m_delayThreads.clear();
+    m_threadBodies.clear();
 }
 
 void Database::ThreadStart()
@@ -225,12 +344,37 @@ SqlConnection* Database::getQueryConnection()
     return m_pQueryConnections[nCount % m_nQueryConnPoolSize];
 }
 
+void Database::DelayWithoutKey(SqlOperation* sql)
+{
+    if (m_threadBodies.size() == 1)
+    {
+        m_threadBodies[0]->Delay(sql);
+        return;
+    }
+
+    // all delay threads must see the barriers in the same order
+    std::shared_ptr<SqlShardBarrier> barrier(new SqlShardBarrier(sql, m_threadBodies.size()));
+    std::lock_guard<std::mutex> guard(m_shardBarrierLock);
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        m_threadBodies[i]->Delay(new SqlShardBarrierPart(barrier, i == 0));
+}
+
+std::vector<SqlDelayThreadStats> Database::GetAsyncShardStats() const
+{
+    std::vector<SqlDelayThreadStats> stats;
+    stats.reserve(m_threadBodies.size());
+    for (auto threadBody : m_threadBodies)
+        stats.push_back(threadBody->GetStats());
+    return stats;
+}
+
 void Database::Ping()
 {
     const char* sql = "SELECT 1";
 
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        SqlConnection::Lock guard(m_pAsyncConnection);
         delete guard->Query(sql);
     }
 
@@ -339,7 +483,7 @@ bool Database::Execute(const char* sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        DelayWithoutKey(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -385,7 +529,7 @@ bool Database::DirectPExecute(const char* format, ...)
     return DirectExecute(szQuery);
 }
 
-bool Database::BeginTransaction()
+bool Database::BeginTransaction(uint32 shardKey /*= 0*/)
 {
     if (!m_pAsyncConn)
         return false;
@@ -393,7 +537,7 @@ bool Database::BeginTransaction()
     MANGOS_ASSERT(!m_currentTransaction.get());   // if we will get a nested transaction request - we MUST fix code!!!
 
     if (!m_currentTransaction.get())
-        m_currentTransaction.reset(new SqlTransaction);
+        m_currentTransaction.reset(new SqlTransaction(shardKey));
 
     return m_currentTransaction.get() != nullptr;
 }
@@ -407,8 +551,12 @@ bool Database::CommitTransaction()
     if (!m_bAllowAsyncTransactions)
         return CommitTransactionDirect();
 
-    // add SqlTransaction to the async queue
-    m_threadBody->Delay(m_currentTransaction.release());
+    // add SqlTransaction to the async queue of its shard
+    SqlTransaction* pTrans = m_currentTransaction.release();
+    if (pTrans->GetShardKey())
+        getDelayThread(pTrans->GetShardKey())->Delay(pTrans);
+    else
+        DelayWithoutKey(pTrans);
     return true;
 }
 
@@ -429,6 +577,12 @@ bool Database::CommitTransactionDirect()
     return true;
 }
 
+size_t Database::GetTransactionStatementCount() const
+{
+    auto const pTrans = m_currentTransaction.get();
+    return pTrans ? pTrans->GetStatementCount() : 0;
+}
+
 bool Database::RollbackTransaction()
 {
     if (!m_pAsyncConn)
@@ -563,7 +717,7 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        DelayWithoutKey(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
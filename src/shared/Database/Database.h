@@ -63,6 +63,8 @@ class SqlConnection
 
         // methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
+        // execute the same statement for several parameter sets, INSERTs are sent as one multi-row request
+        bool ExecuteStmtBatch(int nIndex, const std::vector<const SqlStmtParameters*>& rows);
 
         // SqlConnection object lock
         class Lock
@@ -104,10 +106,10 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char* infoString, int nConns = 1);
-        // start worker thread for async DB request execution
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncConns = 1);
+        // start worker threads for async DB request execution
         virtual void InitDelayThread();
-        // stop worker thread
+        // stop worker threads
         virtual void HaltDelayThread();
 
         /// Synchronous DB queries
@@ -171,6 +173,17 @@ class Database
         bool AsyncPQuery(void (*method)(QueryResult*, ParamType1, ParamType2), ParamType1 param1, ParamType2 param2, const char* format, ...) ATTR_PRINTF(5, 6);
         template<typename ParamType1, typename ParamType2, typename ParamType3>
         bool AsyncPQuery(void (*method)(QueryResult*, ParamType1, ParamType2, ParamType3), ParamType1 param1, ParamType2 param2, ParamType3 param3, const char* format, ...) ATTR_PRINTF(6, 7);
+        // PQuery queued behind the writes of all shards, for rows written under several shard keys
+        template<class Class>
+        bool AsyncPQueryOrdered(Class* object, void (Class::*method)(QueryResult*), const char* format, ...) ATTR_PRINTF(4, 5);
+        template<class Class, typename ParamType1>
+        bool AsyncPQueryOrdered(Class* object, void (Class::*method)(QueryResult*, ParamType1), ParamType1 param1, const char* format, ...) ATTR_PRINTF(5, 6);
+        template<class Class, typename ParamType1, typename ParamType2>
+        bool AsyncPQueryOrdered(Class* object, void (Class::*method)(QueryResult*, ParamType1, ParamType2), ParamType1 param1, ParamType2 param2, const char* format, ...) ATTR_PRINTF(6, 7);
+        template<typename ParamType1>
+        bool AsyncPQueryOrdered(void (*method)(QueryResult*, ParamType1), ParamType1 param1, const char* format, ...) ATTR_PRINTF(4, 5);
+        template<typename ParamType1, typename ParamType2>
+        bool AsyncPQueryOrdered(void (*method)(QueryResult*, ParamType1, ParamType2), ParamType1 param1, ParamType2 param2, const char* format, ...) ATTR_PRINTF(5, 6);
         template<class Class>
         // QueryHolder
         bool DelayQueryHolder(Class* object, void (Class::*method)(QueryResult*, SqlQueryHolder*), SqlQueryHolder* holder);
@@ -183,11 +196,16 @@ class Database
         // Writes SQL commands to a LOG file (see mangosd.conf "LogSQL")
         bool PExecuteLog(const char* format, ...) ATTR_PRINTF(2, 3);
 
-        bool BeginTransaction();
+        // transactions with equal shard key are executed in order, different keys may be committed in parallel.
+        // writes without key (0) are ordered with everything queued on any shard, a write touching rows of
+        // several characters must not have a key
+        bool BeginTransaction(uint32 shardKey = 0);
         bool CommitTransaction();
         bool RollbackTransaction();
         // for sync transaction execution
         bool CommitTransactionDirect();
+        // amount of statements queued in the transaction of current thread
+        size_t GetTransactionStatementCount() const;
 
         // PREPARED STATEMENT API
 
@@ -215,6 +233,9 @@ class Database
         // function to ping database connections
         void Ping();
 
+        // statistics of async connections, one entry per shard
+        std::vector<SqlDelayThreadStats> GetAsyncShardStats() const;
+
         // set this to allow async transactions
         // you should call it explicitly after your server successfully started up
         // NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
@@ -222,8 +243,7 @@ class Database
 
     protected:
         Database() :
-            m_nQueryConnPoolSize(1), m_pAsyncConn(nullptr), m_pResultQueue(nullptr),
-            m_threadBody(nullptr), m_delayThread(nullptr), m_bAllowAsyncTransactions(false),
+            m_nQueryConnPoolSize(1), m_pAsyncConn(nullptr), m_pResultQueue(nullptr), m_bAllowAsyncTransactions(false),
             m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
@@ -234,7 +254,7 @@ class Database
         // factory method to create SqlConnection objects
         virtual SqlConnection* CreateConnection() = 0;
         // factory method to create SqlDelayThread objects
-        virtual SqlDelayThread* CreateDelayThread();
+        virtual SqlDelayThread* CreateDelayThread(SqlConnection* conn, bool pingDatabase);
 
         // per-thread based storage for SqlTransaction object initialization - no locking is required
         boost::thread_specific_ptr<SqlTransaction> m_currentTransaction;
@@ -243,8 +263,12 @@ class Database
 
         // round-robin connection selection
         SqlConnection* getQueryConnection();
-        // for now return one single connection for async requests
+        // connection used for direct execution of async requests
         SqlConnection* getAsyncConnection() const { return m_pAsyncConn; }
+        // delay thread serving the shard of given key, keyless queries go to the first one
+        SqlDelayThread* getDelayThread(uint32 shardKey = 0) const { return m_threadBodies[shardKey % m_threadBodies.size()]; }
+        // queues a write without shard key, or an ordered query, behind the operations of all shards
+        void DelayWithoutKey(SqlOperation* sql);
 
         friend class SqlStatement;
         // PREPARED STATEMENT API
@@ -260,12 +284,15 @@ class Database
         typedef std::vector< SqlConnection* > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections;
 
-        // only one single DB connection for transactions
+        // pool of connections for async requests, each one is served by own delay thread
+        SqlConnectionContainer m_pAsyncConnections;
+        // first async connection, also used for direct execution
         SqlConnection* m_pAsyncConn;
 
         SqlResultQueue*     m_pResultQueue;                 ///< Transaction queues from diff. threads
-        SqlDelayThread*     m_threadBody;                   ///< Pointer to delay sql executer (owned by m_delayThread)
-        MaNGOS::Thread*     m_delayThread;                  ///< Pointer to executer thread
+        std::vector<SqlDelayThread*> m_threadBodies;        ///< Delay sql executers (owned by m_delayThreads)
+        std::vector<MaNGOS::Thread*> m_delayThreads;        ///< Executer threads, one per async connection
+        std::mutex m_shardBarrierLock;                      ///< Keeps the order of keyless writes equal on all shards
 
         bool m_bAllowAsyncTransactions;                     ///< flag which specifies if async transactions are enabled
 
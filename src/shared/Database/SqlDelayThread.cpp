@@ -20,7 +20,9 @@
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase) :
+    m_dbEngine(db), m_dbConnection(conn), m_pingDatabase(pingDatabase), m_running(true),
+    m_queueDepth(0), m_executed(0), m_totalLatency(0), m_maxLatency(0)
 {
 }
 
@@ -49,13 +51,16 @@ void SqlDelayThread::run()
 
         ProcessRequests();
 
-        if ((loopCounter++) >= pingEveryLoop)
+        if (m_pingDatabase && (loopCounter++) >= pingEveryLoop)
         {
             loopCounter = 0;
             m_dbEngine->Ping();
         }
     }
 
+    // requests queued right before the stop, the keyless writes need all delay threads running
+    ProcessRequests();
+
 #ifndef DO_POSTGRESQL
     mysql_thread_end();
 #endif
@@ -68,7 +73,7 @@ void SqlDelayThread::Stop()
 
 void SqlDelayThread::ProcessRequests()
 {
-    std::queue<std::unique_ptr<SqlOperation>> sqlQueue;
+    std::queue<DelayedOperation> sqlQueue;
 
     // we need to move the contents of the queue to a local copy because executing these statements with the
     // lock in place can result in a deadlock with the world thread which calls Database::ProcessResultQueue()
@@ -81,6 +86,23 @@ void SqlDelayThread::ProcessRequests()
     {
         auto const s = std::move(sqlQueue.front());
         sqlQueue.pop();
-        s->Execute(m_dbConnection);
+        s.operation->Execute(m_dbConnection);
+
+        uint64 latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - s.queueTime).count();
+        m_totalLatency += latency;
+        if (latency > m_maxLatency)
+            m_maxLatency = uint32(latency);
+        ++m_executed;
+        --m_queueDepth;
     }
 }
+
+SqlDelayThreadStats SqlDelayThread::GetStats() const
+{
+    SqlDelayThreadStats stats;
+    stats.queued = m_queueDepth;
+    stats.executed = m_executed;
+    stats.avgLatency = stats.executed ? uint32(m_totalLatency / stats.executed / 1000) : 0;
+    stats.maxLatency = m_maxLatency / 1000;
+    return stats;
+}
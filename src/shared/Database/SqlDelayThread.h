@@ -25,35 +25,65 @@
 #include <mutex>
 #include <queue>
 #include <memory>
+#include <atomic>
+#include <chrono>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+struct SqlDelayThreadStats
+{
+    size_t queued;                                          ///< operations waiting for execution
+    uint64 executed;                                        ///< operations executed since startup
+    uint32 avgLatency;                                      ///< average time from enqueue to completion, ms
+    uint32 maxLatency;                                      ///< highest time from enqueue to completion, ms
+};
+
 class SqlDelayThread : public MaNGOS::Runnable
 {
     private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct DelayedOperation
+        {
+            std::unique_ptr<SqlOperation> operation;
+            Clock::time_point queueTime;
+        };
+
         std::mutex m_queueMutex;
-        std::queue<std::unique_ptr<SqlOperation>> m_sqlQueue;   ///< Queue of SQL statements
-        Database* m_dbEngine;                                   ///< Pointer to used Database engine
-        SqlConnection* m_dbConnection;                          ///< Pointer to DB connection
+        std::queue<DelayedOperation> m_sqlQueue;            ///< Queue of SQL statements
+        Database* m_dbEngine;                               ///< Pointer to used Database engine
+        SqlConnection* m_dbConnection;                      ///< Pointer to DB connection
+        bool m_pingDatabase;                                ///< Thread is responsible for keeping DB connections alive
         volatile bool m_running;
 
+        std::atomic<size_t> m_queueDepth;                   ///< Queued and not yet finished operations
+        std::atomic<uint64> m_executed;
+        std::atomic<uint64> m_totalLatency;                 ///< Sum of operation latencies, microseconds
+        std::atomic<uint32> m_maxLatency;                   ///< microseconds
+
         // process all enqueued requests
         void ProcessRequests();
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase = true);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
         bool Delay(SqlOperation* sql)
         {
             std::lock_guard<std::mutex> guard(m_queueMutex);
-            m_sqlQueue.push(std::unique_ptr<SqlOperation>(sql));
+            DelayedOperation delayed;
+            delayed.operation.reset(sql);
+            delayed.queueTime = Clock::now();
+            m_sqlQueue.push(std::move(delayed));
+            ++m_queueDepth;
             return true;
         }
 
+        SqlDelayThreadStats GetStats() const;
+
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
 };
@@ -23,6 +23,8 @@
 
 #define LOCK_DB_CONN(conn) SqlConnection::Lock guard(conn)
 
+#define MAX_BATCHED_STATEMENTS 256
+
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
 
 bool SqlPlainRequest::Execute(SqlConnection* conn)
@@ -32,6 +34,38 @@ bool SqlPlainRequest::Execute(SqlConnection* conn)
     return conn->Execute(m_sql);
 }
 
+void SqlShardBarrier::Arrive()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    --m_waiting;
+    m_condition.notify_all();
+    m_condition.wait(lock, [this] { return m_done; });
+}
+
+bool SqlShardBarrier::Execute(SqlConnection* conn)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_waiting == 0; });
+    }
+
+    bool result = m_operation->Execute(conn);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+    m_condition.notify_all();
+    return result;
+}
+
+bool SqlShardBarrierPart::Execute(SqlConnection* conn)
+{
+    if (m_execute)
+        return m_barrier->Execute(conn);
+
+    m_barrier->Arrive();
+    return true;
+}
+
 SqlTransaction::~SqlTransaction()
 {
     while (!m_queue.empty())
@@ -50,12 +84,40 @@ bool SqlTransaction::Execute(SqlConnection* conn)
 
     conn->BeginTransaction();
 
+    std::vector<const SqlStmtParameters*> batch;
+
     const int nItems = m_queue.size();
-    for (int i = 0; i < nItems; ++i)
+    for (int i = 0; i < nItems;)
     {
         SqlOperation* pStmt = m_queue[i];
 
-        if (!pStmt->Execute(conn))
+        // collect consecutive executions of the same prepared statement
+        batch.clear();
+        if (SqlPreparedRequest* pFirst = dynamic_cast<SqlPreparedRequest*>(pStmt))
+        {
+            for (int j = i; j < nItems && batch.size() < MAX_BATCHED_STATEMENTS; ++j)
+            {
+                SqlPreparedRequest* pNext = dynamic_cast<SqlPreparedRequest*>(m_queue[j]);
+                if (!pNext || pNext->GetIndex() != pFirst->GetIndex())
+                    break;
+
+                batch.push_back(pNext->GetParams());
+            }
+        }
+
+        bool result;
+        if (batch.size() > 1)
+        {
+            result = conn->ExecuteStmtBatch(static_cast<SqlPreparedRequest*>(pStmt)->GetIndex(), batch);
+            i += batch.size();
+        }
+        else
+        {
+            result = pStmt->Execute(conn);
+            ++i;
+        }
+
+        if (!result)
         {
             conn->RollbackTransaction();
             return false;
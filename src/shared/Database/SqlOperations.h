@@ -22,6 +22,7 @@
 #include "Common.h"
 #include "Utilities/Callback.h"
 
+#include <condition_variable>
 #include <queue>
 #include <vector>
 #include <mutex>
@@ -58,22 +59,58 @@ class SqlTransaction : public SqlOperation
 {
     private:
         std::vector<SqlOperation* > m_queue;
+        uint32 m_shardKey;
 
     public:
-        SqlTransaction() {}
+        SqlTransaction(uint32 shardKey = 0) : m_shardKey(shardKey) {}
         ~SqlTransaction();
 
         void DelayExecute(SqlOperation* sql) { m_queue.push_back(sql); }
+        uint32 GetShardKey() const { return m_shardKey; }
+        size_t GetStatementCount() const { return m_queue.size(); }
 
         bool Execute(SqlConnection* conn) override;
 };
 
+// Write without shard key on a database with several async connections. Every delay thread gets a part of it
+// and stops there until the write is done by the first one, so the write keeps its order with all keyed
+// operations queued before and after it, whatever character or item rows it touches
+class SqlShardBarrier
+{
+    public:
+        SqlShardBarrier(SqlOperation* operation, uint32 shardCount) : m_operation(operation), m_waiting(shardCount - 1), m_done(false) {}
+
+        void Arrive();                                      // by the other delay threads, returns once the write is done
+        bool Execute(SqlConnection* conn);                  // by the first delay thread, after all others arrived
+
+    private:
+        std::unique_ptr<SqlOperation> m_operation;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint32 m_waiting;
+        bool m_done;
+};
+
+class SqlShardBarrierPart : public SqlOperation
+{
+    public:
+        SqlShardBarrierPart(std::shared_ptr<SqlShardBarrier> const& barrier, bool execute) : m_barrier(barrier), m_execute(execute) {}
+        bool Execute(SqlConnection* conn) override;
+
+    private:
+        std::shared_ptr<SqlShardBarrier> m_barrier;
+        bool m_execute;
+};
+
 class SqlPreparedRequest : public SqlOperation
 {
     public:
         SqlPreparedRequest(int nIndex, SqlStmtParameters* arg);
         ~SqlPreparedRequest();
 
+        int GetIndex() const { return m_nIndex; }
+        const SqlStmtParameters* GetParams() const { return m_param; }
+
         bool Execute(SqlConnection* conn) override;
 
     private:
@@ -122,9 +159,13 @@ class SqlQueryHolder
     private:
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
+        uint32 m_shardKey;
     public:
-        SqlQueryHolder() {}
+        SqlQueryHolder() : m_shardKey(0) {}
         ~SqlQueryHolder();
+        // queries are executed after all pending async writes with the same key
+        void SetShardKey(uint32 shardKey) { m_shardKey = shardKey; }
+        uint32 GetShardKey() const { return m_shardKey; }
         bool SetQuery(size_t index, const char* sql);
         bool SetPQuery(size_t index, const char* format, ...) ATTR_PRINTF(3, 4);
         void SetSize(size_t size);
@@ -113,7 +113,7 @@ void SqlPlainPreparedStatement::bind(const SqlStmtParameters& holder)
         const SqlStmtFieldData& data = (*iter);
 
         std::ostringstream fmt;
-        DataToString(data, fmt);
+        DataToString(data, fmt, m_pConn);
 
         nLastPos = m_szPlainRequest.find('?', nLastPos);
         if (nLastPos != std::string::npos)
@@ -133,7 +133,7 @@ bool SqlPlainPreparedStatement::execute()
     return m_pConn.Execute(m_szPlainRequest.c_str());
 }
 
-void SqlPlainPreparedStatement::DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt) const
+void SqlPlainPreparedStatement::DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt, SqlConnection& conn)
 {
     switch (data.type())
     {
@@ -151,7 +151,7 @@ void SqlPlainPreparedStatement::DataToString(const SqlStmtFieldData& data, std::
         case FIELD_STRING:
         {
             std::string tmp = data.toStr();
-            m_pConn.DB().escape_string(tmp);
+            conn.DB().escape_string(tmp);
             fmt << "'" << tmp << "'";
             break;
         }
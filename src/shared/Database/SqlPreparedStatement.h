@@ -305,6 +305,7 @@ class SqlPreparedStatement
 
         uint32 params() const { return m_nParams; }
         uint32 columns() const { return isQuery() ? m_nColumns : 0; }
+        const std::string& format() const { return m_szFmt; }
 
         // initialize internal structures of prepared statement
         // upon success m_bPrepared should be true
@@ -344,8 +345,10 @@ class SqlPlainPreparedStatement : public SqlPreparedStatement
 
         virtual bool execute() override;
 
+        // format parameter as SQL literal, strings are escaped
+        static void DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt, SqlConnection& conn);
+
     protected:
-        void DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt) const;
 
         std::string m_szPlainRequest;
 };
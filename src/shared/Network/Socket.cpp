@@ -33,8 +33,9 @@
 namespace MaNGOS
 {
     Socket::Socket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler)
-        : m_writeState(WriteState::Idle), m_readState(ReadState::Idle), m_socket(service),
-          m_closeHandler(std::move(closeHandler)), m_outBufferFlushTimer(service), m_address("0.0.0.0") {}
+        : m_writeState(WriteState::Idle), m_readState(ReadState::Idle), m_readSuspended(false), m_socket(service),
+          m_closeHandler(std::move(closeHandler)), m_flushPosted(false), m_service(service), m_outBufferFlushTimer(service),
+          m_address("0.0.0.0") {}
 
     bool Socket::Open()
     {
@@ -49,8 +50,6 @@ namespace MaNGOS
             return false;
         }
 
-        m_outBuffer.reset(new PacketBuffer);
-        m_secondaryOutBuffer.reset(new PacketBuffer);
         m_inBuffer.reset(new PacketBuffer);
 
         StartAsyncRead();
@@ -114,6 +113,11 @@ namespace MaNGOS
             return;
         }
 
+        ProcessInput();
+    }
+
+    void Socket::ProcessInput()
+    {
         // we must repeat this in case we have read in multiple messages from the client
         while (m_inBuffer->m_readPosition < m_inBuffer->m_writePosition)
         {
@@ -137,14 +141,48 @@ namespace MaNGOS
 
                 return;
             }
+
+            // the handler waits for an async result, ResumeRead() continues with the rest of the buffer
+            if (m_readSuspended)
+            {
+                m_readState = ReadState::Idle;
+                Flush();
+                return;
+            }
         }
 
         // at this point, the packet has been read and successfully processed.  reset the buffer.
         m_inBuffer->m_writePosition = m_inBuffer->m_readPosition = 0;
 
+        // send whatever the handlers answered right away
+        Flush();
+
         StartAsyncRead();
     }
 
+    void Socket::ResumeRead(std::function<void()> continuation)
+    {
+        std::shared_ptr<Socket> ptr = shared<Socket>();
+        m_service.post([ptr, continuation]()
+        {
+            ptr->m_readSuspended = false;
+
+            if (ptr->IsClosed())
+                return;
+
+            if (continuation)
+                continuation();
+
+            if (ptr->IsClosed() || ptr->m_readSuspended)
+            {
+                ptr->Flush();
+                return;
+            }
+
+            ptr->ProcessInput();
+        });
+    }
+
     void Socket::OnError(const boost::system::error_code& error)
     {
         // skip logging this code because it happens whenever anyone disconnects.  reduces spam.
@@ -165,18 +203,61 @@ namespace MaNGOS
         return true;
     }
 
+// note that this function assumes that the socket mutex is locked
+    void Socket::QueueOut(const char* buffer, int length)
+    {
+        if (length <= 0)
+            return;
+
+        if (m_pendingChunks.empty())
+            m_pendingSince = Clock::now();
+
+        // start a new chunk when the last one would grow past the chunk size, large writes get a chunk of their own
+        if (m_pendingChunks.empty() || m_pendingChunks.back().shared ||
+                (!m_pendingChunks.back().data.empty() && m_pendingChunks.back().data.size() + length > OutChunkSize))
+        {
+            if (m_freeChunks.empty())
+            {
+                m_pendingChunks.emplace_back();
+                m_pendingChunks.back().data.reserve(OutChunkSize);
+            }
+            else
+            {
+                m_pendingChunks.push_back(std::move(m_freeChunks.back()));
+                m_freeChunks.pop_back();
+            }
+        }
+
+        std::vector<uint8>& data = m_pendingChunks.back().data;
+        data.insert(data.end(), reinterpret_cast<const uint8*>(buffer), reinterpret_cast<const uint8*>(buffer) + length);
+    }
+
     void Socket::Write(const char* header, int headerSize, const char* content, int contentSize)
     {
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        // get the correct buffer depending on the current writing state
-        PacketBuffer* outBuffer = m_writeState == WriteState::Sending ? m_secondaryOutBuffer.get() : m_outBuffer.get();
+        QueueOut(header, headerSize);
+        QueueOut(content, contentSize);
+
+        // flush data if need
+        if (m_writeState == WriteState::Idle)
+            StartWriteFlushTimer();
+    }
+
+    void Socket::Write(const char* header, int headerSize, const SharedBuffer& content)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        QueueOut(header, headerSize);
 
-        // write the header
-        outBuffer->Write(header, headerSize);
+        if (content && !content->empty())
+        {
+            if (m_pendingChunks.empty())
+                m_pendingSince = Clock::now();
 
-        // write the content
-        outBuffer->Write(content, contentSize);
+            m_pendingChunks.emplace_back();
+            m_pendingChunks.back().shared = content;
+        }
 
         // flush data if need
         if (m_writeState == WriteState::Idle)
@@ -187,11 +268,7 @@ namespace MaNGOS
     {
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        // get the correct buffer depending on the current writing state
-        PacketBuffer* outBuffer = m_writeState == WriteState::Sending ? m_secondaryOutBuffer.get() : m_outBuffer.get();
-
-        // write the header
-        outBuffer->Write(buffer, length);
+        QueueOut(buffer, length);
 
         // flush data if need
         if (m_writeState == WriteState::Idle)
@@ -215,7 +292,28 @@ namespace MaNGOS
 
         std::shared_ptr<Socket> ptr = shared<Socket>();
         m_outBufferFlushTimer.expires_from_now(boost::posix_time::milliseconds(int(BufferTimeout)));
-        m_outBufferFlushTimer.async_wait([ptr](const boost::system::error_code&) { ptr->FlushOut(); });
+        m_outBufferFlushTimer.async_wait([ptr](const boost::system::error_code & error)
+        {
+            // cancelled by FlushOut() after an explicit flush
+            if (error != boost::asio::error::operation_aborted)
+                ptr->FlushOut();
+        });
+    }
+
+// if the write state is idle, this will do nothing, which is correct
+// if the write state is sending, this will do nothing, which is correct.  OnWriteComplete() sends the pending data
+// if the write state is buffering, this will hand FlushOut() to the network thread which owns the asio socket
+    void Socket::Flush()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        if (m_writeState != WriteState::Buffering || m_flushPosted || IsClosed())
+            return;
+
+        m_flushPosted = true;
+
+        std::shared_ptr<Socket> ptr = shared<Socket>();
+        m_service.post([ptr]() { ptr->FlushOut(); });
     }
 
     void Socket::FlushOut()
@@ -229,26 +327,57 @@ namespace MaNGOS
 
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        assert(m_writeState == WriteState::Buffering);
+        m_flushPosted = false;
 
-        // at this point we are guarunteed that there is data to send in the primary buffer.  send it.
-        m_writeState = WriteState::Sending;
+        // both the fallback timer and an explicit flush may end up here, only the first one sends
+        if (m_writeState != WriteState::Buffering)
+            return;
 
-        std::shared_ptr<Socket> ptr = shared<Socket>();
-        m_socket.async_write_some(boost::asio::buffer(m_outBuffer->m_buffer, m_outBuffer->m_writePosition),
-                                  make_custom_alloc_handler(m_allocator,
-        [ptr](const boost::system::error_code & error, size_t length) { ptr->OnWriteComplete(error, length); }));
+        boost::system::error_code ec;
+        m_outBufferFlushTimer.cancel(ec);
+
+        StartSend();
     }
 
-// if the write state is idle, this will do nothing, which is correct
-// if the write state is sending, this will do nothing, which is correct
-// if the write state is buffering, this will cancel the running timer, which will immediately trigger FlushOut()
-    void Socket::ForceFlushOut()
+// note that this function assumes that the socket mutex is locked and that there is pending data
+    void Socket::StartSend()
     {
-        m_outBufferFlushTimer.cancel();
+        m_writeState = WriteState::Sending;
+
+        // everything written so far goes out in one gathered write, new data queues up behind it
+        m_sendingChunks.swap(m_pendingChunks);
+
+        std::vector<boost::asio::const_buffer> buffers;
+        buffers.reserve(m_sendingChunks.size());
+
+        size_t bytes = 0;
+        for (OutChunk const& chunk : m_sendingChunks)
+        {
+            buffers.push_back(chunk.Buffer());
+            bytes += boost::asio::buffer_size(buffers.back());
+        }
+
+        const uint64 waited = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_pendingSince).count();
+
+        size_t sizeBucket = 0;
+        while (sizeBucket < SocketSendStats::HistogramBuckets - 1 && bytes >= (size_t(64) << sizeBucket))
+            ++sizeBucket;
+
+        size_t latencyBucket = 0;
+        while (latencyBucket < SocketSendStats::HistogramBuckets - 1 && waited >= (uint64(1) << latencyBucket))
+            ++latencyBucket;
+
+        ++m_sendStats.sends;
+        m_sendStats.bytes += bytes;
+        ++m_sendStats.sizeHistogram[sizeBucket];
+        ++m_sendStats.latencyHistogram[latencyBucket];
+
+        std::shared_ptr<Socket> ptr = shared<Socket>();
+        boost::asio::async_write(m_socket, buffers, make_custom_alloc_handler(m_allocator,
+        [ptr](const boost::system::error_code & error, size_t length) { ptr->OnWriteComplete(error, length); }));
     }
 
-    void Socket::OnWriteComplete(const boost::system::error_code& error, size_t length)
+    void Socket::OnWriteComplete(const boost::system::error_code& error, size_t /*length*/)
     {
         // we must check this before locking the mutex because the connection will be closed,
         // which leads to a locked mutex being destroyed.  not good!
@@ -267,38 +396,29 @@ namespace MaNGOS
         std::lock_guard<std::mutex> guard(m_mutex);
 
         assert(m_writeState == WriteState::Sending);
-        assert(length <= m_outBuffer->m_writePosition);
-
-        // if there is data left to write, move it to the start of the buffer
-        if (length < m_outBuffer->m_writePosition)
-        {
-            memcpy(&(m_outBuffer->m_buffer[0]), &(m_outBuffer->m_buffer[length]), (m_outBuffer->m_writePosition - length) * sizeof(m_outBuffer->m_buffer[0]));
-            m_outBuffer->m_writePosition -= length;
-        }
-        // if not, reset the write pointer
-        else
-            m_outBuffer->m_writePosition = 0;
 
-        // if there is data in the secondary buffer, append it to the primary buffer
-        if (m_secondaryOutBuffer->m_writePosition > 0)
+        // async_write only completes once every buffer is written, keep a few chunks for reuse
+        // and drop the references to shared buffers
+        for (OutChunk& chunk : m_sendingChunks)
         {
-            // do we have enough space? if not, resize
-            if (m_outBuffer->m_buffer.size() < (m_outBuffer->m_writePosition + m_secondaryOutBuffer->m_writePosition))
-                m_outBuffer->m_buffer.resize(m_outBuffer->m_writePosition + m_secondaryOutBuffer->m_writePosition);
-
-            memcpy(&(m_outBuffer->m_buffer[m_outBuffer->m_writePosition]), &(m_secondaryOutBuffer->m_buffer[0]), (m_secondaryOutBuffer->m_writePosition) * sizeof(m_secondaryOutBuffer->m_buffer[0]));
+            if (chunk.shared || m_freeChunks.size() >= MaxFreeOutChunks || chunk.data.capacity() > OutChunkSize)
+                continue;
 
-            m_outBuffer->m_writePosition += m_secondaryOutBuffer->m_writePosition;
-            m_secondaryOutBuffer->m_writePosition = 0;
+            chunk.data.clear();
+            m_freeChunks.push_back(std::move(chunk));
         }
+        m_sendingChunks.clear();
 
-        std::shared_ptr<Socket> ptr = shared<Socket>();
         // if there is any data to write, do so immediately
-        if (m_outBuffer->m_writePosition > 0)
-            m_socket.async_write_some(boost::asio::buffer(m_outBuffer->m_buffer, m_outBuffer->m_writePosition),
-                                      make_custom_alloc_handler(m_allocator,
-            [ptr](const boost::system::error_code & error, size_t length) { ptr->OnWriteComplete(error, length);}));
+        if (!m_pendingChunks.empty())
+            StartSend();
         else
             m_writeState = WriteState::Idle;
     }
+
+    SocketSendStats Socket::GetSendStats()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_sendStats;
+    }
 }
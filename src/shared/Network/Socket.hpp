@@ -29,16 +29,51 @@
 #include <string>
 #include <mutex>
 #include <functional>
+#include <chrono>
+#include <vector>
 
 namespace MaNGOS
 {
+    // immutable data which may be queued on several sockets at once, e.g. a broadcast packet payload
+    typedef std::shared_ptr<const std::vector<uint8>> SharedBuffer;
+
+    struct SocketSendStats
+    {
+        static const size_t HistogramBuckets = 12;
+
+        SocketSendStats() : sends(0), bytes(0), sizeHistogram(), latencyHistogram() {}
+
+        uint64 sends;
+        uint64 bytes;
+        uint32 sizeHistogram[HistogramBuckets];         // bucket i counts sends of less than 64 << i bytes, the last one all larger sends
+        uint32 latencyHistogram[HistogramBuckets];      // bucket i counts sends whose oldest data waited less than 1 << i ms, the last one all longer waits
+    };
+
     class Socket : public std::enable_shared_from_this<Socket>
     {
         private:
-            // buffer timeout period, in milliseconds.  higher values decrease responsiveness
-            // ingame but increase bandwidth efficiency by reducing tcp overhead.
+            // fallback buffer timeout period, in milliseconds.  output is normally sent by an explicit
+            // Flush() once the producer (world or map tick, incoming data handler) is done, the timer
+            // only bounds the latency of data written outside of those.
             static const int BufferTimeout = 50;
 
+            // small writes are appended to the last queued chunk, so a send carries few buffers
+            static const size_t OutChunkSize = 4096;
+            static const size_t MaxFreeOutChunks = 8;
+
+            typedef std::chrono::steady_clock Clock;
+
+            struct OutChunk
+            {
+                std::vector<uint8> data;
+                SharedBuffer shared;                        // referenced instead of copied into data, if set
+
+                boost::asio::const_buffer Buffer() const
+                {
+                    return shared ? boost::asio::const_buffer(shared->data(), shared->size()) : boost::asio::const_buffer(data.data(), data.size());
+                }
+            };
+
             enum class WriteState
             {
                 Idle,       // no write operation is currently underway
@@ -54,23 +89,34 @@ namespace MaNGOS
 
             WriteState m_writeState;
             ReadState m_readState;
+            bool m_readSuspended;
 
             boost::asio::ip::tcp::socket m_socket;
 
             std::function<void(Socket *)> m_closeHandler;
 
             std::unique_ptr<PacketBuffer> m_inBuffer;
-            std::unique_ptr<PacketBuffer> m_outBuffer;
-            std::unique_ptr<PacketBuffer> m_secondaryOutBuffer;
+
+            std::vector<OutChunk> m_pendingChunks;          // written data not handed to asio yet
+            std::vector<OutChunk> m_sendingChunks;          // data of the running async_write
+            std::vector<OutChunk> m_freeChunks;             // recycled chunks, keeping their capacity
+            Clock::time_point m_pendingSince;               // queue time of the oldest pending data
+            bool m_flushPosted;
+
+            SocketSendStats m_sendStats;
 
             std::mutex m_mutex;
             std::mutex m_closeMutex;
+            boost::asio::io_service& m_service;
             boost::asio::deadline_timer m_outBufferFlushTimer;
 
             void StartAsyncRead();
             void OnRead(const boost::system::error_code &error, size_t length);
+            void ProcessInput();
 
+            void QueueOut(const char *buffer, int length);
             void StartWriteFlushTimer();
+            void StartSend();
             void OnWriteComplete(const boost::system::error_code &error, size_t length);
             void FlushOut();
 
@@ -86,7 +132,10 @@ namespace MaNGOS
 
             int ReadLengthRemaining() const { return m_inBuffer->ReadLengthRemaining(); }
 
-            void ForceFlushOut();
+            // stops processing input and reading from the socket once the current handler returns, used by
+            // handlers which wait for an async result
+            void SuspendRead() { m_readSuspended = true; }
+            bool IsReadSuspended() const { return m_readSuspended; }
 
         public:
             Socket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler);
@@ -103,6 +152,16 @@ namespace MaNGOS
 
             void Write(const char *buffer, int length);
             void Write(const char *header, int headerSize, const char* content, int contentSize);
+            void Write(const char *header, int headerSize, const SharedBuffer& content);
+
+            // sends buffered output now instead of waiting for the fallback timer, safe to call from any thread
+            void Flush();
+
+            // runs the continuation of a suspended handler on the network thread, then carries on with
+            // the buffered input.  safe to call from any thread
+            void ResumeRead(std::function<void()> continuation);
+
+            SocketSendStats GetSendStats();
 
             boost::asio::ip::tcp::socket &GetAsioSocket() { return m_socket; }
 